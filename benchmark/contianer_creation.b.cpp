@@ -3,6 +3,7 @@
 #include "stack_allocator.hpp"
 #include <benchmark/benchmark.h>
 #include <dynamic_array.hpp>
+#include <small_dynamic_array.hpp>
 #include <static_array.hpp>
 #include <vector>
 
@@ -82,4 +83,36 @@ static void BM_StaticVectorStaticStackAllocAccess(benchmark::State& state)
 
 BENCHMARK(BM_StaticVectorStaticStackAllocAccess);
 
+// A two element state, as in the harmonic oscillator examples, evaluated into a
+// new array every iteration
+static void BM_DynamicArraySmallState(benchmark::State& state)
+{
+    using F      = double;
+    using vector = data_types::lazily_evaluated_containers::dynamic_array<F>;
+    const vector x{ F{ 1 }, F{ 0 } };
+    const vector k{ F{ 0 }, F{ -1 } };
+    for (auto _ : state)
+    {
+        const vector v = x + k * F{ 0.01 };
+        bm_utils::escape((void*)v.data());
+    }
+}
+
+BENCHMARK(BM_DynamicArraySmallState);
+
+static void BM_SmallDynamicArraySmallState(benchmark::State& state)
+{
+    using F      = double;
+    using vector = data_types::lazily_evaluated_containers::small_dynamic_array<F, 4>;
+    const vector x{ F{ 1 }, F{ 0 } };
+    const vector k{ F{ 0 }, F{ -1 } };
+    for (auto _ : state)
+    {
+        const vector v = x + k * F{ 0.01 };
+        bm_utils::escape((void*)v.data());
+    }
+}
+
+BENCHMARK(BM_SmallDynamicArraySmallState);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,212 @@
+#include "bm_utils.hpp"
+#include "data_buffer.hpp"
+#include "dynamic_array.hpp"
+#include "execution_policy.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <memory>
+
+// Runge-Kutta stage update x += k * (a * dt) on large states. Arguments are the
+// element count and the thread count, 1 being the serial path.
+static void BM_DynamicArrayStageUpdate(benchmark::State& state)
+{
+    using F          = double;
+    using vector     = data_types::lazily_evaluated_containers::dynamic_array<F>;
+    const auto n     = static_cast<std::size_t>(state.range(0));
+    const auto a_dt  = F{ 0.25 };
+    const auto count = static_cast<std::size_t>(state.range(1));
+
+    utility::parallel::thread_pool pool(count);
+    const auto                     policy = utility::parallel::par(pool);
+
+    // Both first touched under the partitioning of the timed loop
+    vector x(n);
+    vector k(n);
+    utility::parallel::for_each_chunk<F>(
+        policy, n, [&x, &k](std::size_t first, std::size_t last) {
+            std::fill(x.data() + first, x.data() + last, F{ 1 });
+            std::fill(k.data() + first, k.data() + last, F{ 2 });
+        }
+    );
+    for (auto _ : state)
+    {
+        x.in_place_operator_impl_(k * a_dt, std::plus{}, policy);
+        bm_utils::escape((void*)x.data());
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * n * 3 * sizeof(F))
+    );
+}
+
+BENCHMARK(BM_DynamicArrayStageUpdate)
+    ->ArgsProduct({ { 1 << 16, 1 << 20, 1 << 24 }, { 1, 4 } })
+    ->UseRealTime();
+
+// Nested expression evaluated in one pass, serial. Argument is the element count
+static void BM_DynamicArrayNestedExpr(benchmark::State& state)
+{
+    using F      = double;
+    using vector = data_types::lazily_evaluated_containers::dynamic_array<F>;
+    const auto n = static_cast<std::size_t>(state.range(0));
+
+    vector a(n, F{ 1.5 });
+    vector b(n, F{ -0.5 });
+    vector c(n, F{ 2 });
+    vector y(n);
+    for (auto _ : state)
+    {
+        y = abs(a - b) * c + a / (b + F{ 1 });
+        bm_utils::escape((void*)y.data());
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * n * 4 * sizeof(F))
+    );
+}
+
+BENCHMARK(BM_DynamicArrayNestedExpr)->Arg(1 << 12)->Arg(1 << 16)->Arg(1 << 20);
+
+// Final stage of a six stage Runge-Kutta step, y = x + dt * sum b_i k_i and
+// x += dt * sum b_i k_i, over seven input streams. Arguments are the element
+// count, swept from L1 to memory, and the evaluation: 0 plain, 1 blocked with
+// software prefetch, 2 with non-temporal stores as well
+static auto stage_policy(std::int64_t mode) noexcept -> utility::parallel::execution_policy
+{
+    utility::parallel::execution_policy ret{};
+    if (mode >= 1)
+    {
+        ret.block_bytes     = 4096;
+        ret.prefetch_blocks = 2;
+    }
+    ret.streaming_stores = mode == 2;
+    return ret;
+}
+
+static void BM_DynamicArrayStageCombination(benchmark::State& state)
+{
+    using F           = double;
+    using vector      = data_types::lazily_evaluated_containers::dynamic_array<F>;
+    const auto n      = static_cast<std::size_t>(state.range(0));
+    const auto dt     = F{ 1e-3 };
+    const auto policy = stage_policy(state.range(1));
+
+    vector x(n, F{ 1 });
+    vector y(n);
+    vector k1(n, F{ 0.1 });
+    vector k2(n, F{ 0.2 });
+    vector k3(n, F{ 0.3 });
+    vector k4(n, F{ 0.4 });
+    vector k5(n, F{ 0.5 });
+    vector k6(n, F{ 0.6 });
+    for (auto _ : state)
+    {
+        y.assign(
+            x + dt * (F{ 0.1 } * k1 + F{ 0.2 } * k2 + F{ 0.3 } * k3 + F{ 0.1 } * k4 +
+                      F{ 0.2 } * k5 + F{ 0.1 } * k6),
+            policy
+        );
+        bm_utils::escape((void*)y.data());
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * n * 8 * sizeof(F))
+    );
+}
+
+BENCHMARK(BM_DynamicArrayStageCombination)
+    ->ArgsProduct({ benchmark::CreateRange(1 << 10, 1 << 23, 8), { 0, 1, 2 } });
+
+static void BM_DynamicArrayStageAccumulation(benchmark::State& state)
+{
+    using F           = double;
+    using vector      = data_types::lazily_evaluated_containers::dynamic_array<F>;
+    const auto n      = static_cast<std::size_t>(state.range(0));
+    const auto dt     = F{ 1e-9 };
+    const auto policy = stage_policy(state.range(1));
+
+    vector x(n, F{ 1 });
+    vector k1(n, F{ 0.1 });
+    vector k2(n, F{ 0.2 });
+    vector k3(n, F{ 0.3 });
+    vector k4(n, F{ 0.4 });
+    vector k5(n, F{ 0.5 });
+    vector k6(n, F{ 0.6 });
+    for (auto _ : state)
+    {
+        x.in_place_operator_impl_(
+            dt * (F{ 0.1 } * k1 + F{ 0.2 } * k2 + F{ 0.3 } * k3 + F{ 0.1 } * k4 +
+                  F{ 0.2 } * k5 + F{ 0.1 } * k6),
+            std::plus{},
+            policy
+        );
+        bm_utils::escape((void*)x.data());
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * n * 8 * sizeof(F))
+    );
+}
+
+BENCHMARK(BM_DynamicArrayStageAccumulation)
+    ->ArgsProduct({ benchmark::CreateRange(1 << 10, 1 << 23, 8), { 0, 1 } });
+
+// Stage update on states whose size is not a whole number of simd packets,
+// where the scalar remainder is a large part of the loop unless the arrays are
+// padded. Argument is the element count
+template <typename Vector>
+static void BM_StageUpdateRemainder(benchmark::State& state)
+{
+    using F         = typename Vector::value_type;
+    const auto n    = static_cast<std::size_t>(state.range(0));
+    const auto a_dt = F{ 0.25 };
+
+    Vector x(n, F{ 1 });
+    Vector k(n, F{ 2 });
+    for (auto _ : state)
+    {
+        x += k * a_dt;
+        bm_utils::escape((void*)x.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+}
+
+BENCHMARK(BM_StageUpdateRemainder<data_types::lazily_evaluated_containers::dynamic_array<double>>)
+    ->Arg(7)
+    ->Arg(15)
+    ->Arg(63)
+    ->Arg(1023);
+BENCHMARK(BM_StageUpdateRemainder<
+              data_types::lazily_evaluated_containers::aligned_dynamic_array<double>>)
+    ->Arg(7)
+    ->Arg(15)
+    ->Arg(63)
+    ->Arg(1023);
+
+// Stage update on a static_buffer of 1000 particles of 6 components, with rows
+// padded to 8 elements or not
+template <data_types::buffer_config::LayoutPolicy Layout, std::size_t Stride>
+static void BM_StaticBufferStageUpdate(benchmark::State& state)
+{
+    using F        = double;
+    using buffer_t = data_types::lazily_evaluated_containers::
+        static_buffer<F, 1000, 6, Layout, data_types::buffer_config::layout_stride{ Stride }>;
+    const auto a_dt = F{ 0.25 };
+
+    auto x = std::make_unique<buffer_t>();
+    auto k = std::make_unique<buffer_t>();
+    *k     = *x * F{ 0 } + F{ 2 };
+    for (auto _ : state)
+    {
+        *x += *k * a_dt;
+        bm_utils::escape((void*)x->data());
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * buffer_t::size())
+    );
+}
+
+BENCHMARK(BM_StaticBufferStageUpdate<data_types::buffer_config::LayoutPolicy::layout_row_major, 0>);
+BENCHMARK(BM_StaticBufferStageUpdate<data_types::buffer_config::LayoutPolicy::layout_row_major, 8>);
+BENCHMARK(
+    BM_StaticBufferStageUpdate<data_types::buffer_config::LayoutPolicy::layout_column_major, 1024>
+);
+
+BENCHMARK_MAIN();
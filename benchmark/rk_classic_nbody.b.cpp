@@ -2,7 +2,7 @@
 #include "bm_utils.hpp"
 #include "dynamic_array.hpp"
 #include "explicit_generic_runge_kutta.hpp"
-#include "operation_utils.hpp"
+#include "nbody.hpp"
 #include "random.hpp"
 #include "runge_kutta_params.hpp"
 #include "stack_allocator.hpp"
@@ -19,58 +19,6 @@
 constexpr auto N = 3;  // Dimension
 constexpr auto n = 24; // Particles
 
-template <typename F, std::size_t N>
-struct nbody_system_AoS
-{
-    using vec_t = data_types::eagerly_evaluated_containers::static_array<F, N>;
-    inline static constexpr auto epsilon = static_cast<F>(4.5e-1);
-
-    // mutable int                  iter    = 0;
-
-    nbody_system_AoS(std::size_t n)
-        : n_{ n }
-    {
-    }
-
-    inline auto operator()(
-        [[maybe_unused]] auto const& z,
-        [[maybe_unused]] auto&       dzdt,
-        [[maybe_unused]] auto const& t
-    ) const -> void
-    {
-        for (auto i = 0uz; i != n_; ++i)
-        {
-            const auto acc_i = calculate_acc(z, i);
-            for (auto j = 0uz; j != N; ++j)
-            {
-                dzdt[i][j]     = z[i][j + N];
-                dzdt[i][j + N] = acc_i[j];
-            }
-        }
-    };
-
-    auto calculate_acc(const auto& z, std::size_t idx) const noexcept -> vec_t
-    {
-        vec_t d_i = z[idx].template slice<vec_t>(0, N);
-        vec_t d_j{};
-        vec_t ret{};
-        for (auto i = 0uz; i != n_; ++i)
-        {
-            if (i == idx) [[unlikely]]
-            {
-                continue;
-            }
-            d_j                 = z[i].template slice<vec_t>(0, N);
-            const auto distance = data_types::operation_utils::distance(d_i, d_j);
-            const auto d        = data_types::operation_utils::l2_norm(distance);
-            ret += distance / (d * d * d + epsilon);
-        }
-        return ret;
-    }
-
-    std::size_t n_;
-};
-
 static void BM_ParticleSimulation_AoS(benchmark::State& state)
 {
     using F         = float_value_type;
@@ -94,6 +42,8 @@ static void BM_ParticleSimulation_AoS(benchmark::State& state)
 
     using rk_t = solvers::explicit_stepers::
         generic_runge_kutta<4, 4, F, vector, vector, time_type>;
+    using system_t = systems::nbody::
+        nbody_system<F, N, systems::nbody::state_layout::array_of_structures>;
     rk_t stepper(
         n,
         solvers::explicit_stepers::butcher_tableau<F, 4>{
@@ -111,11 +61,12 @@ static void BM_ParticleSimulation_AoS(benchmark::State& state)
         }
     }
 
+    // Built once, the system owns a thread pool
+    system_t s(n);
     for (auto _ : state)
     {
-        auto                   t_i   = t0;
-        vector                 y_hat = y0;
-        nbody_system_AoS<F, N> s(n);
+        auto   t_i   = t0;
+        vector y_hat = y0;
         for (auto i = 1; i != k; ++i)
         {
             stepper.do_step(s, y_hat, t_i, dt);
@@ -127,63 +78,6 @@ static void BM_ParticleSimulation_AoS(benchmark::State& state)
 
 BENCHMARK(BM_ParticleSimulation_AoS);
 
-template <typename F, std::size_t N>
-struct nbody_system_SoA
-{
-    using vec_t = data_types::eagerly_evaluated_containers::static_array<F, N>;
-    inline static constexpr auto epsilon = static_cast<F>(4.5e-1);
-
-    nbody_system_SoA(std::size_t n)
-        : n_{ n }
-    {
-    }
-
-    inline auto operator()(
-        [[maybe_unused]] auto const& z,
-        [[maybe_unused]] auto&       dzdt,
-        [[maybe_unused]] auto const& t
-    ) const -> void
-    {
-        for (auto i = 0uz; i != n_; ++i)
-        {
-            const auto acc_i = calculate_acc(z, i);
-            for (auto j = 0uz; j != N; ++j)
-            {
-                dzdt[j][i]     = z[j + N][i];
-                dzdt[j + N][i] = acc_i[j];
-            }
-        }
-    };
-
-    auto calculate_acc(const auto& z, std::size_t idx) const noexcept -> vec_t
-    {
-        vec_t d_i = {};
-        for (auto k = 0uz; k != N; ++k)
-        {
-            d_i[k] = z[k][idx];
-        }
-        vec_t d_j{};
-        vec_t ret{};
-        for (auto i = 0uz; i != n_; ++i)
-        {
-            if (i == idx) [[unlikely]]
-            {
-                continue;
-            }
-            for (auto k = 0uz; k != N; ++k)
-            {
-                d_j[k] = z[k][i];
-            }
-            const auto distance = data_types::operation_utils::distance(d_i, d_j);
-            const auto d        = data_types::operation_utils::l2_norm(distance);
-            ret += distance / (d * d * d + epsilon);
-        }
-        return ret;
-    }
-
-    std::size_t n_;
-};
-
 static void BM_ParticleSimulation_SoA(benchmark::State& state)
 {
     using F               = float_value_type;
@@ -207,6 +101,8 @@ static void BM_ParticleSimulation_SoA(benchmark::State& state)
 
     using rk_t = solvers::explicit_stepers::
         generic_runge_kutta<4, 4, F, vector, vector, time_type>;
+    using system_t = systems::nbody::
+        nbody_system<F, N, systems::nbody::state_layout::structure_of_arrays>;
     rk_t stepper(
         n,
         solvers::explicit_stepers::butcher_tableau<F, 4>{
@@ -224,11 +120,12 @@ static void BM_ParticleSimulation_SoA(benchmark::State& state)
         }
     }
 
+    // Built once, the system owns a thread pool
+    system_t s(n);
     for (auto _ : state)
     {
-        auto                   t_i   = t0;
-        vector                 y_hat = y0;
-        nbody_system_SoA<F, N> s(n);
+        auto   t_i   = t0;
+        vector y_hat = y0;
         for (auto i = 1; i != k; ++i)
         {
             stepper.do_step(s, y_hat, t_i, dt);
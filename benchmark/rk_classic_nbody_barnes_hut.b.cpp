@@ -0,0 +1,67 @@
+#include "barnes_hut.hpp"
+#include "bm_utils.hpp"
+#include "buffer_config.hpp"
+#include "data_buffer.hpp"
+#include "explicit_generic_runge_kutta.hpp"
+#include "random.hpp"
+#include "runge_kutta_params.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <memory>
+
+#define SEED1 104845342
+
+static void BM_ParticleSimulation_BarnesHut(benchmark::State& state)
+{
+    using F          = double;
+    using time_type  = F;
+    constexpr auto N = 3;    // Dimension
+    constexpr auto n = 1000; // Particles
+    using buffer_t   = data_types::lazily_evaluated_containers::static_buffer<
+          F,
+          n,
+          N * 2,
+          data_types::buffer_config::LayoutPolicy::layout_row_major,
+          data_types::buffer_config::layout_stride{ 0 }>;
+
+    const auto      dt    = F{ 0.5f };
+    const time_type t0    = 0;
+    const auto      k     = 64;
+    const auto      theta = static_cast<F>(state.range(0)) / F{ 10 };
+    auto            y0    = std::make_unique<buffer_t>();
+
+    utility::random::srandom::seed<F>((unsigned int)SEED1);
+
+    // Fill initial conditions
+    for (auto i = 0uz; i != n; ++i)
+    {
+        for (auto j = 0uz; j != N; ++j)
+        {
+            (*y0)[i, j] = utility::random::srandom::randnormal(F{ 0 }, F{ 10 });
+        }
+    }
+
+    using rk_t = solvers::explicit_stepers::
+        generic_runge_kutta<4, 4, F, buffer_t, buffer_t, time_type>;
+
+    auto stepper = std::make_unique<rk_t>(solvers::explicit_stepers::butcher_tableau<F, 4>{
+        { 0.5f, 0.f, 0.5f, 0.f, 0.f, 1.f },
+        { 1.f / 6.f, 1.f / 3.f, 1.f / 3.f, 1.f / 6.f },
+        { 0.5f, 0.5f, 1.f } });
+    systems::barnes_hut::nbody_system<F, N> s(n, theta);
+    for (auto _ : state)
+    {
+        auto t_i   = t0;
+        auto y_hat = std::make_unique<buffer_t>(*y0);
+        for (auto i = 1; i != k; ++i)
+        {
+            stepper->do_step(s, *y_hat, t_i, dt);
+            t_i += dt;
+            bm_utils::escape((void*)y_hat.get());
+        }
+    }
+}
+
+BENCHMARK(BM_ParticleSimulation_BarnesHut)->DenseRange(3, 9, 3);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,99 @@
+#include "bm_utils.hpp"
+#include "dynamic_array.hpp"
+#include "static_array.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+// All pairs accumulation a_i += (p_j - p_i) / (d^3 + epsilon) over 3D positions,
+// written with eager static array operators, with lazy() expressions and with
+// plain loops. Argument is the particle count
+namespace
+{
+
+using F      = double;
+using vec_t  = data_types::eagerly_evaluated_containers::static_array<F, 3>;
+using list_t = data_types::lazily_evaluated_containers::dynamic_array<vec_t>;
+
+constexpr auto epsilon = F{ 1e-3 };
+
+auto fill_positions(list_t& p) noexcept -> void
+{
+    const auto n = p.size();
+    for (auto i = 0uz; i != n; ++i)
+    {
+        const auto t = static_cast<F>(i);
+        p[i]         = vec_t{ { std::sin(t), std::cos(3 * t), t / static_cast<F>(n) } };
+    }
+}
+
+auto norm(vec_t const& r) noexcept -> F
+{
+    return std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+}
+
+template <typename Accumulate>
+auto run(benchmark::State& state, Accumulate accumulate) noexcept -> void
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    list_t     p(n);
+    list_t     acc(n);
+    fill_positions(p);
+    for (auto _ : state)
+    {
+        for (auto i = 0uz; i != n; ++i)
+        {
+            vec_t ret{};
+            for (auto j = 0uz; j != n; ++j)
+            {
+                accumulate(ret, p[i], p[j]);
+            }
+            acc[i] = ret;
+        }
+        bm_utils::escape((void*)acc.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n * n));
+}
+
+} // namespace
+
+static void BM_StaticArrayEager(benchmark::State& state)
+{
+    run(state, [](vec_t& ret, vec_t const& p, vec_t const& q) {
+        const auto distance = q - p;
+        const auto d        = norm(distance);
+        ret                += distance / (d * d * d + epsilon);
+    });
+}
+
+BENCHMARK(BM_StaticArrayEager)->Arg(256)->Arg(2048);
+
+static void BM_StaticArrayLazy(benchmark::State& state)
+{
+    run(state, [](vec_t& ret, vec_t const& p, vec_t const& q) {
+        const auto distance = to_static_array(lazy(q) - p);
+        const auto d        = norm(distance);
+        ret                += lazy(distance) / (d * d * d + epsilon);
+    });
+}
+
+BENCHMARK(BM_StaticArrayLazy)->Arg(256)->Arg(2048);
+
+static void BM_StaticArrayLoop(benchmark::State& state)
+{
+    run(state, [](vec_t& ret, vec_t const& p, vec_t const& q) {
+        F r[3];
+        for (auto k = 0uz; k != 3; ++k)
+        {
+            r[k] = q[k] - p[k];
+        }
+        const auto d = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+        for (auto k = 0uz; k != 3; ++k)
+        {
+            ret[k] += r[k] / (d * d * d + epsilon);
+        }
+    });
+}
+
+BENCHMARK(BM_StaticArrayLoop)->Arg(256)->Arg(2048);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,67 @@
+#include <iostream>
+
+// std::generator is not available in every standard library yet
+#if __has_include(<generator>)
+#include "dynamic_array.hpp"
+#include "explicit_generic_runge_kutta.hpp"
+#include "lazy_integration.hpp"
+#include "runge_kutta_params.hpp"
+#include <cmath>
+#include <numbers>
+
+int main()
+{
+    std::cout << "Hello lazy integration world\n";
+
+    // x'' = -x
+    // x_1 = x
+    // x_2 = x'
+    // (x_1; x_2)' = (0, 1; -1, 0)(x_1; x_2)
+
+    using F         = double;
+    using time_type = F;
+    using vector    = data_types::lazily_evaluated_containers::dynamic_array<F>;
+    using rk_t      = solvers::explicit_stepers::
+        generic_runge_kutta<4, 4, F, vector, vector, time_type>;
+
+    auto system = [](auto const& z,
+                     auto&       dzdt,
+                     [[maybe_unused]]
+                     auto const& t) -> void {
+        dzdt[0] = z[1];
+        dzdt[1] = -z[0];
+    };
+
+    const auto dt = F{ 0.01 };
+    vector     y  = { F{ 0 }, F{ 1 } };
+    rk_t       stepper(
+        2,
+        solvers::explicit_stepers::butcher_tableau<F, 4>{
+            { 0.5, 0., 0.5, 0., 0., 1. },
+            { 1. / 6., 1. / 3., 1. / 3., 1. / 6. },
+            { 0.5, 0.5, 1. } }
+    );
+
+    // Pull states until the first zero crossing of x, no history is kept
+    auto previous = std::pair{ time_type{ 0 }, y[0] };
+    for (auto [t, x] : solvers::integration::integrate_lazily(stepper, system, y, 0., dt))
+    {
+        if (previous.second > 0 && x[0] <= 0)
+        {
+            const auto t_zero =
+                previous.first + dt * previous.second / (previous.second - x[0]);
+            std::cout << "First zero crossing at t = " << t_zero
+                      << " (pi = " << std::numbers::pi_v<F> << ")\n";
+            break;
+        }
+        previous = { t, x[0] };
+    }
+
+    std::cout << "Goodbye lazy integration world\n";
+}
+#else
+int main()
+{
+    std::cout << "Lazy integration needs <generator>\n";
+}
+#endif
@@ -0,0 +1,74 @@
+#include <iostream>
+
+// std::mdspan is not available in every standard library yet
+#if __has_include(<mdspan>)
+#include "buffer_mdspan.hpp"
+#include "data_buffer.hpp"
+#include "execution_policy.hpp"
+#include "thread_pool.hpp"
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+int main()
+{
+    std::cout << "Hello mdspan world\n";
+
+    using F      = double;
+    using layout = data_types::buffer_config::LayoutPolicy;
+    using stride = data_types::buffer_config::layout_stride;
+    using positions_t =
+        data_types::lazily_evaluated_containers::dynamic_length_buffer<F, 3>;
+    using velocities_t = data_types::lazily_evaluated_containers::
+        static_buffer<F, 1000, 3, layout::layout_row_major, stride{ 4 }>;
+
+    // Positions in blocks of 8 particles, velocities in rows padded to 4
+    const auto   n = 1000uz;
+    positions_t  x(n, n, data_types::buffer_config::layout_blocked<8>, stride{ 0 });
+    velocities_t v{};
+    for (auto j = 0uz; j != n; ++j)
+    {
+        for (auto i = 0uz; i != 3uz; ++i)
+        {
+            x[j, i] = static_cast<F>(j + i);
+            v[j, i] = F{ 1 };
+        }
+    }
+
+    // Views over the buffers' own storage, nothing is copied
+    const auto xs = data_types::buffer_mdspan::to_mdspan(x);
+    const auto vs = data_types::buffer_mdspan::to_mdspan(std::as_const(v));
+
+    // One explicit Euler step and the distance of each particle to the origin,
+    // the particles split over the threads of the pool
+    utility::parallel::thread_pool pool{};
+    std::vector<F>                 distance(n);
+    const auto                     dt = F{ 0.5 };
+    utility::parallel::for_each_chunk<F>(
+        utility::parallel::par(pool, 0),
+        xs.extent(0),
+        [=, &distance](std::size_t first, std::size_t last) {
+            for (auto j = first; j != last; ++j)
+            {
+                auto r2 = F{ 0 };
+                for (auto i = 0uz; i != xs.extent(1); ++i)
+                {
+                    xs[j, i] += dt * vs[j, i];
+                    r2       += xs[j, i] * xs[j, i];
+                }
+                distance[j] = std::sqrt(r2);
+            }
+        }
+    );
+
+    std::cout << "x[999] = (" << x[999, 0] << ", " << x[999, 1] << ", " << x[999, 2]
+              << "), |x[999]| = " << distance.back() << '\n';
+    std::cout << "Goodbye mdspan world\n";
+}
+#else
+int main()
+{
+    std::cout << "Mdspan export needs <mdspan>\n";
+}
+#endif
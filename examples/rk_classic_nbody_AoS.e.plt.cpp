@@ -2,7 +2,7 @@
 #include "allocator_wrapper.hpp"
 #include "dynamic_array.hpp"
 #include "explicit_generic_runge_kutta.hpp"
-#include "operation_utils.hpp"
+#include "nbody.hpp"
 #include "random.hpp"
 #include "runge_kutta_params.hpp"
 #include "series_plot_2D.hpp"
@@ -14,55 +14,6 @@
 
 #define SEED1 104845342
 
-template <typename F, std::size_t N>
-struct nbody_system
-{
-    using vec_t = data_types::eagerly_evaluated_containers::static_array<F, N>;
-    inline static constexpr auto epsilon = static_cast<F>(4.5e-1);
-    int                          iter    = 0;
-
-    nbody_system(std::size_t n)
-        : n_{ n }
-    {
-    }
-
-    inline auto operator()(
-        [[maybe_unused]] auto const& z,
-        [[maybe_unused]] auto&       dzdt,
-        [[maybe_unused]] auto const& t
-    ) -> void
-    {
-        for (auto i = 0uz; i != n_; ++i)
-        {
-            const auto acc_i = calculate_acc(z, i);
-            for (auto j = 0uz; j != N; ++j)
-            {
-                dzdt[i][j]     = z[i][j + N];
-                dzdt[i][j + N] = acc_i[j];
-            }
-        }
-        std::cout << iter++ << dzdt << '\n';
-    };
-
-    auto calculate_acc(const auto& z, std::size_t idx) const noexcept -> vec_t
-    {
-        vec_t d_i = z[idx].template slice<vec_t>(0, N);
-        vec_t d_j{};
-        vec_t ret{};
-        for (auto i = 0uz; i != n_; ++i)
-        {
-            if (i == idx) continue;
-            d_j                 = z[i].template slice<vec_t>(0, N);
-            const auto distance = data_types::operation_utils::distance(d_i, d_j);
-            const auto d        = data_types::operation_utils::l2_norm(distance);
-            ret += distance / (d * d * d + epsilon);
-        }
-        return ret;
-    }
-
-    std::size_t n_;
-};
-
 int main()
 {
     std::cout << "Hello Explicit RK world\n";
@@ -119,17 +70,19 @@ int main()
 
     using rk_t = solvers::explicit_stepers::
         generic_runge_kutta<4, 4, F, vector, vector, time_type>;
+    using system_t = systems::nbody::
+        nbody_system<F, N, systems::nbody::state_layout::array_of_structures>;
 
-    auto   t_i   = t0;
-    vector y_hat = y0;
-    rk_t   stepper(
+    auto     t_i   = t0;
+    vector   y_hat = y0;
+    rk_t     stepper(
         n,
         solvers::explicit_stepers::butcher_tableau<F, 4>{
             { 0.5f, 0.f, 0.5f, 0.f, 0.f, 1.f },
             { 1.f / 6.f, 1.f / 3.f, 1.f / 3.f, 1.f / 6.f },
             { 0.5f, 0.5f, 1.f } }
     );
-    nbody_system<F, N> s(n);
+    system_t s(n);
     for (auto i = 1; i != k; ++i)
     {
         stepper.do_step(s, y_hat, t_i, dt);
@@ -4,7 +4,7 @@
 #include "data_buffer.hpp"
 #include "data_type_concepts.hpp"
 #include "explicit_generic_runge_kutta.hpp"
-#include "operation_utils.hpp"
+#include "nbody.hpp"
 #include "random.hpp"
 #include "runge_kutta_params.hpp"
 #include "series_plot_2D.hpp"
@@ -16,62 +16,6 @@
 
 #define SEED1 104845342
 
-template <typename F, std::size_t N>
-struct nbody_system
-{
-    using vec_t = data_types::eagerly_evaluated_containers::static_array<F, N>;
-    inline static constexpr auto epsilon = static_cast<F>(4.5e-1);
-    int                          iter    = 0;
-
-    nbody_system(std::size_t n)
-        : n_{ n }
-    {
-    }
-
-    inline auto operator()(
-        [[maybe_unused]] auto const& z,
-        [[maybe_unused]] auto&       dzdt,
-        [[maybe_unused]] auto const& t
-    ) -> void
-    {
-        for (auto i = 0uz; i != n_; ++i)
-        {
-            const auto acc_i = calculate_acc(z, i);
-            for (auto j = 0uz; j != N; ++j)
-            {
-                dzdt[i, j]     = z[i, j + N];
-                dzdt[i, j + N] = acc_i[j];
-            }
-        }
-        std::cout << iter++ << dzdt << '\n';
-    };
-
-    auto calculate_acc(const auto& z, std::size_t idx) const noexcept -> vec_t
-    {
-        vec_t d_i{};
-        for (auto j = 0; j != N; ++j)
-        {
-            d_i[j] = z[idx, j];
-        }
-        vec_t d_j{};
-        vec_t ret{};
-        for (auto i = 0uz; i != n_; ++i)
-        {
-            if (i == idx) continue;
-            for (auto j = 0; j != N; ++j)
-            {
-                d_j[j] = z[i, j];
-            }
-            const auto distance = data_types::operation_utils::distance(d_i, d_j);
-            const auto d        = data_types::operation_utils::l2_norm(distance);
-            ret += distance / (d * d * d + epsilon);
-        }
-        return ret;
-    }
-
-    std::size_t n_;
-};
-
 int main()
 {
     std::cout << "Hello Explicit RK world\n";
@@ -130,6 +74,7 @@ int main()
 
     using rk_t = solvers::explicit_stepers::
         generic_runge_kutta<4, 4, F, buffer_t, buffer_t, time_type>;
+    using system_t = systems::nbody::nbody_system<F, N>;
 
     auto     t_i   = t0;
     buffer_t y_hat = y0;
@@ -140,7 +85,7 @@ int main()
             { 1.f / 6.f, 1.f / 3.f, 1.f / 3.f, 1.f / 6.f },
             { 0.5f, 0.5f, 1.f } }
     );
-    nbody_system<F, N> s(n);
+    system_t s(n);
     for (auto i = 1; i != k; ++i)
     {
         stepper.do_step(s, y_hat, t_i, dt);
@@ -1,17 +1,56 @@
 #pragma once
 
 #include <cassert>
+#include <compare>
 #include <cstddef>
 
 namespace data_types::buffer_config
 {
 
-enum struct LayoutPolicy
+// How the rows (particles) and columns (components) of a buffer are stored.
+// Besides row and column major, layout_blocked<W> stores the rows in blocks of
+// W, each block holding column 0 of its rows, then column 1 and so on (array of
+// structures of arrays), so that W rows of a column load as one SIMD pack.
+// Structural, to be passed as a template argument as the enumerators it
+// replaces
+struct LayoutPolicy
 {
-    layout_column_major,
-    layout_row_major,
+    using size_type = std::size_t;
+
+    enum struct kind_t
+    {
+        column_major,
+        row_major,
+        blocked,
+    };
+
+    static const LayoutPolicy layout_column_major;
+    static const LayoutPolicy layout_row_major;
+
+    [[nodiscard]]
+    constexpr auto blocked() const noexcept -> bool
+    {
+        return kind == kind_t::blocked;
+    }
+
+    friend constexpr auto operator<=>(LayoutPolicy, LayoutPolicy) = default;
+    friend constexpr auto operator==(LayoutPolicy, LayoutPolicy) -> bool = default;
+
+    kind_t    kind;
+    size_type block_width;
 };
 
+inline constexpr LayoutPolicy LayoutPolicy::layout_column_major{
+    LayoutPolicy::kind_t::column_major, 1
+};
+inline constexpr LayoutPolicy LayoutPolicy::layout_row_major{
+    LayoutPolicy::kind_t::row_major, 1
+};
+
+template <std::size_t W>
+    requires(W > 0)
+inline constexpr LayoutPolicy layout_blocked{ LayoutPolicy::kind_t::blocked, W };
+
 struct layout_stride
 {
     using size_type = std::size_t;
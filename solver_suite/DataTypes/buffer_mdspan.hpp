@@ -0,0 +1,465 @@
+#pragma once
+
+#include "data_type_concepts.hpp"
+#include <cassert>
+#include <cstddef>
+#include <mdspan>
+#include <memory>
+#include <type_traits>
+
+// Zero copy std::mdspan views of the data buffers and of the buffer shapes in
+// buffers::buffer_interface, indexed as the buffers, [y, x]. The layout
+// mappings below encode the padding of the lines and the blocks of blocked
+// layouts, so the views reach the elements exactly where the buffers store
+// them. Kept out of the buffer headers so that only the code using mdspan
+// pulls in <mdspan>
+namespace data_types::buffer_mdspan
+{
+
+// Strides known at compile time, for the padded row and column major layouts
+// of static buffers
+template <std::size_t Stride_Y, std::size_t Stride_X>
+struct layout_padded
+{
+    template <typename Extents>
+        requires(Extents::rank() == 2)
+    class mapping
+    {
+    public:
+        using extents_type = Extents;
+        using index_type   = typename extents_type::index_type;
+        using size_type    = typename extents_type::size_type;
+        using rank_type    = typename extents_type::rank_type;
+        using layout_type  = layout_padded;
+
+    public:
+        constexpr mapping() noexcept = default;
+
+        constexpr mapping(extents_type const& extents) noexcept
+            : extents_{ extents }
+        {
+        }
+
+        [[nodiscard]]
+        constexpr auto extents() const noexcept -> extents_type const&
+        {
+            return extents_;
+        }
+
+        [[nodiscard]]
+        constexpr auto operator()(index_type y, index_type x) const noexcept
+            -> index_type
+        {
+            assert(y < extents_.extent(0));
+            assert(x < extents_.extent(1));
+            return y * Stride_Y + x * Stride_X;
+        }
+
+        [[nodiscard]]
+        constexpr auto required_span_size() const noexcept -> index_type
+        {
+            if (extents_.extent(0) == 0 || extents_.extent(1) == 0)
+            {
+                return 0;
+            }
+            return (extents_.extent(0) - 1) * Stride_Y +
+                   (extents_.extent(1) - 1) * Stride_X + 1;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_always_unique() noexcept -> bool
+        {
+            return true;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_always_exhaustive() noexcept -> bool
+        {
+            return false;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_always_strided() noexcept -> bool
+        {
+            return true;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_unique() noexcept -> bool
+        {
+            return true;
+        }
+
+        // False when the lines are padded
+        [[nodiscard]]
+        constexpr auto is_exhaustive() const noexcept -> bool
+        {
+            return required_span_size() == extents_.extent(0) * extents_.extent(1);
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_strided() noexcept -> bool
+        {
+            return true;
+        }
+
+        [[nodiscard]]
+        static constexpr auto stride(rank_type r) noexcept -> index_type
+        {
+            assert(r < 2);
+            return r == 0 ? Stride_Y : Stride_X;
+        }
+
+        friend constexpr auto operator==(mapping const& a, mapping const& b) noexcept
+            -> bool
+        {
+            return a.extents_ == b.extents_;
+        }
+
+    private:
+        [[no_unique_address]] extents_type extents_{};
+    };
+};
+
+// Rows in blocks of Block_Width, as buffer_config::layout_blocked. Column x of
+// a block is contiguous but the columns are not strided, the rows of the
+// last block past extent(0) are padding
+template <std::size_t Block_Width>
+    requires(Block_Width > 0)
+struct layout_blocks
+{
+    template <typename Extents>
+        requires(Extents::rank() == 2)
+    class mapping
+    {
+    public:
+        using extents_type = Extents;
+        using index_type   = typename extents_type::index_type;
+        using size_type    = typename extents_type::size_type;
+        using rank_type    = typename extents_type::rank_type;
+        using layout_type  = layout_blocks;
+
+    public:
+        constexpr mapping() noexcept = default;
+
+        constexpr mapping(extents_type const& extents) noexcept
+            : extents_{ extents }
+        {
+        }
+
+        [[nodiscard]]
+        constexpr auto extents() const noexcept -> extents_type const&
+        {
+            return extents_;
+        }
+
+        [[nodiscard]]
+        constexpr auto operator()(index_type y, index_type x) const noexcept
+            -> index_type
+        {
+            assert(y < extents_.extent(0));
+            assert(x < extents_.extent(1));
+            return (y / Block_Width * extents_.extent(1) + x) * Block_Width +
+                   y % Block_Width;
+        }
+
+        [[nodiscard]]
+        constexpr auto required_span_size() const noexcept -> index_type
+        {
+            const auto blocks = (extents_.extent(0) + Block_Width - 1) / Block_Width;
+            return blocks * Block_Width * extents_.extent(1);
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_always_unique() noexcept -> bool
+        {
+            return true;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_always_exhaustive() noexcept -> bool
+        {
+            return false;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_always_strided() noexcept -> bool
+        {
+            return false;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_unique() noexcept -> bool
+        {
+            return true;
+        }
+
+        // False when the last block is not full
+        [[nodiscard]]
+        constexpr auto is_exhaustive() const noexcept -> bool
+        {
+            return extents_.extent(0) % Block_Width == 0;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_strided() noexcept -> bool
+        {
+            return false;
+        }
+
+        friend constexpr auto operator==(mapping const& a, mapping const& b) noexcept
+            -> bool
+        {
+            return a.extents_ == b.extents_;
+        }
+
+    private:
+        [[no_unique_address]] extents_type extents_{};
+    };
+};
+
+// Any of the above with the strides or the block width set at run time, for
+// buffers whose layout or capacity is only known then. A block width of 0
+// stands for the strided layouts
+struct layout_buffer
+{
+    template <typename Extents>
+        requires(Extents::rank() == 2)
+    class mapping
+    {
+    public:
+        using extents_type = Extents;
+        using index_type   = typename extents_type::index_type;
+        using size_type    = typename extents_type::size_type;
+        using rank_type    = typename extents_type::rank_type;
+        using layout_type  = layout_buffer;
+
+    public:
+        constexpr mapping() noexcept = default;
+
+        constexpr mapping(
+            extents_type const& extents,
+            index_type          stride_y,
+            index_type          stride_x,
+            index_type          block_width = 0
+        ) noexcept
+            : extents_{ extents }
+            , stride_y_{ stride_y }
+            , stride_x_{ stride_x }
+            , block_width_{ block_width }
+        {
+        }
+
+        [[nodiscard]]
+        constexpr auto extents() const noexcept -> extents_type const&
+        {
+            return extents_;
+        }
+
+        [[nodiscard]]
+        constexpr auto block_width() const noexcept -> index_type
+        {
+            return block_width_;
+        }
+
+        [[nodiscard]]
+        constexpr auto operator()(index_type y, index_type x) const noexcept
+            -> index_type
+        {
+            assert(y < extents_.extent(0));
+            assert(x < extents_.extent(1));
+            if (block_width_ != 0)
+            {
+                return (y / block_width_ * extents_.extent(1) + x) * block_width_ +
+                       y % block_width_;
+            }
+            return y * stride_y_ + x * stride_x_;
+        }
+
+        [[nodiscard]]
+        constexpr auto required_span_size() const noexcept -> index_type
+        {
+            if (extents_.extent(0) == 0 || extents_.extent(1) == 0)
+            {
+                return 0;
+            }
+            if (block_width_ != 0)
+            {
+                const auto blocks =
+                    (extents_.extent(0) + block_width_ - 1) / block_width_;
+                return blocks * block_width_ * extents_.extent(1);
+            }
+            return (extents_.extent(0) - 1) * stride_y_ +
+                   (extents_.extent(1) - 1) * stride_x_ + 1;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_always_unique() noexcept -> bool
+        {
+            return true;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_always_exhaustive() noexcept -> bool
+        {
+            return false;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_always_strided() noexcept -> bool
+        {
+            return false;
+        }
+
+        [[nodiscard]]
+        static constexpr auto is_unique() noexcept -> bool
+        {
+            return true;
+        }
+
+        [[nodiscard]]
+        constexpr auto is_exhaustive() const noexcept -> bool
+        {
+            return required_span_size() == extents_.extent(0) * extents_.extent(1);
+        }
+
+        [[nodiscard]]
+        constexpr auto is_strided() const noexcept -> bool
+        {
+            return block_width_ == 0;
+        }
+
+        [[nodiscard]]
+        constexpr auto stride(rank_type r) const noexcept -> index_type
+        {
+            assert(is_strided());
+            assert(r < 2);
+            return r == 0 ? stride_y_ : stride_x_;
+        }
+
+        friend constexpr auto operator==(mapping const& a, mapping const& b) noexcept
+            -> bool
+        {
+            return a.extents_ == b.extents_ && a.stride_y_ == b.stride_y_ &&
+                   a.stride_x_ == b.stride_x_ && a.block_width_ == b.block_width_;
+        }
+
+    private:
+        [[no_unique_address]] extents_type extents_{};
+        index_type                         stride_y_{};
+        index_type                         stride_x_{};
+        index_type                         block_width_{};
+    };
+};
+
+namespace detail
+{
+
+// Shapes whose layout is a template argument
+template <typename Shape>
+concept StaticLayout = requires { Shape::s_layout_policy; };
+
+// Block width of a layout policy, 0 when it is not blocked. The layout
+// policies of buffers::buffer_config have no blocked layouts
+template <typename Layout_Policy>
+[[nodiscard]]
+constexpr auto block_width(Layout_Policy layout_policy) noexcept -> std::size_t
+{
+    if constexpr (requires { layout_policy.blocked(); })
+    {
+        return layout_policy.blocked() ? layout_policy.block_width : 0uz;
+    }
+    else
+    {
+        return 0uz;
+    }
+}
+
+template <typename Layout_Policy>
+[[nodiscard]]
+constexpr auto row_major(Layout_Policy layout_policy) noexcept -> bool
+{
+    return layout_policy == Layout_Policy::layout_row_major;
+}
+
+template <typename Shape>
+[[nodiscard]]
+consteval auto layout() noexcept
+{
+    if constexpr (!StaticLayout<Shape>)
+    {
+        return layout_buffer{};
+    }
+    else if constexpr (constexpr auto width = block_width(Shape::s_layout_policy);
+                       width != 0)
+    {
+        return layout_blocks<width>{};
+    }
+    else if constexpr (row_major(Shape::s_layout_policy))
+    {
+        return layout_padded<Shape::s_underlying_size_x, 1uz>{};
+    }
+    else
+    {
+        return layout_padded<1uz, Shape::s_underlying_size_x>{};
+    }
+}
+
+} // namespace detail
+
+template <typename Shape>
+using extents_of = std::extents<std::size_t, Shape::s_size_y, Shape::s_size_x>;
+
+template <typename Shape>
+using layout_of = decltype(detail::layout<Shape>());
+
+template <typename Shape>
+using mapping_t = typename layout_of<Shape>::template mapping<extents_of<Shape>>;
+
+// Layout mapping of a data buffer or a buffers::buffer_interface shape
+template <typename Shape>
+[[nodiscard]]
+constexpr auto mapping_of(Shape const& shape) noexcept -> mapping_t<Shape>
+{
+    const auto extents = extents_of<Shape>(shape.size_y(), shape.size_x());
+    if constexpr (detail::StaticLayout<Shape>)
+    {
+        return mapping_t<Shape>(extents);
+    }
+    else
+    {
+        const auto line = shape.underlying_size_x();
+        const auto row  = detail::row_major(shape.layout_policy());
+        return mapping_t<Shape>(
+            extents,
+            row ? line : 1uz,
+            row ? 1uz : line,
+            detail::block_width(shape.layout_policy())
+        );
+    }
+}
+
+// View of the storage at data laid out as shape
+template <typename T, typename Shape>
+[[nodiscard]]
+constexpr auto to_mdspan(Shape const& shape, T* data) noexcept
+{
+    return std::mdspan<T, extents_of<Shape>, layout_of<Shape>>(data, mapping_of(shape));
+}
+
+// View of the elements of buffer, read only for const buffers. Valid until
+// the buffer is resized or destroyed
+template <typename Buffer>
+    requires dt_concepts::Buffer<std::remove_const_t<Buffer>>
+[[nodiscard]]
+constexpr auto to_mdspan(Buffer& buffer) noexcept
+{
+    using element_t = std::conditional_t<
+        std::is_const_v<Buffer>,
+        typename Buffer::value_type const,
+        typename Buffer::value_type>;
+    element_t* const data = std::to_address(buffer.data());
+    return to_mdspan(buffer, data);
+}
+
+} // namespace data_types::buffer_mdspan
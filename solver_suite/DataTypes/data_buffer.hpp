@@ -2,7 +2,9 @@
 
 #include "buffer_config.hpp"
 #include "data_type_concepts.hpp"
+#include "data_view.hpp"
 #include "dynamic_array.hpp"
+#include "execution_policy.hpp"
 #include "lazy_container_operations.hpp"
 #include "static_array.hpp"
 #include <concepts>
@@ -29,7 +31,11 @@ public:
     static constexpr size_type s_size_x              = Size_X;
     static constexpr auto      s_layout_policy       = Layout_Policy;
     static constexpr auto      s_layout_minor_stride = Layout_Minor_Stride;
-    static constexpr size_type s_underlying_size_y   = [] constexpr {
+    // Rows per block in blocked layouts, see buffer_config::LayoutPolicy
+    static constexpr size_type s_block_width = s_layout_policy.block_width;
+    static constexpr size_type s_block_count =
+        (Size_Y + s_block_width - 1) / s_block_width;
+    static constexpr size_type s_underlying_size_y = [] constexpr {
         if constexpr (s_layout_policy == layout_policy_t::layout_row_major)
         {
             return Size_Y;
@@ -38,6 +44,10 @@ public:
         {
             return Size_X;
         }
+        else if constexpr (s_layout_policy.blocked())
+        {
+            return Size_X * s_block_count;
+        }
         else
         {
             static_assert(false, "Layout policy not recognized or not implemented");
@@ -64,6 +74,13 @@ public:
             );
             return std::max(Size_Y, s_layout_minor_stride.value());
         }
+        else if constexpr (s_layout_policy.blocked())
+        {
+            static_assert(
+                !s_layout_minor_stride.padded(), "Blocked layouts take no stride"
+            );
+            return s_block_width;
+        }
         else
         {
             static_assert(false, "Layout policy not recognized or not implemented");
@@ -71,6 +88,31 @@ public:
     }();
     static constexpr size_type s_underlying_size =
         s_underlying_size_x * s_underlying_size_y;
+    // Elements per line of storage: per row in row major layouts, per column
+    // in column major ones and per column of a block in blocked ones. Flat
+    // indices run along the lines
+    static constexpr size_type s_minor_extent =
+        s_layout_policy == layout_policy_t::layout_row_major      ? Size_X
+        : s_layout_policy == layout_policy_t::layout_column_major ? Size_Y
+                                                                  : s_block_width;
+    // Whether the lines are padded, see dt_concepts::LineStrided, and by how many
+    // elements
+    static constexpr bool      s_line_strided = s_underlying_size_x != s_minor_extent;
+    static constexpr size_type s_line_slack   = s_underlying_size_x - s_minor_extent;
+    // Elements visited by flat indices. In blocked layouts these are whole
+    // blocks, the rows past Size_Y in the last one are evaluated along with the
+    // others so that every loop runs over full lines. Those rows start zeroed
+    // and the reductions leave them out, see operation_utils::last_block
+    static constexpr size_type s_flat_size =
+        s_layout_policy.blocked() ? s_underlying_size : Size_Y * Size_X;
+    // Distance in storage between consecutive elements of a column (s_stride_y)
+    // and of a row (s_stride_x), the columns of blocked layouts have none
+    static constexpr size_type s_stride_y =
+        s_layout_policy == layout_policy_t::layout_row_major      ? s_underlying_size_x
+        : s_layout_policy == layout_policy_t::layout_column_major ? 1uz
+                                                                  : std::dynamic_extent;
+    static constexpr size_type s_stride_x =
+        s_layout_policy == layout_policy_t::layout_row_major ? 1uz : s_underlying_size_x;
     using container_t = eagerly_evaluated_containers::static_array<T, s_underlying_size>;
     using const_iterator = typename container_t::const_iterator;
     using iterator       = typename container_t::iterator;
@@ -81,11 +123,50 @@ public:
     constexpr auto operator=(dt_concepts::ExpressionTemplate auto const& src) noexcept
         -> static_buffer&
     {
-        const auto n = size();
-        for (size_type i = 0; i != n; ++i)
+        return assign(src);
+    }
+
+    // Evaluates src into this buffer, split over threads as set by the policy
+    constexpr auto assign(
+        dt_concepts::ExpressionTemplate auto const& src,
+        utility::parallel::execution_policy const&  policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> static_buffer&
+    {
+        using src_t = std::remove_cvref_t<decltype(src)>;
+        static_assert(
+            src_t::s_static_extent == std::dynamic_extent ||
+            src_t::s_static_extent == size()
+        );
+        operation_utils::check_extent(src.size(), size());
+        if constexpr (by_lines<decltype(src)>())
+        {
+            operation_utils::check_line_extents(src, minor_extent());
+            utility::parallel::for_each_chunk<value_type>(
+                policy, size(), [this, &src, &policy](size_type first, size_type last) {
+                    operation_utils::evaluate_line_range(
+                        [this](size_type j) { return line(j); },
+                        src,
+                        first,
+                        last,
+                        minor_extent(),
+                        line_slack<decltype(src)>(),
+                        policy
+                    );
+                }
+            );
+        }
+        else
         {
-            this->operator[](i) = src[i];
+            utility::parallel::for_each_chunk<value_type>(
+                policy, size(), [this, &src, &policy](size_type first, size_type last) {
+                    operation_utils::evaluate_range(
+                        std::to_address(data_.begin()), src, first, last, policy
+                    );
+                }
+            );
         }
+        operation_utils::mark_evaluated(src);
         return *this;
     }
 
@@ -116,13 +197,13 @@ public:
     [[nodiscard, gnu::const]]
     static constexpr auto size() noexcept -> size_type
     {
-        return size_x() * size_y();
+        return s_flat_size;
     }
 
     [[nodiscard, gnu::const]]
     static constexpr auto flat_size() noexcept -> size_type
     {
-        return size_y() * size_x();
+        return s_flat_size;
     }
 
     [[nodiscard, gnu::const]]
@@ -143,6 +224,20 @@ public:
         return s_underlying_size;
     }
 
+    [[nodiscard, gnu::const]]
+    static constexpr auto minor_extent() noexcept -> size_type
+    {
+        return s_minor_extent;
+    }
+
+    // First element of line j of the storage
+    [[nodiscard]]
+    constexpr auto line(this auto&& self, index_t j) noexcept
+    {
+        assert(j < size() / minor_extent());
+        return std::to_address(self.data()) + j * underlying_size_x();
+    }
+
     [[nodiscard, gnu::const]]
     static constexpr auto flat_projection(index_t idx_y, index_t idx_x) noexcept
         -> index_t
@@ -157,12 +252,60 @@ public:
         {
             return idx_x + underlying_size_x() * idx_y;
         }
+        else if constexpr (s_layout_policy.blocked())
+        {
+            return (idx_y / s_block_width * s_size_x + idx_x) * s_block_width +
+                   idx_y % s_block_width;
+        }
         else
         {
             static_assert(false, "Layout policy not recognized or not implemented");
         }
     }
 
+    // Views of row y, column x and the block of size_y x size_x elements from
+    // (y, x), see data_view.hpp. Read only on const buffers
+    [[nodiscard]]
+    constexpr auto row(this auto&& self, index_t y) noexcept
+    {
+        using element_t = std::remove_reference_t<decltype(*self.data())>;
+        return strided_view<element_t, s_stride_x>(
+            std::to_address(self.data()) + flat_projection(y, 0), size_x()
+        );
+    }
+
+    [[nodiscard]]
+    constexpr auto column(this auto&& self, index_t x) noexcept
+        requires(!s_layout_policy.blocked())
+    {
+        using element_t = std::remove_reference_t<decltype(*self.data())>;
+        return strided_view<element_t, s_stride_y>(
+            std::to_address(self.data()) + flat_projection(0, x), size_y()
+        );
+    }
+
+    [[nodiscard]]
+    constexpr auto sub_block(
+        this auto&& self,
+        index_t     y,
+        index_t     x,
+        size_type   size_y,
+        size_type   size_x
+    ) noexcept
+        requires(!s_layout_policy.blocked())
+    {
+        assert(size_y > 0 && y + size_y <= s_size_y);
+        assert(size_x > 0 && x + size_x <= s_size_x);
+        using element_t = std::remove_reference_t<decltype(*self.data())>;
+        return block_view<element_t>(
+            std::to_address(self.data()) + flat_projection(y, x),
+            size_y,
+            size_x,
+            s_stride_y,
+            s_stride_x
+        );
+    }
+
     [[nodiscard]]
     constexpr auto data(this auto&& self) noexcept -> decltype(auto)
     {
@@ -174,13 +317,16 @@ public:
         -> decltype(auto)
     {
         assert(0 <= idx && static_cast<size_type>(idx) < self.size());
-        if constexpr (s_layout_minor_stride.padded())
+        if constexpr (s_line_strided)
         {
-            const auto j = static_cast<index_t>(idx / size_x());
-            const auto i = static_cast<index_t>(idx % size_x());
-            idx          = flat_projection(j, i);
+            const auto j = static_cast<index_t>(idx) / minor_extent();
+            const auto i = static_cast<index_t>(idx) % minor_extent();
+            return std::forward<decltype(self)>(self).data_[j * underlying_size_x() + i];
+        }
+        else
+        {
+            return std::forward<decltype(self)>(self).data_[idx];
         }
-        return std::forward<decltype(self)>(self).data_[idx];
     }
 
     [[nodiscard]]
@@ -197,64 +343,125 @@ public:
 
     [[nodiscard]]
     constexpr auto cbegin() const noexcept -> const_iterator
-        requires(!s_layout_minor_stride.padded())
+        requires(!s_line_strided)
     {
         return std::cbegin(data_);
     }
 
     [[nodiscard]]
     constexpr auto cend() const noexcept -> iterator
-        requires(!s_layout_minor_stride.padded())
+        requires(!s_line_strided)
     {
         return std::cend(data_);
     }
 
     [[nodiscard]]
     constexpr auto begin(this auto&& self) noexcept -> decltype(auto)
-        requires(!s_layout_minor_stride.padded())
+        requires(!s_line_strided)
     {
         return std::begin(std::forward<decltype(self)>(self).data_);
     }
 
     [[nodiscard]]
     constexpr auto end(this auto&& self) noexcept -> decltype(auto)
-        requires(!s_layout_minor_stride.padded())
+        requires(!s_line_strided)
     {
         return std::end(std::forward<decltype(self)>(self).data_);
     }
 
     constexpr auto operator+=(this auto& self, auto&& other) noexcept -> static_buffer&
     {
-        self.data_ += std::forward<decltype(other)>(other);
+        self.in_place_operator_impl_(std::forward<decltype(other)>(other), std::plus{});
         return self;
     }
 
     constexpr auto operator-=(this auto& self, auto&& other) noexcept -> static_buffer&
     {
-        self.data_ -= std::forward<decltype(other)>(other);
+        self.in_place_operator_impl_(std::forward<decltype(other)>(other), std::minus{});
         return self;
     }
 
     constexpr auto operator*=(this auto& self, auto&& other) noexcept -> static_buffer&
     {
-        self.data_ *= std::forward<decltype(other)>(other);
+        self.in_place_operator_impl_(
+            std::forward<decltype(other)>(other), std::multiplies{}
+        );
         return self;
     }
 
     constexpr auto operator/=(this auto& self, auto&& other) noexcept -> static_buffer&
     {
-        self.data_ /= std::forward<decltype(other)>(other);
+        self.in_place_operator_impl_(
+            std::forward<decltype(other)>(other), std::divides{}
+        );
         return self;
     }
 
+    // Line by line when either side has padded lines, skipping the padding,
+    // otherwise over the underlying array
+    constexpr auto in_place_operator_impl_(
+        this auto& a,
+        auto&&     b,
+        auto&&     binary_op
+    ) noexcept -> void
+    {
+        if constexpr (by_lines<decltype(b)>())
+        {
+            operation_utils::check_extent(
+                operation_utils::common_extent({ a.size(), operation_utils::extent(b) }),
+                a.size()
+            );
+            operation_utils::check_line_extents(b, a.minor_extent());
+            auto const& policy = utility::parallel::default_execution_policy();
+            utility::parallel::for_each_chunk<value_type>(
+                policy, a.size(), [&](size_type first, size_type last) {
+                    operation_utils::update_line_range(
+                        [&](size_type j) { return a.line(j); },
+                        b,
+                        binary_op,
+                        first,
+                        last,
+                        a.minor_extent(),
+                        line_slack<decltype(b)>(),
+                        policy
+                    );
+                }
+            );
+            operation_utils::mark_evaluated(b);
+        }
+        else
+        {
+            a.data_.in_place_operator_impl_(std::forward<decltype(b)>(b), binary_op);
+        }
+    }
+
     [[nodiscard]]
     constexpr auto operator<=>(static_buffer const&) const = default;
 
-    container_t data_;
+private:
+    // Whether loops with src go line by line, see in_place_operator_impl_
+    template <typename Src>
+    [[nodiscard]]
+    static consteval auto by_lines() noexcept -> bool
+    {
+        return s_line_strided || operation_utils::contains_line_strided_v<Src>;
+    }
+
+    // Padding past every line that both this buffer and src have
+    template <typename Src>
+    [[nodiscard]]
+    static consteval auto line_slack() noexcept -> size_type
+    {
+        return s_line_strided ? std::min(s_line_slack, operation_utils::line_slack_v<Src>)
+                              : 0uz;
+    }
+
+public:
+    container_t data_{};
 };
 
 template <typename T, std::size_t Size_X, typename Allocator = std::allocator<T>>
-class dynamic_length_buffer
+class dynamic_length_buffer : dt_concepts::data_buffer_base
 {
 public:
     using value_type                    = T;
@@ -263,8 +470,12 @@ public:
     using layout_policy_t               = buffer_config::LayoutPolicy;
     static constexpr size_type s_size_y = std::dynamic_extent;
     static constexpr size_type s_size_x = Size_X;
+    // Lines are padded whenever the stride, or in column major layouts the
+    // capacity, exceeds their extent, which is only known at run time
+    static constexpr bool s_line_strided = true;
     static_assert(s_size_x > 0);
 
+    // Blocked layouts round the capacity up to whole blocks
     constexpr dynamic_length_buffer(
         size_type                                length,
         size_type                                capacity,
@@ -272,11 +483,14 @@ public:
         data_types::buffer_config::layout_stride minor_stride
     ) noexcept
         : size_y_{ length }
-        , capacity_y_{ std::max(capacity, size_y_) }
-        , underlying_size_y_{ layout_policy == layout_policy_t::layout_row_major
+        , capacity_y_{ round_up(std::max(capacity, size_y_), layout_policy.block_width) }
+        , underlying_size_y_{ layout_policy.blocked()
+                                  ? capacity_y_ / layout_policy.block_width * s_size_x
+                              : layout_policy == layout_policy_t::layout_row_major
                                   ? capacity_y_
                                   : s_size_x }
-        , underlying_size_x_{ layout_policy == layout_policy_t::layout_row_major
+        , underlying_size_x_{ layout_policy.blocked() ? layout_policy.block_width
+                              : layout_policy == layout_policy_t::layout_row_major
                                   ? std::max(s_size_x, minor_stride.value())
                                   : std::max(capacity_y_, minor_stride.value()) }
         , stride_y_{ layout_policy == layout_policy_t::layout_row_major
@@ -285,21 +499,25 @@ public:
         , stride_x_{ layout_policy == layout_policy_t::layout_row_major
                          ? size_type{ 1 }
                          : underlying_size_x_ }
-        , data_(underlying_size_y_ * underlying_size_x_)
+        , data_(underlying_size_y_ * underlying_size_x_, value_type{})
         , layout_policy_{ layout_policy }
-        , padded_{ minor_stride.padded() }
     {
         assert(
             layout_policy_ == layout_policy_t::layout_column_major ||
-            layout_policy_ == layout_policy_t::layout_row_major
+            layout_policy_ == layout_policy_t::layout_row_major ||
+            layout_policy_.blocked()
         );
-        switch (layout_policy_)
+        switch (layout_policy_.kind)
         {
-        case layout_policy_t::layout_column_major:
-            assert(capacity_y_ <= minor_stride.value());
+        case layout_policy_t::kind_t::column_major:
+            assert(!minor_stride.padded() || capacity_y_ <= minor_stride.value());
+            break;
+        case layout_policy_t::kind_t::row_major:
+            assert(!minor_stride.padded() || s_size_x <= minor_stride.value());
             break;
-        case layout_policy_t::layout_row_major:
-            assert(s_size_x <= minor_stride.value());
+        case layout_policy_t::kind_t::blocked:
+            assert(layout_policy_.block_width > 0);
+            assert(!minor_stride.padded());
             break;
         default: utility::error_handling::assert_unreachable(); break;
         }
@@ -334,10 +552,24 @@ public:
         return s_size_x;
     }
 
+    // Elements visited by flat indices. In blocked layouts these are whole
+    // blocks, as in static_buffer
     [[nodiscard]]
     constexpr auto flat_size() const noexcept -> size_type
     {
-        return size_y() * size_x();
+        return round_up(size_y(), layout_policy_.block_width) * size_x();
+    }
+
+    [[nodiscard]]
+    constexpr auto size() const noexcept -> size_type
+    {
+        return flat_size();
+    }
+
+    [[nodiscard]]
+    constexpr auto layout_policy() const noexcept -> layout_policy_t
+    {
+        return layout_policy_;
     }
 
     [[nodiscard]]
@@ -358,14 +590,88 @@ public:
         return underlying_size_y() * underlying_size_x();
     }
 
+    // Elements per line of storage: per row in row major layouts, per column
+    // in column major ones and per column of a block in blocked ones. Flat
+    // indices run along the lines
+    [[nodiscard]]
+    constexpr auto minor_extent() const noexcept -> size_type
+    {
+        if (layout_policy_.blocked())
+        {
+            return layout_policy_.block_width;
+        }
+        return layout_policy_ == layout_policy_t::layout_row_major ? s_size_x : size_y_;
+    }
+
+    // First element of line j of the storage
+    [[nodiscard]]
+    constexpr auto line(this auto&& self, index_t j) noexcept
+    {
+        assert(j < self.size() / self.minor_extent());
+        return std::to_address(self.data()) + j * self.underlying_size_x_;
+    }
+
     [[nodiscard, gnu::const]]
     constexpr auto flat_projection(index_t idx_y, index_t idx_x) const noexcept -> index_t
     {
         assert(idx_y < size_y_);
         assert(idx_x < s_size_x);
+        if (layout_policy_.blocked())
+        {
+            const auto w = layout_policy_.block_width;
+            return (idx_y / w * s_size_x + idx_x) * w + idx_y % w;
+        }
         return idx_y * stride_y_ + idx_x * stride_x_;
     }
 
+    // Views of row y, column x and the block of size_y x size_x elements from
+    // (y, x), see data_view.hpp. Read only on const buffers. Blocked layouts
+    // only have row views
+    [[nodiscard]]
+    constexpr auto row(this auto&& self, index_t y) noexcept
+    {
+        using element_t = std::remove_reference_t<decltype(*self.data())>;
+        return strided_view<element_t>(
+            std::to_address(self.data()) + self.flat_projection(y, 0),
+            s_size_x,
+            self.stride_x_
+        );
+    }
+
+    [[nodiscard]]
+    constexpr auto column(this auto&& self, index_t x) noexcept
+    {
+        assert(!self.layout_policy_.blocked());
+        using element_t = std::remove_reference_t<decltype(*self.data())>;
+        return strided_view<element_t>(
+            std::to_address(self.data()) + self.flat_projection(0, x),
+            self.size_y_,
+            self.stride_y_
+        );
+    }
+
+    [[nodiscard]]
+    constexpr auto sub_block(
+        this auto&& self,
+        index_t     y,
+        index_t     x,
+        size_type   size_y,
+        size_type   size_x
+    ) noexcept
+    {
+        assert(!self.layout_policy_.blocked());
+        assert(size_y > 0 && y + size_y <= self.size_y_);
+        assert(size_x > 0 && x + size_x <= s_size_x);
+        using element_t = std::remove_reference_t<decltype(*self.data())>;
+        return block_view<element_t>(
+            std::to_address(self.data()) + self.flat_projection(y, x),
+            size_y,
+            size_x,
+            self.stride_y_,
+            self.stride_x_
+        );
+    }
+
     [[nodiscard]]
     constexpr auto data(this auto&& self) noexcept -> decltype(auto)
     {
@@ -377,11 +683,13 @@ public:
         -> decltype(auto)
     {
         assert(0 <= idx && static_cast<size_type>(idx) < self.size());
-        if (self.padded_)
+        const auto m = self.minor_extent();
+        if (self.underlying_size_x_ != m)
         {
-            const auto j = static_cast<index_t>(idx / size_x());
-            const auto i = static_cast<index_t>(idx % size_x());
-            idx          = self.flat_projection(j, i);
+            const auto j = static_cast<index_t>(idx) / m;
+            const auto i = static_cast<index_t>(idx) % m;
+            return std::forward<decltype(self)>(self)
+                .data_[j * self.underlying_size_x_ + i];
         }
         return std::forward<decltype(self)>(self).data_[idx];
     }
@@ -399,38 +707,123 @@ public:
             .data_[self.flat_projection(idx_y, idx_x)];
     }
 
+    constexpr auto operator=(dt_concepts::ExpressionTemplate auto const& src) noexcept
+        -> dynamic_length_buffer&
+    {
+        return assign(src);
+    }
+
+    // Evaluates src into this buffer line by line, split over threads as set
+    // by the policy
+    constexpr auto assign(
+        dt_concepts::ExpressionTemplate auto const& src,
+        utility::parallel::execution_policy const&  policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> dynamic_length_buffer&
+    {
+        operation_utils::check_extent(src.size(), size());
+        operation_utils::check_line_extents(src, minor_extent());
+        utility::parallel::for_each_chunk<value_type>(
+            policy, size(), [this, &src, &policy](size_type first, size_type last) {
+                operation_utils::evaluate_line_range(
+                    [this](size_type j) { return line(j); },
+                    src,
+                    first,
+                    last,
+                    minor_extent(),
+                    line_slack<decltype(src)>(),
+                    policy
+                );
+            }
+        );
+        operation_utils::mark_evaluated(src);
+        return *this;
+    }
+
     constexpr auto operator+=(this auto& self, auto&& other) noexcept
         -> dynamic_length_buffer&
     {
-        self.data_ += std::forward<decltype(other)>(other);
+        self.in_place_operator_impl_(std::forward<decltype(other)>(other), std::plus{});
         return self;
     }
 
     constexpr auto operator-=(this auto& self, auto&& other) noexcept
         -> dynamic_length_buffer&
     {
-        self.data_ -= std::forward<decltype(other)>(other);
+        self.in_place_operator_impl_(std::forward<decltype(other)>(other), std::minus{});
         return self;
     }
 
     constexpr auto operator*=(this auto& self, auto&& other) noexcept
         -> dynamic_length_buffer&
     {
-        self.data_ *= std::forward<decltype(other)>(other);
+        self.in_place_operator_impl_(
+            std::forward<decltype(other)>(other), std::multiplies{}
+        );
         return self;
     }
 
     constexpr auto operator/=(this auto& self, auto&& other) noexcept
         -> dynamic_length_buffer&
     {
-        self.data_ /= std::forward<decltype(other)>(other);
+        self.in_place_operator_impl_(
+            std::forward<decltype(other)>(other), std::divides{}
+        );
         return self;
     }
 
+    // Line by line, skipping the padding
+    constexpr auto in_place_operator_impl_(
+        this auto&                                 a,
+        auto&&                                     b,
+        auto&&                                     binary_op,
+        utility::parallel::execution_policy const& policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> void
+    {
+        operation_utils::check_extent(
+            operation_utils::common_extent({ a.size(), operation_utils::extent(b) }),
+            a.size()
+        );
+        operation_utils::check_line_extents(b, a.minor_extent());
+        utility::parallel::for_each_chunk<value_type>(
+            policy, a.size(), [&](size_type first, size_type last) {
+                operation_utils::update_line_range(
+                    [&](size_type j) { return a.line(j); },
+                    b,
+                    binary_op,
+                    first,
+                    last,
+                    a.minor_extent(),
+                    a.template line_slack<decltype(b)>(),
+                    policy
+                );
+            }
+        );
+        operation_utils::mark_evaluated(b);
+    }
+
     [[nodiscard]]
     constexpr auto operator<=>(dynamic_length_buffer const&) const = default;
 
 private:
+    // Padding past every line that both this buffer and src have
+    template <typename Src>
+    [[nodiscard]]
+    constexpr auto line_slack() const noexcept -> size_type
+    {
+        return std::min(
+            underlying_size_x_ - minor_extent(), operation_utils::line_slack_v<Src>
+        );
+    }
+
+    [[nodiscard, gnu::const]]
+    static constexpr auto round_up(size_type n, size_type block_width) noexcept
+        -> size_type
+    {
+        return (n + block_width - 1) / block_width * block_width;
+    }
+
     size_type       size_y_;
     size_type       capacity_y_;
     size_type       underlying_size_y_;
@@ -439,7 +832,6 @@ private:
     size_type       stride_x_;
     container_t     data_;
     layout_policy_t layout_policy_;
-    bool            padded_;
 };
 
 template <
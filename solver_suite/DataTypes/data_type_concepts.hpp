@@ -2,6 +2,7 @@
 
 #include "concepts.hpp"
 #include <concepts>
+#include <cstddef>
 #include <iterator>
 #include <type_traits>
 #include <utility>
@@ -18,6 +19,10 @@ concept Resizeable = requires(T t, const T ct, typename T::size_type n) {
     t.resize(n);
 };
 
+// Containers shaped after another one, for shapes that a size does not set
+template <typename T, typename U>
+concept ResizeableLike = requires(T t, U const& u) { t.resize_like(u); };
+
 template <typename T>
 concept Indexable = requires(T t) {
     { t[std::declval<int>()] };
@@ -40,6 +45,14 @@ struct expression_templates_base
 {
 };
 
+struct cached_expression_base
+{
+};
+
+struct data_view_base
+{
+};
+
 template <typename T>
 concept StaticArray =
     requires { T::s_size; } && Indexable<T> && SizedInstance<T> && std::ranges::range<T>;
@@ -50,24 +63,42 @@ concept DynamicArray = std::is_base_of_v<dynamic_array_base, T> && Indexable<T>
 
 template <typename T>
 concept Buffer = std::is_base_of_v<data_buffer_base, T> && Indexable<T> &&
-                 Indexable2D<T> && SizedInstance<T> && std::ranges::range<T>;
+                 Indexable2D<T> && SizedInstance<T>;
+
+// Containers stored as lines of minor_extent() contiguous elements with gaps
+// between them, line j starting at line(j). Flat indices run along the lines
+template <typename T>
+concept LineStrided = requires(T const& t) {
+    requires std::remove_cvref_t<T>::s_line_strided;
+    { t.minor_extent() } -> std::convertible_to<std::size_t>;
+    t.line(std::size_t{});
+};
+
+// Non-owning views of the elements of containers, held by value in expressions
+template <typename T>
+concept View = std::is_base_of_v<data_view_base, T> && Indexable<T> && SizedInstance<T>;
 
 template <typename T>
 concept ExpressionTemplate =
     std::is_base_of_v<expression_templates_base, T> && Indexable<T>;
 
+// Subexpression written once to a storage container, see eval_once
+template <typename T>
+concept CachedExpression =
+    std::is_base_of_v<cached_expression_base, T> && ExpressionTemplate<T>;
+
 template <typename T>
 concept ScalarType = utility::concepts::arithmetic<T>;
 
 template <typename T>
 concept ValidExprOperand = DynamicArray<T> || ExpressionTemplate<T> || ScalarType<T> ||
-                           StaticArray<T> || Buffer<T>;
+                           StaticArray<T> || Buffer<T> || View<T>;
 
 template <typename T>
 concept EagerEvaluation = StaticArray<T> || ScalarType<T>;
 
 template <typename T>
-concept LazyEvaluation = ExpressionTemplate<T> || DynamicArray<T> || Buffer<T>;
+concept LazyEvaluation = ExpressionTemplate<T> || DynamicArray<T> || Buffer<T> || View<T>;
 
 template <typename A, typename B>
 concept EagerlyEvaluatedExpr = EagerEvaluation<A> && EagerEvaluation<B>;
@@ -76,6 +107,7 @@ template <typename A, typename B>
 concept LazilyEvaluatedExpr = LazyEvaluation<A> || LazyEvaluation<B>;
 
 template <typename T>
-concept ExprHoldReferenceType = DynamicArray<T> || Buffer<T>;
+concept ExprHoldReferenceType =
+    DynamicArray<T> || StaticArray<T> || Buffer<T> || CachedExpression<T>;
 
 } // namespace data_types::dt_concepts
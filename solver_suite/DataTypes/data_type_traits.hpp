@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <span>
 #include <type_traits>
 
 namespace data_types::dt_traits
@@ -19,4 +21,41 @@ struct is_same_size<T1, T2> : std::true_type
 template <typename T1, typename T2>
 constexpr bool is_same_size_v = is_same_size<T1, T2>::value;
 
+// Element count of T when known at compile time, std::dynamic_extent otherwise
+template <typename T>
+struct static_extent : std::integral_constant<std::size_t, std::dynamic_extent>
+{
+};
+
+template <typename T>
+    requires requires { std::integral_constant<std::size_t, T::size()>{}; }
+struct static_extent<T> : std::integral_constant<std::size_t, T::size()>
+{
+};
+
+template <typename T>
+    requires requires { T::s_static_extent; }
+struct static_extent<T> : std::integral_constant<std::size_t, T::s_static_extent>
+{
+};
+
+template <typename T>
+constexpr std::size_t static_extent_v = static_extent<std::remove_cvref_t<T>>::value;
+
+// Static extent shared by the operands of an expression, std::dynamic_extent if
+// none of them has one
+template <typename... Ts>
+constexpr std::size_t common_static_extent_v = [] consteval {
+    auto ret = std::dynamic_extent;
+    ((ret = ret == std::dynamic_extent ? static_extent_v<Ts> : ret), ...);
+    return ret;
+}();
+
+template <typename... Ts>
+constexpr bool static_extents_agree_v = [] consteval {
+    constexpr auto e = common_static_extent_v<Ts...>;
+    return ((static_extent_v<Ts> == std::dynamic_extent || static_extent_v<Ts> == e) &&
+            ...);
+}();
+
 } // namespace data_types::dt_traits
@@ -0,0 +1,501 @@
+#pragma once
+
+#include "data_type_concepts.hpp"
+#include "execution_policy.hpp"
+#include "operation_utils.hpp"
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <type_traits>
+
+namespace data_types::lazily_evaluated_containers
+{
+
+// Non-owning view of size() elements, element i at data()[i * stride()], e.g. a
+// row or a column of a buffer. The stride is set at compile time unless it is
+// std::dynamic_extent, views with a stride of 1 are contiguous ranges. Views of
+// const T are read only.
+//
+// Views are cheap to copy and expressions hold them by value, so views made on
+// the spot can be operands. Assignments write the elements, as for
+// std::slice_array, never rebind the view.
+template <typename T, std::size_t Stride = std::dynamic_extent>
+class strided_view : dt_concepts::data_view_base
+{
+public:
+    using value_type = std::remove_cv_t<T>;
+    using size_type  = std::size_t;
+    using pointer    = T*;
+    using reference  = T&;
+    using iterator   = pointer;
+
+    inline static constexpr auto s_stride     = Stride;
+    inline static constexpr bool s_contiguous = Stride == 1;
+
+public:
+    constexpr strided_view(pointer data, size_type size) noexcept
+        requires(Stride != std::dynamic_extent)
+        : data_{ data }
+        , size_{ size }
+        , stride_{ Stride }
+    {
+    }
+
+    constexpr strided_view(pointer data, size_type size, size_type stride) noexcept
+        : data_{ data }
+        , size_{ size }
+        , stride_{ stride }
+    {
+        assert(Stride == std::dynamic_extent || stride == Stride);
+    }
+
+    // Read only views of mutable ones, and views with the stride only known at
+    // run time of ones with a static stride
+    template <typename U, std::size_t S>
+        requires std::convertible_to<U (*)[], T (*)[]> &&
+                 (Stride == std::dynamic_extent || S == Stride)
+    constexpr strided_view(strided_view<U, S> const& other) noexcept
+        : strided_view(other.data(), other.size(), other.stride())
+    {
+    }
+
+    constexpr strided_view(strided_view const&) noexcept = default;
+
+    constexpr auto operator=(strided_view const& other) noexcept -> strided_view&
+    {
+        return assign(other);
+    }
+
+    constexpr auto operator=(dt_concepts::ValidExprOperand auto const& src) noexcept
+        -> strided_view&
+    {
+        return assign(src);
+    }
+
+    // Evaluates src into the viewed elements. Contiguous views are split over
+    // threads as set by the policy, strided ones are written in order, block by
+    // block along with the cached subexpressions of src
+    constexpr auto assign(
+        auto const&                                src,
+        utility::parallel::execution_policy const& policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> strided_view&
+        requires(!std::is_const_v<T>)
+    {
+        operation_utils::check_extent(
+            operation_utils::common_extent({ size(), operation_utils::extent(src) }),
+            size()
+        );
+        if constexpr (s_contiguous)
+        {
+            utility::parallel::for_each_chunk<value_type>(
+                policy, size(), [this, &src, &policy](size_type first, size_type last) {
+                    operation_utils::evaluate_range(data_, src, first, last, policy);
+                }
+            );
+        }
+        else
+        {
+            operation_utils::for_each_fused_block<value_type>(
+                src,
+                0uz,
+                size(),
+                [this, &src](size_type first, size_type last) {
+                    for (auto i = first; i != last; ++i)
+                    {
+                        (*this)[i] = operation_utils::subscript(src, i);
+                    }
+                },
+                policy
+            );
+        }
+        operation_utils::mark_evaluated(src);
+        return *this;
+    }
+
+    [[nodiscard]]
+    constexpr auto data() const noexcept -> pointer
+    {
+        return data_;
+    }
+
+    [[nodiscard]]
+    constexpr auto size() const noexcept -> size_type
+    {
+        return size_;
+    }
+
+    [[nodiscard]]
+    constexpr auto stride() const noexcept -> size_type
+    {
+        if constexpr (Stride != std::dynamic_extent)
+        {
+            return Stride;
+        }
+        else
+        {
+            return stride_;
+        }
+    }
+
+    [[nodiscard]]
+    constexpr auto empty() const noexcept -> bool
+    {
+        return size_ == 0;
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](std::integral auto idx) const noexcept -> reference
+    {
+        assert(0 <= idx && static_cast<size_type>(idx) < size_);
+        return data_[static_cast<size_type>(idx) * stride()];
+    }
+
+    [[nodiscard]]
+    constexpr auto begin() const noexcept -> iterator
+        requires s_contiguous
+    {
+        return data_;
+    }
+
+    [[nodiscard]]
+    constexpr auto end() const noexcept -> iterator
+        requires s_contiguous
+    {
+        return data_ + size_;
+    }
+
+    constexpr auto operator+=(auto&& other) noexcept -> strided_view&
+    {
+        in_place_operator_impl_(std::forward<decltype(other)>(other), std::plus{});
+        return *this;
+    }
+
+    constexpr auto operator-=(auto&& other) noexcept -> strided_view&
+    {
+        in_place_operator_impl_(std::forward<decltype(other)>(other), std::minus{});
+        return *this;
+    }
+
+    constexpr auto operator*=(auto&& other) noexcept -> strided_view&
+    {
+        in_place_operator_impl_(std::forward<decltype(other)>(other), std::multiplies{});
+        return *this;
+    }
+
+    constexpr auto operator/=(auto&& other) noexcept -> strided_view&
+    {
+        in_place_operator_impl_(std::forward<decltype(other)>(other), std::divides{});
+        return *this;
+    }
+
+    constexpr auto in_place_operator_impl_(
+        auto&&                                     b,
+        auto&&                                     binary_op,
+        utility::parallel::execution_policy const& policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> void
+        requires(!std::is_const_v<T>)
+    {
+        operation_utils::check_extent(
+            operation_utils::common_extent({ size(), operation_utils::extent(b) }),
+            size()
+        );
+        if constexpr (s_contiguous)
+        {
+            utility::parallel::for_each_chunk<value_type>(
+                policy, size(), [&](size_type first, size_type last) {
+                    operation_utils::update_range(
+                        data_, b, binary_op, first, last, policy
+                    );
+                }
+            );
+        }
+        else
+        {
+            operation_utils::for_each_fused_block<value_type>(
+                b,
+                0uz,
+                size(),
+                [&](size_type first, size_type last) {
+                    for (auto i = first; i != last; ++i)
+                    {
+                        (*this)[i] =
+                            binary_op((*this)[i], operation_utils::subscript(b, i));
+                    }
+                },
+                policy
+            );
+        }
+        operation_utils::mark_evaluated(b);
+    }
+
+private:
+    pointer   data_;
+    size_type size_;
+    size_type stride_;
+};
+
+// Non-owning view of a size_y() x size_x() block of a buffer, element (y, x) at
+// data()[y * stride_y() + x * stride_x()], one of the strides being 1. The
+// block is stored as lines of contiguous elements along the unit stride, see
+// dt_concepts::LineStrided, and as in the buffers flat indices run along them,
+// so blocks with lines in different directions do not mix in expressions.
+// Copies and assignments behave as for strided_view
+template <typename T>
+class block_view : dt_concepts::data_view_base
+{
+public:
+    using value_type = std::remove_cv_t<T>;
+    using size_type  = std::size_t;
+    using index_t    = std::size_t;
+    using pointer    = T*;
+    using reference  = T&;
+
+    static constexpr bool s_line_strided = true;
+
+public:
+    constexpr block_view(
+        pointer   data,
+        size_type size_y,
+        size_type size_x,
+        size_type stride_y,
+        size_type stride_x
+    ) noexcept
+        : data_{ data }
+        , size_y_{ size_y }
+        , size_x_{ size_x }
+        , stride_y_{ stride_y }
+        , stride_x_{ stride_x }
+    {
+        assert(stride_y_ == 1 || stride_x_ == 1);
+    }
+
+    template <typename U>
+        requires std::convertible_to<U (*)[], T (*)[]>
+    constexpr block_view(block_view<U> const& other) noexcept
+        : block_view(
+              other.data(),
+              other.size_y(),
+              other.size_x(),
+              other.stride_y(),
+              other.stride_x()
+          )
+    {
+    }
+
+    constexpr block_view(block_view const&) noexcept = default;
+
+    constexpr auto operator=(block_view const& other) noexcept -> block_view&
+    {
+        return assign(other);
+    }
+
+    constexpr auto operator=(dt_concepts::ValidExprOperand auto const& src) noexcept
+        -> block_view&
+    {
+        return assign(src);
+    }
+
+    // Evaluates src into the block line by line, split over threads as set by
+    // the policy
+    constexpr auto assign(
+        auto const&                                src,
+        utility::parallel::execution_policy const& policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> block_view&
+        requires(!std::is_const_v<T>)
+    {
+        operation_utils::check_extent(
+            operation_utils::common_extent({ size(), operation_utils::extent(src) }),
+            size()
+        );
+        operation_utils::check_line_extents(src, minor_extent());
+        utility::parallel::for_each_chunk<value_type>(
+            policy, size(), [this, &src, &policy](size_type first, size_type last) {
+                operation_utils::evaluate_line_range(
+                    [this](size_type j) { return line(j); },
+                    src,
+                    first,
+                    last,
+                    minor_extent(),
+                    0uz,
+                    policy
+                );
+            }
+        );
+        operation_utils::mark_evaluated(src);
+        return *this;
+    }
+
+    [[nodiscard]]
+    constexpr auto data() const noexcept -> pointer
+    {
+        return data_;
+    }
+
+    [[nodiscard]]
+    constexpr auto size_y() const noexcept -> size_type
+    {
+        return size_y_;
+    }
+
+    [[nodiscard]]
+    constexpr auto size_x() const noexcept -> size_type
+    {
+        return size_x_;
+    }
+
+    [[nodiscard]]
+    constexpr auto stride_y() const noexcept -> size_type
+    {
+        return stride_y_;
+    }
+
+    [[nodiscard]]
+    constexpr auto stride_x() const noexcept -> size_type
+    {
+        return stride_x_;
+    }
+
+    [[nodiscard]]
+    constexpr auto size() const noexcept -> size_type
+    {
+        return size_y_ * size_x_;
+    }
+
+    [[nodiscard]]
+    constexpr auto empty() const noexcept -> bool
+    {
+        return size() == 0;
+    }
+
+    // Elements per line: per row when rows are contiguous, per column
+    // otherwise
+    [[nodiscard]]
+    constexpr auto minor_extent() const noexcept -> size_type
+    {
+        return stride_x_ == 1 ? size_x_ : size_y_;
+    }
+
+    // First element of line j
+    [[nodiscard]]
+    constexpr auto line(index_t j) const noexcept -> pointer
+    {
+        assert(j < size() / minor_extent());
+        return data_ + j * (stride_x_ == 1 ? stride_y_ : stride_x_);
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](std::integral auto idx) const noexcept -> reference
+    {
+        assert(0 <= idx && static_cast<size_type>(idx) < size());
+        const auto m = minor_extent();
+        return line(static_cast<index_t>(idx) / m)[static_cast<index_t>(idx) % m];
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](std::integral auto idx_y, std::integral auto idx_x)
+        const noexcept -> reference
+    {
+        assert(0 <= idx_y && static_cast<size_type>(idx_y) < size_y_);
+        assert(0 <= idx_x && static_cast<size_type>(idx_x) < size_x_);
+        const auto y = static_cast<index_t>(idx_y);
+        const auto x = static_cast<index_t>(idx_x);
+        return data_[y * stride_y_ + x * stride_x_];
+    }
+
+    [[nodiscard]]
+    constexpr auto row(index_t y) const noexcept -> strided_view<T>
+    {
+        assert(y < size_y_);
+        return { data_ + y * stride_y_, size_x_, stride_x_ };
+    }
+
+    [[nodiscard]]
+    constexpr auto column(index_t x) const noexcept -> strided_view<T>
+    {
+        assert(x < size_x_);
+        return { data_ + x * stride_x_, size_y_, stride_y_ };
+    }
+
+    constexpr auto operator+=(auto&& other) noexcept -> block_view&
+    {
+        in_place_operator_impl_(std::forward<decltype(other)>(other), std::plus{});
+        return *this;
+    }
+
+    constexpr auto operator-=(auto&& other) noexcept -> block_view&
+    {
+        in_place_operator_impl_(std::forward<decltype(other)>(other), std::minus{});
+        return *this;
+    }
+
+    constexpr auto operator*=(auto&& other) noexcept -> block_view&
+    {
+        in_place_operator_impl_(std::forward<decltype(other)>(other), std::multiplies{});
+        return *this;
+    }
+
+    constexpr auto operator/=(auto&& other) noexcept -> block_view&
+    {
+        in_place_operator_impl_(std::forward<decltype(other)>(other), std::divides{});
+        return *this;
+    }
+
+    // Line by line, as assign
+    constexpr auto in_place_operator_impl_(
+        auto&&                                     b,
+        auto&&                                     binary_op,
+        utility::parallel::execution_policy const& policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> void
+        requires(!std::is_const_v<T>)
+    {
+        operation_utils::check_extent(
+            operation_utils::common_extent({ size(), operation_utils::extent(b) }),
+            size()
+        );
+        operation_utils::check_line_extents(b, minor_extent());
+        utility::parallel::for_each_chunk<value_type>(
+            policy, size(), [&](size_type first, size_type last) {
+                operation_utils::update_line_range(
+                    [this](size_type j) { return line(j); },
+                    b,
+                    binary_op,
+                    first,
+                    last,
+                    minor_extent(),
+                    0uz,
+                    policy
+                );
+            }
+        );
+        operation_utils::mark_evaluated(b);
+    }
+
+private:
+    pointer   data_;
+    size_type size_y_;
+    size_type size_x_;
+    size_type stride_y_;
+    size_type stride_x_;
+};
+
+template <typename T, std::size_t Stride>
+auto operator<<(std::ostream& os, strided_view<T, Stride> const& v) noexcept
+    -> std::ostream&
+{
+    os << "{ ";
+    for (auto i = 0uz; i != v.size(); ++i)
+    {
+        os << v[i] << (i + 1 != v.size() ? ", " : " ");
+    }
+    os << '}';
+
+    return os;
+}
+
+} // namespace data_types::lazily_evaluated_containers
@@ -3,32 +3,75 @@
 #include "casts.hpp"
 #include "data_type_concepts.hpp"
 #include "data_type_utils.hpp"
+#include "data_view.hpp"
+#include "execution_policy.hpp"
+#include "growth_policy.hpp"
 #include "lazy_container_operations.hpp"
+#include <algorithm>
+#include <bit>
 #include <concepts>
 #include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
-#define DISABLE_MOVE
+// #define DISABLE_MOVE
 
 // #define DISABLE_COPY
 
 namespace data_types::lazily_evaluated_containers
 {
 
-template <typename T, typename Allocator = std::allocator<T>>
+// The capacity is kept apart from the size: shrinking keeps the storage and
+// growing within the capacity reuses it, beyond it the storage grows as set
+// by the growth policy. Moves and swaps never allocate.
+//
+// The storage starts at an Alignment byte boundary, whatever the allocator,
+// and capacities are whole multiples of s_padding elements. Assignments and
+// compound assignments of floating point arrays padded to a whole simd width
+// then run whole packets into the padding instead of a scalar remainder.
+template <
+    typename                    T,
+    typename                    Allocator     = std::allocator<T>,
+    growth_policy::GrowthPolicy Growth_Policy = growth_policy::exact,
+    std::size_t                 Alignment     = alignof(T)>
 class dynamic_array : private Allocator, dt_concepts::dynamic_array_base
 {
 public:
-    using value_type  = T;
-    using size_type   = std::size_t;
-    using allocator_t = Allocator;
+    using value_type      = T;
+    using size_type       = std::size_t;
+    using allocator_t     = Allocator;
+    using growth_policy_t = Growth_Policy;
 
     using const_pointer  = value_type const*;
     using pointer        = value_type*;
     using const_iterator = const_pointer;
     using iterator       = pointer;
 
+    inline static constexpr size_type s_alignment = Alignment;
+    inline static constexpr size_type s_padding   = std::max(Alignment / sizeof(T), 1uz);
+
+    static_assert(std::has_single_bit(Alignment) && Alignment >= alignof(T));
+    static_assert(
+        Alignment == alignof(T) || Alignment % sizeof(T) == 0,
+        "Over-aligned storage must be padded in whole elements"
+    );
+
+private:
+    inline static constexpr bool s_over_aligned = Alignment > alignof(T);
+
+    // Extra elements allocated to align storage the allocator aligns to
+    // alignof(T) only
+    inline static constexpr size_type s_alignment_slack =
+        s_over_aligned ? (Alignment - alignof(T) + sizeof(T) - 1) / sizeof(T) : 0uz;
+
+    struct no_storage
+    {
+    };
+
+    using storage_t = std::conditional_t<s_over_aligned, T*, no_storage>;
+
 public:
     [[nodiscard]]
     constexpr auto allocator() const -> allocator_t const&
@@ -43,6 +86,13 @@ public:
     }
 
 public:
+    // Elements allocated for n elements, padding and alignment slack included
+    [[nodiscard]]
+    static constexpr auto allocation_size(size_type n) noexcept -> size_type
+    {
+        return padded_size(n) + s_alignment_slack;
+    }
+
     constexpr dynamic_array() noexcept
         : dynamic_array(allocator_t())
     {
@@ -52,6 +102,8 @@ public:
         : allocator_t{ alloc }
         , begin_{ nullptr }
         , end_{ nullptr }
+        , end_of_storage_{ nullptr }
+        , storage_{}
     {
     }
 
@@ -59,10 +111,9 @@ public:
         size_type          size,
         allocator_t const& alloc = allocator_t()
     ) noexcept
-        : allocator_t(alloc)
-        , begin_{ allocator().allocate(size) }
-        , end_{ begin_ + size }
+        : dynamic_array(alloc)
     {
+        resize_for_overwrite(size);
     }
 
     constexpr dynamic_array(
@@ -70,9 +121,7 @@ public:
         value_type const&  value,
         allocator_t const& alloc = allocator_t()
     ) noexcept
-        : allocator_t(alloc)
-        , begin_{ allocator().allocate(size) }
-        , end_{ begin_ + size }
+        : dynamic_array(size, alloc)
     {
         std::fill(begin_, end_, value);
     }
@@ -81,64 +130,79 @@ public:
         std::initializer_list<T> init,
         const allocator_t        alloc = allocator_t()
     ) noexcept
-        : allocator_t(alloc)
-        , begin_{ allocator().allocate(init.size()) }
-        , end_{ begin_ + init.size() }
+        : dynamic_array(init.size(), alloc)
     {
         std::ranges::copy(init, begin_);
     }
 
     constexpr dynamic_array(dt_concepts::ExpressionTemplate auto const& src) noexcept
-        requires dt_concepts::SizedInstance<decltype(src)>
-        : allocator_t()
-        , begin_{ allocator().allocate(src.size()) }
-        , end_{ begin_ + src.size() }
+        : dynamic_array()
     {
-        const auto n = src.size();
-        for (size_type i = 0; i != n; ++i)
-        {
-            begin_[i] = src[i];
-        }
+        assign(src);
     }
 
     constexpr auto operator=(dt_concepts::ExpressionTemplate auto const& src) noexcept
         -> dynamic_array&
     {
+        return assign(src);
+    }
+
+    // Evaluates src into this array, split over threads as set by the policy.
+    // The array is resized to src.size() first, which never happens when the
+    // array is itself an operand of src, and which only allocates beyond the
+    // capacity
+    constexpr auto assign(
+        dt_concepts::ExpressionTemplate auto const& src,
+        utility::parallel::execution_policy const&  policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> dynamic_array&
+    {
+        resize_for_overwrite(src.size());
         const auto n = size();
-        for (size_type i = 0; i != n; ++i)
-        {
-            begin_[i] = src[i];
-        }
+        const auto m = padded_end<decltype(src)>(n);
+        utility::parallel::for_each_chunk<value_type>(
+            policy, n, [this, &src, &policy, n, m](size_type first, size_type last) {
+                operation_utils::evaluate_range(
+                    data(), src, first, last == n ? m : last, policy
+                );
+            }
+        );
+        operation_utils::mark_evaluated(src);
         return *this;
     }
 
 #ifdef DISABLE_COPY
-    constexpr dynamic_vector(dynamic_vector const&) noexcept                    = delete;
-    constexpr auto operator=(dynamic_vector const&) noexcept -> dynamic_vector& = delete;
+    constexpr dynamic_array(dynamic_array const&) noexcept                    = delete;
+    constexpr auto operator=(dynamic_array const&) noexcept -> dynamic_array& = delete;
 #else
     constexpr dynamic_array(dynamic_array const& other) noexcept
-        : allocator_t(other.allocator())
-        , begin_{ allocator().allocate(other.size()) }
-        , end_{ begin_ + other.size() }
+        : dynamic_array(
+              other.size(),
+              std::allocator_traits<allocator_t>::select_on_container_copy_construction(
+                  other.allocator()
+              )
+          )
     {
         std::ranges::copy(other, this->begin_);
     }
 
+    // Reuses the storage when other fits in the capacity. The allocator of other
+    // is only taken along with new storage, and only when the allocator
+    // propagates on copy assignment
     constexpr auto operator=(dynamic_array const& other) noexcept -> dynamic_array&
     {
         if (this != &other)
         {
-            if (size() != other.size())
+            if (other.size() > capacity())
             {
-                if (begin_)
+                release();
+                if constexpr (std::allocator_traits<allocator_t>::
+                                  propagate_on_container_copy_assignment::value)
                 {
-                    allocator().deallocate(begin_, size());
-                    begin_ = nullptr;
+                    allocator() = other.allocator();
                 }
-                allocator() = other.allocator();
-                begin_      = allocator().allocate(other.size());
-                end_        = begin_ + other.size();
             }
+            resize_for_overwrite(other.size());
             std::ranges::copy(other, begin_);
         }
         return *this;
@@ -150,22 +214,24 @@ public:
     constexpr auto operator=(dynamic_array&&) noexcept -> dynamic_array& = delete;
 #else
     constexpr dynamic_array(dynamic_array&& other) noexcept
-        : begin_{ other.begin_ }
-        , end_{ other.end_ }
+        : allocator_t(std::move(other.allocator()))
+        , begin_{ std::exchange(other.begin_, nullptr) }
+        , end_{ std::exchange(other.end_, nullptr) }
+        , end_of_storage_{ std::exchange(other.end_of_storage_, nullptr) }
+        , storage_{ std::exchange(other.storage_, storage_t{}) }
     {
-        other.begin_ = nullptr;
-        other.end_   = nullptr;
     }
 
     constexpr auto operator=(dynamic_array&& other) noexcept -> dynamic_array&
     {
         if (this != &other)
         {
-            if (begin_) allocator().deallocate(begin_, size());
-            begin_       = other.begin_;
-            end_         = other.end_;
-            other.begin_ = nullptr;
-            other.end_   = nullptr;
+            release();
+            allocator()     = std::move(other.allocator());
+            begin_          = std::exchange(other.begin_, nullptr);
+            end_            = std::exchange(other.end_, nullptr);
+            end_of_storage_ = std::exchange(other.end_of_storage_, nullptr);
+            storage_        = std::exchange(other.storage_, storage_t{});
         }
         return *this;
     }
@@ -173,40 +239,100 @@ public:
 
     ~dynamic_array() noexcept
     {
-        if (begin_) allocator().deallocate(begin_, size());
+        release();
+    }
+
+    constexpr auto swap(dynamic_array& other) noexcept -> void
+    {
+        using std::swap;
+        swap(allocator(), other.allocator());
+        swap(begin_, other.begin_);
+        swap(end_, other.end_);
+        swap(end_of_storage_, other.end_of_storage_);
+        swap(storage_, other.storage_);
     }
 
-    constexpr auto leaky_resize(size_type n) & noexcept -> void
+    friend constexpr auto swap(dynamic_array& a, dynamic_array& b) noexcept -> void
     {
-        if (size() > n)
+        a.swap(b);
+    }
+
+    // Sets the size to n keeping the first min(size(), n) elements, new
+    // elements are left unset
+    constexpr auto resize(size_type n) & noexcept -> void
+    {
+        if (n > capacity())
         {
-            end_ = begin_ + n;
+            reallocate(growth_policy_t::grow(capacity(), n), size());
         }
-        else
+        set_size(n);
+    }
+
+    // Sets the size to n for callers that overwrite every element, nothing is
+    // copied when the storage grows
+    constexpr auto resize_for_overwrite(size_type n) & noexcept -> void
+    {
+        if (n > capacity())
         {
-            resize(n);
+            reallocate(growth_policy_t::grow(capacity(), n), 0uz);
         }
+        set_size(n);
     }
 
-    constexpr auto resize(size_type n) & noexcept -> void
+    constexpr auto reserve(size_type n) & noexcept -> void
     {
-        if (size() == n)
+        if (n > capacity())
         {
-            return;
+            reallocate(n, size());
         }
-        if (begin_ != nullptr) [[unlikely]]
+    }
+
+    constexpr auto shrink_to_fit() & noexcept -> void
+    {
+        if (capacity() != padded_size(size()))
         {
-            allocator().deallocate(begin_, size());
-            begin_ = nullptr;
+            reallocate(size(), size());
         }
-        begin_ = allocator().allocate(n);
-        end_   = begin_ + n;
+    }
+
+    constexpr auto clear() & noexcept -> void
+    {
+        end_ = begin_;
     }
 
     [[nodiscard]]
     constexpr auto data(this auto&& self) noexcept -> decltype(auto)
     {
-        return std::forward<decltype(self)>(self).begin_;
+        return std::assume_aligned<Alignment>(std::forward<decltype(self)>(self).begin_);
+    }
+
+    // Views of the elements [start, end) and of n elements from first, stride
+    // apart, see data_view.hpp. Read only on const arrays
+    [[nodiscard]]
+    constexpr auto slice(this auto&& self, size_type start, size_type end) noexcept
+    {
+        assert(start <= end && end <= self.size());
+        using element_t = std::conditional_t<
+            std::is_const_v<std::remove_reference_t<decltype(self)>>,
+            value_type const,
+            value_type>;
+        return strided_view<element_t, 1>(self.begin_ + start, end - start);
+    }
+
+    [[nodiscard]]
+    constexpr auto strided(
+        this auto&& self,
+        size_type   first,
+        size_type   n,
+        size_type   stride
+    ) noexcept
+    {
+        assert(n == 0 || first + (n - 1) * stride < self.size());
+        using element_t = std::conditional_t<
+            std::is_const_v<std::remove_reference_t<decltype(self)>>,
+            value_type const,
+            value_type>;
+        return strided_view<element_t>(self.begin_ + first, n, stride);
     }
 
     [[nodiscard]]
@@ -223,6 +349,18 @@ public:
         return static_cast<size_type>(std::distance(begin_, end_));
     }
 
+    [[nodiscard]]
+    constexpr auto capacity() const noexcept -> size_type
+    {
+        return static_cast<size_type>(std::distance(begin_, end_of_storage_));
+    }
+
+    [[nodiscard]]
+    constexpr auto empty() const noexcept -> bool
+    {
+        return begin_ == end_;
+    }
+
     [[nodiscard]]
     constexpr auto cbegin() const noexcept -> const_iterator
     {
@@ -276,20 +414,27 @@ public:
     }
 
     constexpr auto in_place_operator_impl_(
-        this auto& a,
-        auto&&     b,
-        auto&&     binary_op
+        this auto&                                 a,
+        auto&&                                     b,
+        auto&&                                     binary_op,
+        utility::parallel::execution_policy const& policy =
+            utility::parallel::default_execution_policy()
     ) noexcept -> void
     {
-        assert(a.size() == dt_utils::common_size(a, std::forward<decltype(b)>(b)));
-        for (auto idx = 0uz; idx != a.size(); ++idx)
-        {
-            a[idx] = std::invoke(
-                std::forward<decltype(binary_op)>(binary_op),
-                std::move(a[idx]),
-                operation_utils::subscript(b, idx)
-            );
-        }
+        operation_utils::check_extent(
+            operation_utils::common_extent({ a.size(), operation_utils::extent(b) }),
+            a.size()
+        );
+        const auto n = a.size();
+        const auto m = a.template padded_end<decltype(b)>(n);
+        utility::parallel::for_each_chunk<value_type>(
+            policy, n, [&](size_type first, size_type last) {
+                operation_utils::update_range(
+                    a.data(), b, binary_op, first, last == n ? m : last, policy
+                );
+            }
+        );
+        operation_utils::mark_evaluated(b);
     }
 
     [[nodiscard]]
@@ -302,14 +447,139 @@ private:
         assert(idx < utility::casts::safe_cast<decltype(idx)>(size()));
     }
 
+    [[nodiscard]]
+    static constexpr auto padded_size(size_type n) noexcept -> size_type
+    {
+        return (n + s_padding - 1) / s_padding * s_padding;
+    }
+
+    // End of the loops over n elements evaluating src into this array: n
+    // rounded up to a whole packet when both are padded for it, so that the
+    // loops need no scalar remainder
+    template <typename Src>
+    [[nodiscard]]
+    static constexpr auto padded_end(size_type n) noexcept -> size_type
+    {
+        if constexpr (std::floating_point<value_type> &&
+                      operation_utils::padded_for_v<dynamic_array, value_type> &&
+                      operation_utils::padded_for_v<Src, value_type>)
+        {
+            constexpr auto W = operation_utils::stdx::native_simd<value_type>::size();
+            return (n + W - 1) / W * W;
+        }
+        else
+        {
+            return n;
+        }
+    }
+
+    // Moves the first keep elements to new storage of capacity n, rounded up
+    // to the padding. Without elements to keep the old storage is released
+    // first, which lets stack allocators reuse it
+    constexpr auto reallocate(size_type n, size_type keep) noexcept -> void
+    {
+        assert(keep <= std::min(n, size()));
+        n = padded_size(n);
+        if (keep == 0)
+        {
+            release();
+            allocate_storage(n);
+        }
+        else
+        {
+            const auto old_begin    = begin_;
+            const auto old_capacity = capacity();
+            const auto old_storage  = storage_;
+            allocate_storage(n);
+            std::copy(old_begin, old_begin + keep, begin_);
+            deallocate_storage(old_begin, old_capacity, old_storage);
+        }
+        set_size(keep);
+    }
+
+    // Sets the size to n and zeroes the elements from there to the padding,
+    // which the whole packets of padded_end loops read but which may never have
+    // been written
+    constexpr auto set_size(size_type n) noexcept -> void
+    {
+        end_ = begin_ + n;
+        if constexpr (std::floating_point<value_type> && s_padding > 1)
+        {
+            std::fill(end_, begin_ + padded_size(n), value_type{});
+        }
+    }
+
+    // Sets begin_ and end_of_storage_ to new storage of capacity n, aligned
+    constexpr auto allocate_storage(size_type n) noexcept -> void
+    {
+        const auto raw = allocator().allocate(n + s_alignment_slack);
+        if constexpr (s_over_aligned)
+        {
+            storage_ = raw;
+            if consteval
+            {
+                begin_ = raw;
+            }
+            else
+            {
+                void*      p       = raw;
+                auto       space   = (n + s_alignment_slack) * sizeof(T);
+                const auto aligned = std::align(Alignment, n * sizeof(T), p, space);
+                begin_             = static_cast<pointer>(aligned);
+            }
+        }
+        else
+        {
+            begin_ = raw;
+        }
+        end_of_storage_ = begin_ + n;
+    }
+
+    constexpr auto deallocate_storage(
+        pointer                    begin,
+        size_type                  capacity,
+        [[maybe_unused]] storage_t storage
+    ) noexcept -> void
+    {
+        if (begin)
+        {
+            if constexpr (s_over_aligned)
+            {
+                allocator().deallocate(storage, capacity + s_alignment_slack);
+            }
+            else
+            {
+                allocator().deallocate(begin, capacity);
+            }
+        }
+    }
+
+    constexpr auto release() noexcept -> void
+    {
+        deallocate_storage(begin_, capacity(), storage_);
+        begin_          = nullptr;
+        end_            = nullptr;
+        end_of_storage_ = nullptr;
+        storage_        = storage_t{};
+    }
+
 private:
-    pointer begin_;
-    pointer end_;
+    pointer                         begin_;
+    pointer                         end_;
+    pointer                         end_of_storage_;
+    [[no_unique_address]] storage_t storage_;
 };
 
-template <typename T, typename Allocator>
-auto operator<<(std::ostream& os, dynamic_array<T, Allocator> const& v) noexcept
-    -> std::ostream&
+// dynamic_array whose storage is aligned and padded to Alignment bytes
+template <typename T, std::size_t Alignment = 64, typename Allocator = std::allocator<T>>
+using aligned_dynamic_array =
+    dynamic_array<T, Allocator, growth_policy::exact, Alignment>;
+
+template <typename T, typename Allocator, typename Growth_Policy, std::size_t Alignment>
+auto operator<<(
+    std::ostream&                                             os,
+    dynamic_array<T, Allocator, Growth_Policy, Alignment> const& v
+) noexcept -> std::ostream&
 {
     os << "{ ";
     const auto size = std::ranges::size(v);
@@ -0,0 +1,424 @@
+#pragma once
+
+#include "buffer_interface.hpp"
+#include "data_type_concepts.hpp"
+#include "dynamic_array.hpp"
+#include "execution_policy.hpp"
+#include "lazy_container_operations.hpp"
+#include <algorithm>
+#include <concepts>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+namespace data_types::lazily_evaluated_containers
+{
+
+// 2D buffer whose extents, capacities and layout are all set at run time
+// through a buffers::buffer_interface::dynamic_shape. Resizing within the
+// capacities keeps the storage and every element in place, beyond them the
+// storage is reallocated and the elements kept.
+//
+// As the other buffers, flat indices run along the lines of storage (rows in
+// row major layouts, columns in column major ones) and expressions are
+// evaluated line by line, skipping the padding.
+template <typename T, typename Allocator = std::allocator<T>>
+class dynamic_buffer : dt_concepts::data_buffer_base
+{
+public:
+    using value_type      = T;
+    using size_type       = std::size_t;
+    using index_t         = std::size_t;
+    using shape_t         = buffers::buffer_interface::dynamic_shape;
+    using layout_policy_t = shape_t::layout_policy_t;
+    using container_t     = dynamic_array<T, Allocator>;
+    using allocator_t     = Allocator;
+
+    static constexpr size_type s_size_y = std::dynamic_extent;
+    static constexpr size_type s_size_x = std::dynamic_extent;
+    // See dt_concepts::LineStrided, whether lines are padded is only known at
+    // run time
+    static constexpr bool s_line_strided = true;
+
+public:
+    constexpr dynamic_buffer() noexcept = default;
+
+    explicit constexpr dynamic_buffer(
+        shape_t const&     shape,
+        allocator_t const& alloc = allocator_t()
+    ) noexcept
+        : shape_{ shape }
+        , data_(shape.underlying_flat_size(), alloc)
+    {
+    }
+
+    constexpr dynamic_buffer(
+        size_type          size_y,
+        size_type          size_x,
+        layout_policy_t    layout_policy = layout_policy_t::layout_row_major,
+        allocator_t const& alloc         = allocator_t()
+    ) noexcept
+        : dynamic_buffer(shape_t(size_y, size_y, size_x, size_x, layout_policy, 0), alloc)
+    {
+    }
+
+    constexpr dynamic_buffer(dynamic_buffer const&) noexcept = default;
+
+    constexpr dynamic_buffer(dynamic_buffer&& other) noexcept
+        : shape_{ std::exchange(other.shape_, shape_t{}) }
+        , data_{ std::move(other.data_) }
+    {
+    }
+
+    // Reuses the storage when other fits in the capacities
+    constexpr auto operator=(dynamic_buffer const& other) noexcept -> dynamic_buffer&
+    {
+        if (this != &other)
+        {
+            resize_like(other);
+            const auto m = minor_extent();
+            for (auto j = 0uz; j != line_count(); ++j)
+            {
+                std::copy_n(other.line(j), m, line(j));
+            }
+        }
+        return *this;
+    }
+
+    constexpr auto operator=(dynamic_buffer&& other) noexcept -> dynamic_buffer&
+    {
+        if (this != &other)
+        {
+            shape_ = std::exchange(other.shape_, shape_t{});
+            data_  = std::move(other.data_);
+        }
+        return *this;
+    }
+
+    constexpr auto operator=(dt_concepts::ExpressionTemplate auto const& src) noexcept
+        -> dynamic_buffer&
+    {
+        return assign(src);
+    }
+
+    // Evaluates src into this buffer line by line, split over threads as set
+    // by the policy
+    constexpr auto assign(
+        dt_concepts::ExpressionTemplate auto const& src,
+        utility::parallel::execution_policy const&  policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> dynamic_buffer&
+    {
+        operation_utils::check_extent(src.size(), size());
+        operation_utils::check_line_extents(src, minor_extent());
+        utility::parallel::for_each_chunk<value_type>(
+            policy, size(), [this, &src, &policy](size_type first, size_type last) {
+                operation_utils::evaluate_line_range(
+                    [this](size_type j) { return line(j); },
+                    src,
+                    first,
+                    last,
+                    minor_extent(),
+                    line_slack<decltype(src)>(),
+                    policy
+                );
+            }
+        );
+        operation_utils::mark_evaluated(src);
+        return *this;
+    }
+
+    // Sets the extents, keeping the elements [0, min(size_y(), size_y)) x
+    // [0, min(size_x(), size_x)). Within the capacities nothing moves, new
+    // elements are left unset
+    constexpr auto resize(size_type size_y, size_type size_x) & noexcept -> void
+    {
+        if (size_y > capacity_y() || size_x > capacity_x())
+        {
+            reallocate(std::max(size_y, capacity_y()), std::max(size_x, capacity_x()));
+        }
+        shape_.resize(size_y, size_x);
+    }
+
+    constexpr auto reserve(size_type capacity_y, size_type capacity_x) & noexcept -> void
+    {
+        if (capacity_y > this->capacity_y() || capacity_x > this->capacity_x())
+        {
+            reallocate(
+                std::max(capacity_y, this->capacity_y()),
+                std::max(capacity_x, this->capacity_x())
+            );
+        }
+    }
+
+    // Gives this buffer the extents and layout of other, for buffers about to
+    // be overwritten: the storage is kept when the layouts match and other
+    // fits in the capacities, otherwise the shape of other is taken over
+    template <typename U, typename A>
+    constexpr auto resize_like(dynamic_buffer<U, A> const& other) & noexcept -> void
+    {
+        if (layout_policy() == other.layout_policy() &&
+            other.size_y() <= capacity_y() && other.size_x() <= capacity_x())
+        {
+            shape_.resize(other.size_y(), other.size_x());
+        }
+        else
+        {
+            shape_ = other.shape();
+            data_.resize_for_overwrite(shape_.underlying_flat_size());
+        }
+    }
+
+    [[nodiscard]]
+    constexpr auto shape() const noexcept -> shape_t const&
+    {
+        return shape_;
+    }
+
+    [[nodiscard]]
+    constexpr auto layout_policy() const noexcept -> layout_policy_t
+    {
+        return shape_.layout_policy();
+    }
+
+    [[nodiscard]]
+    constexpr auto capacity_y() const noexcept -> size_type
+    {
+        return shape_.capacity_y();
+    }
+
+    [[nodiscard]]
+    constexpr auto capacity_x() const noexcept -> size_type
+    {
+        return shape_.capacity_x();
+    }
+
+    [[nodiscard]]
+    constexpr auto size_y() const noexcept -> size_type
+    {
+        return shape_.size_y();
+    }
+
+    [[nodiscard]]
+    constexpr auto size_x() const noexcept -> size_type
+    {
+        return shape_.size_x();
+    }
+
+    [[nodiscard]]
+    constexpr auto flat_size() const noexcept -> size_type
+    {
+        return shape_.flat_size();
+    }
+
+    [[nodiscard]]
+    constexpr auto size() const noexcept -> size_type
+    {
+        return flat_size();
+    }
+
+    [[nodiscard]]
+    constexpr auto empty() const noexcept -> bool
+    {
+        return size() == 0;
+    }
+
+    [[nodiscard]]
+    constexpr auto underlying_size_x() const noexcept -> size_type
+    {
+        return shape_.underlying_size_x();
+    }
+
+    [[nodiscard]]
+    constexpr auto underlying_size_y() const noexcept -> size_type
+    {
+        return shape_.underlying_size_y();
+    }
+
+    [[nodiscard]]
+    constexpr auto underlying_flat_size() const noexcept -> size_type
+    {
+        return shape_.underlying_flat_size();
+    }
+
+    // Elements per line of storage: per row in row major layouts, per column
+    // in column major ones
+    [[nodiscard]]
+    constexpr auto minor_extent() const noexcept -> size_type
+    {
+        return layout_policy() == layout_policy_t::layout_row_major ? size_x() : size_y();
+    }
+
+    [[nodiscard]]
+    constexpr auto line_count() const noexcept -> size_type
+    {
+        return layout_policy() == layout_policy_t::layout_row_major ? size_y() : size_x();
+    }
+
+    // First element of line j of the storage
+    [[nodiscard]]
+    constexpr auto line(this auto&& self, index_t j) noexcept
+    {
+        assert(j < self.line_count());
+        return std::to_address(self.data()) + j * self.underlying_size_x();
+    }
+
+    [[nodiscard]]
+    constexpr auto flat_projection(index_t idx_y, index_t idx_x) const noexcept -> index_t
+    {
+        return shape_.flat_projection(idx_y, idx_x);
+    }
+
+    [[nodiscard]]
+    constexpr auto data(this auto&& self) noexcept -> decltype(auto)
+    {
+        return std::forward<decltype(self)>(self).data_.data();
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](this auto&& self, std::integral auto idx) noexcept
+        -> decltype(auto)
+    {
+        assert(0 <= idx && static_cast<size_type>(idx) < self.size());
+        const auto m = self.minor_extent();
+        if (self.underlying_size_x() != m)
+        {
+            const auto j = static_cast<index_t>(idx) / m;
+            const auto i = static_cast<index_t>(idx) % m;
+            return std::forward<decltype(self)>(self)
+                .data_[j * self.underlying_size_x() + i];
+        }
+        return std::forward<decltype(self)>(self).data_[idx];
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](
+        this auto&&        self,
+        std::integral auto idx_y,
+        std::integral auto idx_x
+    ) noexcept -> decltype(auto)
+    {
+        assert(0 <= idx_y && static_cast<size_type>(idx_y) < self.size_y());
+        assert(0 <= idx_x && static_cast<size_type>(idx_x) < self.size_x());
+        return std::forward<decltype(self)>(self).data_[self.flat_projection(
+            static_cast<index_t>(idx_y), static_cast<index_t>(idx_x)
+        )];
+    }
+
+    constexpr auto operator+=(this auto& self, auto&& other) noexcept -> dynamic_buffer&
+    {
+        self.in_place_operator_impl_(std::forward<decltype(other)>(other), std::plus{});
+        return self;
+    }
+
+    constexpr auto operator-=(this auto& self, auto&& other) noexcept -> dynamic_buffer&
+    {
+        self.in_place_operator_impl_(std::forward<decltype(other)>(other), std::minus{});
+        return self;
+    }
+
+    constexpr auto operator*=(this auto& self, auto&& other) noexcept -> dynamic_buffer&
+    {
+        self.in_place_operator_impl_(
+            std::forward<decltype(other)>(other), std::multiplies{}
+        );
+        return self;
+    }
+
+    constexpr auto operator/=(this auto& self, auto&& other) noexcept -> dynamic_buffer&
+    {
+        self.in_place_operator_impl_(
+            std::forward<decltype(other)>(other), std::divides{}
+        );
+        return self;
+    }
+
+    // Line by line, skipping the padding
+    constexpr auto in_place_operator_impl_(
+        this auto&                                 a,
+        auto&&                                     b,
+        auto&&                                     binary_op,
+        utility::parallel::execution_policy const& policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> void
+    {
+        operation_utils::check_extent(
+            operation_utils::common_extent({ a.size(), operation_utils::extent(b) }),
+            a.size()
+        );
+        operation_utils::check_line_extents(b, a.minor_extent());
+        utility::parallel::for_each_chunk<value_type>(
+            policy, a.size(), [&](size_type first, size_type last) {
+                operation_utils::update_line_range(
+                    [&](size_type j) { return a.line(j); },
+                    b,
+                    binary_op,
+                    first,
+                    last,
+                    a.minor_extent(),
+                    a.template line_slack<decltype(b)>(),
+                    policy
+                );
+            }
+        );
+        operation_utils::mark_evaluated(b);
+    }
+
+private:
+    // Padding past every line that both this buffer and src have
+    template <typename Src>
+    [[nodiscard]]
+    constexpr auto line_slack() const noexcept -> size_type
+    {
+        return std::min(
+            underlying_size_x() - minor_extent(), operation_utils::line_slack_v<Src>
+        );
+    }
+
+    // Moves the elements to storage of the given capacities. The line stride
+    // keeps at least its current padding
+    constexpr auto reallocate(size_type capacity_y, size_type capacity_x) noexcept -> void
+    {
+        const auto row_major      = layout_policy() == layout_policy_t::layout_row_major;
+        const auto minor_capacity = row_major ? capacity_x : capacity_y;
+        const auto stride =
+            underlying_size_x() > minor_capacity ? underlying_size_x() : size_type{ 0 };
+
+        dynamic_buffer tmp(
+            shape_t(size_y(), capacity_y, size_x(), capacity_x, layout_policy(), stride),
+            data_.allocator()
+        );
+        for (auto y = 0uz; y != size_y(); ++y)
+        {
+            for (auto x = 0uz; x != size_x(); ++x)
+            {
+                tmp[y, x] = std::as_const(*this)[y, x];
+            }
+        }
+        *this = std::move(tmp);
+    }
+
+private:
+    shape_t     shape_{};
+    container_t data_{};
+};
+
+template <typename T, typename Allocator>
+auto operator<<(std::ostream& os, dynamic_buffer<T, Allocator> const& v) noexcept
+    -> std::ostream&
+{
+    os << "{\n";
+    for (auto j = 0uz; j != v.size_y(); ++j)
+    {
+        for (auto i = 0uz; i != v.size_x(); ++i)
+        {
+            os << ' ' << v[j, i] << (i + 1 != v.size_x() ? ',' : ' ');
+        }
+        os << '\n';
+    }
+    os << '}';
+
+    return os;
+}
+
+} // namespace data_types::lazily_evaluated_containers
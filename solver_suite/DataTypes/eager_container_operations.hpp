@@ -2,6 +2,7 @@
 
 #include "data_type_concepts.hpp"
 #include "data_type_traits.hpp"
+#include "lazy_container_operations.hpp"
 #include "operation_utils.hpp"
 #include <functional>
 #include <type_traits>
@@ -10,10 +11,30 @@
 namespace data_types::eagerly_evaluated_containers
 {
 
-constexpr auto operator+(auto&& a, auto&& b) noexcept -> decltype(auto)
-    requires dt_concepts::StaticArray<std::remove_reference_t<decltype(a)>> ||
-             dt_concepts::StaticArray<std::remove_reference_t<decltype(b)>>
+// Operators between static arrays and scalars return a new static array. As
+// soon as one operand is an expression the lazy operators are used instead
+template <typename A, typename B>
+concept EagerOperands =
+    (dt_concepts::StaticArray<std::remove_reference_t<A>> ||
+     dt_concepts::StaticArray<std::remove_reference_t<B>>) &&
+    !dt_concepts::ExpressionTemplate<std::remove_cvref_t<A>> &&
+    !dt_concepts::ExpressionTemplate<std::remove_cvref_t<B>>;
+
+// Opt-in lazy evaluation of static array arithmetic: lazy(a) - b, and every
+// operator applied to the result, builds an expression of compile time size
+// instead of a temporary static array per operator. The whole chain is then
+// evaluated in one loop when assigned to or added to a static array, which is
+// also possible in constant expressions. Like containers, static arrays are
+// held by reference in expressions and have to outlive them.
+[[nodiscard]]
+constexpr auto lazy(auto const& a) noexcept -> decltype(auto)
+    requires dt_concepts::StaticArray<std::remove_cvref_t<decltype(a)>>
+{
+    return lazily_evaluated_containers::expr{ std::identity{}, a };
+}
 
+constexpr auto operator+(auto&& a, auto&& b) noexcept -> decltype(auto)
+    requires EagerOperands<decltype(a), decltype(b)>
 {
     return operator_impl(
         std::forward<decltype(a)>(a), std::forward<decltype(b)>(b), std::plus{}
@@ -21,8 +42,7 @@ constexpr auto operator+(auto&& a, auto&& b) noexcept -> decltype(auto)
 }
 
 constexpr auto operator-(auto&& a, auto&& b) noexcept -> decltype(auto)
-    requires dt_concepts::StaticArray<std::remove_reference_t<decltype(a)>> ||
-             dt_concepts::StaticArray<std::remove_reference_t<decltype(b)>>
+    requires EagerOperands<decltype(a), decltype(b)>
 {
     return operator_impl(
         std::forward<decltype(a)>(a), std::forward<decltype(b)>(b), std::minus{}
@@ -30,8 +50,7 @@ constexpr auto operator-(auto&& a, auto&& b) noexcept -> decltype(auto)
 }
 
 constexpr auto operator*(auto&& a, auto&& b) noexcept -> decltype(auto)
-    requires dt_concepts::StaticArray<std::remove_reference_t<decltype(a)>> ||
-             dt_concepts::StaticArray<std::remove_reference_t<decltype(b)>>
+    requires EagerOperands<decltype(a), decltype(b)>
 {
     return operator_impl(
         std::forward<decltype(a)>(a), std::forward<decltype(b)>(b), std::multiplies{}
@@ -39,8 +58,7 @@ constexpr auto operator*(auto&& a, auto&& b) noexcept -> decltype(auto)
 }
 
 constexpr auto operator/(auto&& a, auto&& b) noexcept -> decltype(auto)
-    requires dt_concepts::StaticArray<std::remove_reference_t<decltype(a)>> ||
-             dt_concepts::StaticArray<std::remove_reference_t<decltype(b)>>
+    requires EagerOperands<decltype(a), decltype(b)>
 {
     return operator_impl(
         std::forward<decltype(a)>(a), std::forward<decltype(b)>(b), std::divides{}
@@ -50,8 +68,7 @@ constexpr auto operator/(auto&& a, auto&& b) noexcept -> decltype(auto)
 [[nodiscard]]
 constexpr auto operator_impl(auto&& a, auto&& b, auto&& binary_op) noexcept
     -> decltype(auto)
-    requires dt_concepts::StaticArray<std::remove_reference_t<decltype(a)>> ||
-             dt_concepts::StaticArray<std::remove_reference_t<decltype(b)>>
+    requires EagerOperands<decltype(a), decltype(b)>
 {
     using a_t = std::remove_cvref_t<decltype(a)>;
     using b_t = std::remove_cvref_t<decltype(b)>;
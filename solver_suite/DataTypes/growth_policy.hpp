@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+
+namespace data_types::growth_policy
+{
+
+// grow(capacity, n) is the capacity to allocate when a container of the given
+// capacity has to hold n > capacity elements
+template <typename T>
+concept GrowthPolicy = requires(std::size_t capacity, std::size_t n) {
+    { T::grow(capacity, n) } -> std::same_as<std::size_t>;
+};
+
+// Exactly what is asked for, for containers sized once
+struct exact
+{
+    [[nodiscard]]
+    static constexpr auto grow([[maybe_unused]] std::size_t capacity, std::size_t n) noexcept
+        -> std::size_t
+    {
+        return n;
+    }
+};
+
+// At least Numerator / Denominator times the current capacity, so that a
+// container growing a few elements at a time reallocates a logarithmic number
+// of times
+template <std::size_t Numerator = 3, std::size_t Denominator = 2>
+    requires(Denominator > 0 && Numerator > Denominator)
+struct geometric
+{
+    [[nodiscard]]
+    static constexpr auto grow(std::size_t capacity, std::size_t n) noexcept
+        -> std::size_t
+    {
+        return std::max(n, capacity * Numerator / Denominator);
+    }
+};
+
+} // namespace data_types::growth_policy
@@ -1,13 +1,16 @@
 #pragma once
 
 #include "data_type_concepts.hpp"
+#include "data_type_traits.hpp"
 #include "data_type_utils.hpp"
+#include "execution_policy.hpp"
 #include "operation_utils.hpp"
 #include <concepts>
 #include <functional>
 #include <ranges>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 // Needs to be in the same namespace for name resolution of constructors,
 // unfortunately
@@ -27,16 +30,58 @@ public:
     using callable_t      = Callable;
     using size_type       = std::size_t;
     using storage_tuple_t = std::tuple<storage_t<Operands>...>;
+    using value_type      = std::remove_cvref_t<
+        std::invoke_result_t<callable_t const&, operation_utils::element_t<Operands>...>>;
+
+    // Whether packet<W>() is available, i.e. the expression is arithmetic all
+    // the way down
+    inline static constexpr bool s_packet_evaluable =
+        utility::concepts::arithmetic<value_type> &&
+        (operation_utils::PacketOperand<Operands> && ...);
+
+    // Element count when some operand has it at compile time, std::dynamic_extent
+    // otherwise
+    inline static constexpr size_type s_static_extent =
+        dt_traits::common_static_extent_v<Operands...>;
+
+    inline static constexpr bool s_contains_cached =
+        (operation_utils::contains_cached_v<Operands> || ...);
+
+    static_assert(
+        dt_traits::static_extents_agree_v<Operands...>,
+        "Operands have different sizes"
+    );
 
 public:
+    // The operand sizes are checked once here, not on every element access
     constexpr expr(callable_t f, Operands const&... args)
         : m_args(args...)
         , m_f{ f }
+        , m_size{
+            operation_utils::common_extent({ 0uz, operation_utils::extent(args)... })
+        }
+    {
+        if constexpr (s_static_extent != std::dynamic_extent)
+        {
+            operation_utils::check_extent(m_size, s_static_extent);
+        }
+    }
+
+    [[nodiscard]]
+    constexpr auto size() const noexcept -> size_type
     {
+        if constexpr (s_static_extent != std::dynamic_extent)
+        {
+            return s_static_extent;
+        }
+        else
+        {
+            return m_size;
+        }
     }
 
     [[nodiscard]]
-    inline constexpr auto operator[](std::integral auto idx) const
+    inline constexpr auto operator[](operation_utils::Position auto idx) const
     {
         return std::apply(
             [this, idx](auto&&... args) noexcept {
@@ -48,72 +93,236 @@ public:
         );
     }
 
+    // Elements [idx, idx + W) evaluated in one simd register, every operand is
+    // loaded as value_type
+    template <std::size_t W>
+        requires s_packet_evaluable
+    [[nodiscard]]
+    inline auto packet(operation_utils::Position auto idx) const noexcept
+        -> operation_utils::packet_t<value_type, W>
+    {
+        return std::apply(
+            [this, idx](auto const&... args) noexcept {
+                return operation_utils::packet_t<value_type, W>(
+                    m_f(operation_utils::load_packet<value_type, W>(args, idx)...)
+                );
+            },
+            m_args
+        );
+    }
+
+    [[nodiscard]]
+    constexpr auto operands() const noexcept -> storage_tuple_t const&
+    {
+        return m_args;
+    }
+
 private:
     storage_tuple_t m_args;
     callable_t      m_f;
+    size_type       m_size;
 };
 
+// Subexpression evaluated at most once into a storage container. The first
+// consumer pass writes it block by block right before reading each block, so
+// its operands are read from memory once and the consumer finds them in cache.
+// Later passes read the storage. Parent expressions hold the node by reference,
+// like containers, so it has to outlive them.
+template <typename Expr, typename Storage>
+    requires dt_concepts::ExpressionTemplate<Expr>
+class cached_expr
+    : dt_concepts::expression_templates_base
+    , dt_concepts::cached_expression_base
+{
+public:
+    using expression_t = Expr;
+    using storage_t    = Storage;
+    using size_type    = std::size_t;
+    using value_type   = operation_utils::element_t<Storage>;
+
+    inline static constexpr bool s_packet_evaluable =
+        operation_utils::PacketOperand<Storage> && Expr::s_packet_evaluable;
+
+    inline static constexpr size_type s_static_extent = Expr::s_static_extent;
+    inline static constexpr bool      s_contains_cached = true;
+
+public:
+    constexpr cached_expr(Expr const& e, Storage& storage) noexcept
+        : m_expr{ e }
+        , m_storage{ storage }
+    {
+        if constexpr (dt_concepts::Resizeable<Storage>)
+        {
+            m_storage.resize(m_expr.size());
+        }
+        operation_utils::check_extent(m_storage.size(), m_expr.size());
+    }
+
+    [[nodiscard]]
+    constexpr auto size() const noexcept -> size_type
+    {
+        return m_expr.size();
+    }
+
+    [[nodiscard]]
+    inline constexpr auto operator[](operation_utils::Position auto idx) const
+    {
+        return std::as_const(m_storage)[operation_utils::flat_index(idx)];
+    }
+
+    template <std::size_t W>
+        requires s_packet_evaluable
+    [[nodiscard]]
+    inline auto packet(operation_utils::Position auto idx) const noexcept
+        -> operation_utils::packet_t<value_type, W>
+    {
+        return operation_utils::load_packet<value_type, W>(
+            m_storage, operation_utils::flat_index(idx)
+        );
+    }
+
+    [[nodiscard]]
+    constexpr auto evaluated() const noexcept -> bool
+    {
+        return m_evaluated;
+    }
+
+    // Writes elements [first, last) of the expression to the storage, unless a
+    // full pass already did
+    constexpr auto materialize(size_type first, size_type last) const noexcept -> void
+    {
+        if (m_evaluated)
+        {
+            return;
+        }
+        if constexpr (std::ranges::contiguous_range<Storage&>)
+        {
+            operation_utils::evaluate_range(
+                std::ranges::data(m_storage), m_expr, first, last
+            );
+        }
+        else
+        {
+            operation_utils::for_each_fused_block<value_type>(
+                m_expr, first, last, [this](size_type b, size_type e) {
+                    for (auto i = b; i != e; ++i)
+                    {
+                        m_storage[i] = m_expr[i];
+                    }
+                }
+            );
+        }
+    }
+
+    constexpr auto mark_evaluated() const noexcept -> void
+    {
+        operation_utils::mark_evaluated(m_expr);
+        m_evaluated = true;
+    }
+
+private:
+    Expr         m_expr;
+    Storage&     m_storage;
+    mutable bool m_evaluated{};
+};
+
+// Marks e to be evaluated once into storage, which is resized if needed, see
+// cached_expr. Eagerly evaluated values are simply assigned to storage.
 [[nodiscard]]
-auto operator+(auto&& lhs, auto&& rhs) noexcept -> decltype(auto)
+constexpr auto eval_once(auto const& e, auto& storage) noexcept -> decltype(auto)
 {
-    return expr{ [](auto&& l, auto&& r) noexcept {
-                    return std::invoke(
-                        std::plus{},
-                        std::forward<decltype(l)>(l),
-                        std::forward<decltype(r)>(r)
-                    );
-                },
+    using expr_t    = std::remove_cvref_t<decltype(e)>;
+    using storage_t = std::remove_reference_t<decltype(storage)>;
+    if constexpr (dt_concepts::ExpressionTemplate<expr_t>)
+    {
+        return cached_expr<expr_t, storage_t>{ e, storage };
+    }
+    else
+    {
+        storage = e;
+        return std::as_const(storage);
+    }
+}
+
+// The nodes use named function objects rather than lambdas: a lambda's type
+// names the operand types of its enclosing function, so the type names of
+// nested expressions would grow exponentially with their depth
+
+[[nodiscard]]
+constexpr auto operator+(auto&& lhs, auto&& rhs) noexcept -> decltype(auto)
+{
+    return expr{ std::plus{},
                  std::forward<decltype(lhs)>(lhs),
                  std::forward<decltype(rhs)>(rhs) };
 }
 
 [[nodiscard]]
-auto operator-(auto&& lhs, auto&& rhs) noexcept -> decltype(auto)
+constexpr auto operator-(auto&& lhs, auto&& rhs) noexcept -> decltype(auto)
 {
-    return expr{ [](auto&& l, auto&& r) noexcept {
-                    return std::invoke(
-                        std::minus{},
-                        std::forward<decltype(l)>(l),
-                        std::forward<decltype(r)>(r)
-                    );
-                },
+    return expr{ std::minus{},
                  std::forward<decltype(lhs)>(lhs),
                  std::forward<decltype(rhs)>(rhs) };
 }
 
 [[nodiscard]]
-auto operator*(auto&& lhs, auto&& rhs) noexcept -> decltype(auto)
+constexpr auto operator*(auto&& lhs, auto&& rhs) noexcept -> decltype(auto)
 {
-    return expr{ [](auto&& l, auto&& r) noexcept {
-                    return std::invoke(
-                        std::multiplies{},
-                        std::forward<decltype(l)>(l),
-                        std::forward<decltype(r)>(r)
-                    );
-                },
+    return expr{ std::multiplies{},
                  std::forward<decltype(lhs)>(lhs),
                  std::forward<decltype(rhs)>(rhs) };
 }
 
 [[nodiscard]]
-auto operator/(auto&& lhs, auto&& rhs) noexcept -> decltype(auto)
+constexpr auto operator/(auto&& lhs, auto&& rhs) noexcept -> decltype(auto)
 {
-    return expr{ [](auto&& l, auto&& r) noexcept {
-                    return std::invoke(
-                        std::divides{},
-                        std::forward<decltype(l)>(l),
-                        std::forward<decltype(r)>(r)
-                    );
-                },
+    return expr{ std::divides{},
                  std::forward<decltype(lhs)>(lhs),
                  std::forward<decltype(rhs)>(rhs) };
 }
 
 [[nodiscard]]
-auto abs(auto&& value) noexcept -> decltype(auto)
+constexpr auto abs(auto&& value) noexcept -> decltype(auto)
+{
+    return expr{ operation_utils::absolute_value{}, std::forward<decltype(value)>(value) };
+}
+
+// Reductions over the elements of a container or expression, evaluated in one
+// fused pass without materializing the expression, through simd packets where
+// possible and split over threads as set by the policy
+
+template <typename T>
+concept ReductionOperand = dt_concepts::LazyEvaluation<std::remove_cvref_t<T>> ||
+                           dt_concepts::StaticArray<std::remove_cvref_t<T>>;
+
+[[nodiscard]]
+auto sum(
+    ReductionOperand auto const&               e,
+    utility::parallel::execution_policy const& policy =
+        utility::parallel::default_execution_policy()
+) noexcept
+{
+    return operation_utils::reduce_elements<operation_utils::sum_reduction>(e, policy);
+}
+
+[[nodiscard]]
+auto dot(
+    ReductionOperand auto const&               a,
+    ReductionOperand auto const&               b,
+    utility::parallel::execution_policy const& policy =
+        utility::parallel::default_execution_policy()
+) noexcept
+{
+    return sum(a * b, policy);
+}
+
+[[nodiscard]]
+auto norm_inf(
+    ReductionOperand auto const&               e,
+    utility::parallel::execution_policy const& policy =
+        utility::parallel::default_execution_policy()
+) noexcept
 {
-    return expr{ [](auto&& v) noexcept { return v < 0 ? -v : v; },
-                 std::forward<decltype(value)>(value) };
+    return operation_utils::reduce_elements<operation_utils::max_abs_reduction>(e, policy);
 }
 
 } // namespace data_types::lazily_evaluated_containers
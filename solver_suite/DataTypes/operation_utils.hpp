@@ -1,16 +1,27 @@
 #pragma once
 
 #include "data_type_concepts.hpp"
+#include "execution_policy.hpp"
 #include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <concepts>
+#include <cstdint>
+#include <experimental/simd>
+#include <initializer_list>
+#include <limits>
 #include <ranges>
+#include <tuple>
 #include <type_traits>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 namespace data_types::operation_utils
 {
 
+namespace stdx = std::experimental;
+
 template <std::size_t N, std::size_t I = 0>
     requires(N > I)
 [[nodiscard]]
@@ -51,6 +62,985 @@ constexpr auto subscript(T&& v, std::integral auto const idx) noexcept
     }
 }
 
+// Element of a traversal line by line, see for_each_line: the line, the offset
+// within it and the flat index of the same element. Line strided containers
+// are read at line and offset, everything else at the flat index
+struct line_position
+{
+    std::size_t line;
+    std::size_t offset;
+    std::size_t flat;
+};
+
+template <typename T>
+concept Position = std::integral<T> || std::same_as<T, line_position>;
+
+[[nodiscard]]
+constexpr auto flat_index(Position auto idx) noexcept -> std::size_t
+{
+    if constexpr (std::same_as<decltype(idx), line_position>)
+    {
+        return idx.flat;
+    }
+    else
+    {
+        return static_cast<std::size_t>(idx);
+    }
+}
+
+template <typename T>
+[[nodiscard]]
+constexpr auto subscript(T&& v, line_position const pos) noexcept
+{
+    using U = std::remove_cvref_t<T>;
+    if constexpr (dt_concepts::LineStrided<U>)
+    {
+        return v.line(pos.line)[pos.offset];
+    }
+    else if constexpr (dt_concepts::ExpressionTemplate<U>)
+    {
+        return v[pos];
+    }
+    else
+    {
+        return subscript(std::forward<T>(v), pos.flat);
+    }
+}
+
+template <typename T>
+using element_t =
+    std::remove_cvref_t<decltype(subscript(std::declval<T const&>(), std::size_t{}))>;
+
+template <typename V, std::size_t W>
+using packet_t = stdx::fixed_size_simd<V, W>;
+
+template <typename T>
+concept SimdPacket = stdx::is_simd_v<std::remove_cvref_t<T>>;
+
+// Containers load_packet reads with a vector load. A concept so that the value
+// type is only asked of ranges
+template <typename T, typename V>
+concept ContiguousRangeOf = std::ranges::contiguous_range<T const&> &&
+                            std::same_as<std::ranges::range_value_t<T const&>, V>;
+
+// Operands that can be loaded W elements at a time: scalars, containers of
+// arithmetic elements and expressions over those
+template <typename T>
+concept PacketOperand =
+    dt_concepts::ScalarType<std::remove_cvref_t<T>> ||
+    (dt_concepts::ExpressionTemplate<std::remove_cvref_t<T>> &&
+     std::remove_cvref_t<T>::s_packet_evaluable) ||
+    (!dt_concepts::ExpressionTemplate<std::remove_cvref_t<T>> &&
+     dt_concepts::Indexable<T> && utility::concepts::arithmetic<element_t<T>>);
+
+// Elements [idx, idx + W) of v as V, scalars are broadcast. Contiguous
+// containers of V, and lines of line strided ones, are read with a vector
+// load, other containers lane by lane
+template <typename V, std::size_t W, PacketOperand T>
+[[nodiscard]]
+inline auto load_packet(T const& v, Position auto idx) noexcept -> packet_t<V, W>
+{
+    constexpr bool by_line = std::same_as<decltype(idx), line_position>;
+    if constexpr (dt_concepts::ScalarType<T>)
+    {
+        return packet_t<V, W>(static_cast<V>(v));
+    }
+    else if constexpr (dt_concepts::ExpressionTemplate<T>)
+    {
+        return stdx::static_simd_cast<packet_t<V, W>>(v.template packet<W>(idx));
+    }
+    else if constexpr (by_line && dt_concepts::LineStrided<T>)
+    {
+        const auto p = v.line(idx.line) + idx.offset;
+        if constexpr (std::same_as<std::remove_cvref_t<decltype(*p)>, V>)
+        {
+            return packet_t<V, W>(p, stdx::element_aligned);
+        }
+        else
+        {
+            return packet_t<V, W>([p](auto lane) { return static_cast<V>(p[lane]); });
+        }
+    }
+    else if constexpr (by_line)
+    {
+        return load_packet<V, W>(v, idx.flat);
+    }
+    else if constexpr (ContiguousRangeOf<T, V>)
+    {
+        return packet_t<V, W>(
+            std::ranges::data(v) + static_cast<std::size_t>(idx), stdx::element_aligned
+        );
+    }
+    else
+    {
+        return packet_t<V, W>([&v, idx](auto lane) {
+            return static_cast<V>(v[static_cast<std::size_t>(idx) + lane]);
+        });
+    }
+}
+
+// |v| on scalars and packets
+struct absolute_value
+{
+    [[nodiscard]]
+    constexpr auto operator()(auto const& v) const noexcept
+    {
+        if constexpr (SimdPacket<decltype(v)>)
+        {
+            return stdx::abs(v);
+        }
+        else
+        {
+            return v < 0 ? -v : v;
+        }
+    }
+};
+
+template <typename T>
+constexpr bool contains_cached_v = [] consteval {
+    using U = std::remove_cvref_t<T>;
+    if constexpr (dt_concepts::CachedExpression<U>)
+    {
+        return true;
+    }
+    else if constexpr (dt_concepts::ExpressionTemplate<U>)
+    {
+        return U::s_contains_cached;
+    }
+    else
+    {
+        return false;
+    }
+}();
+
+// Whether every container read by T owns storage of V up to its size rounded
+// up to a whole native packet, so that loops over it can run whole packets into
+// the padding. Cached subexpressions own unpadded storage
+template <typename T, typename V>
+constexpr bool padded_for_v = [] consteval {
+    using U = std::remove_cvref_t<T>;
+    if constexpr (!utility::concepts::arithmetic<V> || dt_concepts::CachedExpression<U>)
+    {
+        return false;
+    }
+    else if constexpr (dt_concepts::ScalarType<U>)
+    {
+        return true;
+    }
+    else if constexpr (dt_concepts::ExpressionTemplate<U>)
+    {
+        return U::s_packet_evaluable &&
+               []<typename... Ts>(std::type_identity<std::tuple<Ts...>>) {
+                   return (padded_for_v<Ts, V> && ...);
+               }(std::type_identity<typename U::storage_tuple_t>{});
+    }
+    else if constexpr (requires { U::s_padding; })
+    {
+        return std::same_as<typename U::value_type, V> &&
+               U::s_padding % stdx::native_simd<V>::size() == 0;
+    }
+    else
+    {
+        return false;
+    }
+}();
+
+// Whether src reads some line strided container other than through a cached
+// subexpression
+template <typename T>
+constexpr bool contains_line_strided_v = [] consteval {
+    using U = std::remove_cvref_t<T>;
+    if constexpr (dt_concepts::LineStrided<U>)
+    {
+        return true;
+    }
+    else if constexpr (dt_concepts::ExpressionTemplate<U> &&
+                       !dt_concepts::CachedExpression<U>)
+    {
+        return []<typename... Ts>(std::type_identity<std::tuple<Ts...>>) {
+            return (contains_line_strided_v<Ts> || ...);
+        }(std::type_identity<typename U::storage_tuple_t>{});
+    }
+    else
+    {
+        return false;
+    }
+}();
+
+// Elements past the end of every line that loops over T may read, the least
+// line padding over its line strided operands: none when it reads other
+// containers, or line strided ones with padding only known at run time
+template <typename T>
+constexpr std::size_t line_slack_v = [] consteval {
+    using U = std::remove_cvref_t<T>;
+    if constexpr (dt_concepts::ScalarType<U>)
+    {
+        return std::numeric_limits<std::size_t>::max();
+    }
+    else if constexpr (dt_concepts::LineStrided<U> && requires { U::s_line_slack; })
+    {
+        return U::s_line_slack;
+    }
+    else if constexpr (dt_concepts::ExpressionTemplate<U> &&
+                       !dt_concepts::CachedExpression<U>)
+    {
+        return []<typename... Ts>(std::type_identity<std::tuple<Ts...>>) {
+            return std::min(
+                { std::numeric_limits<std::size_t>::max(), line_slack_v<Ts>... }
+            );
+        }(std::type_identity<typename U::storage_tuple_t>{});
+    }
+    else
+    {
+        return 0uz;
+    }
+}();
+
+// Calls fn(node) on the outermost cached subexpressions of src
+constexpr auto for_each_cached(auto const& src, auto&& fn) noexcept -> void
+{
+    using T = std::remove_cvref_t<decltype(src)>;
+    if constexpr (dt_concepts::CachedExpression<T>)
+    {
+        fn(src);
+    }
+    else if constexpr (contains_cached_v<T>)
+    {
+        std::apply(
+            [&fn](auto const&... args) noexcept { (for_each_cached(args, fn), ...); },
+            src.operands()
+        );
+    }
+}
+
+// To be called once a full pass over src is done, later passes read the
+// cached subexpressions from their storage
+constexpr auto mark_evaluated(auto const& src) noexcept -> void
+{
+    for_each_cached(src, [](auto const& node) noexcept { node.mark_evaluated(); });
+}
+
+// Bytes of each operand read per block when the cached subexpressions of an
+// expression are evaluated along with it, unless set by the execution policy
+inline constexpr auto s_fused_block_bytes = utility::parallel::seq.block_bytes;
+
+inline constexpr auto s_cache_line_bytes = 64uz;
+
+// Calls fn(data) on the operands of src stored contiguously in memory, cached
+// subexpressions excluded
+constexpr auto for_each_contiguous_operand(auto const& src, auto&& fn) noexcept -> void
+{
+    using T = std::remove_cvref_t<decltype(src)>;
+    if constexpr (dt_concepts::ExpressionTemplate<T> && !dt_concepts::CachedExpression<T>)
+    {
+        std::apply(
+            [&fn](auto const&... args) noexcept {
+                (for_each_contiguous_operand(args, fn), ...);
+            },
+            src.operands()
+        );
+    }
+    else if constexpr (std::ranges::contiguous_range<T const&>)
+    {
+        fn(std::ranges::data(src));
+    }
+}
+
+// Software prefetch to L2 of the elements [first, last) of the contiguous
+// operands of src
+inline auto prefetch_operands(auto const& src, std::size_t first, std::size_t last) noexcept
+    -> void
+{
+    for_each_contiguous_operand(src, [first, last](auto const* data) noexcept {
+        constexpr auto step = std::max(s_cache_line_bytes / sizeof(*data), 1uz);
+        for (auto i = first; i < last; i += step)
+        {
+            __builtin_prefetch(data + i, 0, 2);
+        }
+    });
+}
+
+// Calls fn(begin, end) over blocks of [first, last), writing the cached
+// subexpressions of src on each block right before, so that fn reads their
+// operands from cache rather than from memory. The block size and the
+// prefetch distance are taken from the policy
+template <typename V>
+constexpr auto for_each_fused_block(
+    auto const&                                src,
+    std::size_t                                first,
+    std::size_t                                last,
+    auto&&                                     fn,
+    utility::parallel::execution_policy const& policy = utility::parallel::seq
+) noexcept -> void
+{
+    const auto block = std::max(policy.block_bytes / sizeof(V), 1uz);
+    const auto ahead = policy.prefetch_blocks * block;
+    for (auto begin = first; begin < last; begin += block)
+    {
+        const auto end = std::min(begin + block, last);
+        if !consteval
+        {
+            if (ahead != 0 && begin + ahead < last)
+            {
+                prefetch_operands(src, begin + ahead, std::min(end + ahead, last));
+            }
+        }
+        for_each_cached(src, [begin, end](auto const& node) noexcept {
+            node.materialize(begin, end);
+        });
+        fn(begin, end);
+    }
+}
+
+// Whether a loop over src runs block by block, see for_each_fused_block
+[[nodiscard]]
+constexpr auto blocked(
+    auto const&                                src,
+    utility::parallel::execution_policy const& policy
+) noexcept -> bool
+{
+    return contains_cached_v<decltype(src)> || policy.prefetch_blocks != 0 ||
+           policy.streaming_stores;
+}
+
+// Non-temporal store of a packet to dst, which is aligned to the packet size
+template <typename V, std::size_t W>
+inline auto stream_packet(packet_t<V, W> const& p, V* dst) noexcept -> void
+{
+    constexpr auto bytes = sizeof(V) * W;
+    alignas(bytes) V lanes[W];
+    p.copy_to(lanes, stdx::element_aligned);
+#if defined(__AVX512F__)
+    if constexpr (bytes == 64)
+    {
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(dst), _mm512_load_si512(lanes));
+        return;
+    }
+#endif
+#if defined(__AVX__)
+    if constexpr (bytes == 32)
+    {
+        _mm256_stream_si256(
+            reinterpret_cast<__m256i*>(dst),
+            _mm256_load_si256(reinterpret_cast<__m256i const*>(lanes))
+        );
+        return;
+    }
+#endif
+#if defined(__SSE2__)
+    if constexpr (bytes == 16)
+    {
+        _mm_stream_si128(
+            reinterpret_cast<__m128i*>(dst),
+            _mm_load_si128(reinterpret_cast<__m128i const*>(lanes))
+        );
+        return;
+    }
+#endif
+    p.copy_to(dst, stdx::element_aligned);
+}
+
+// Orders the non-temporal stores of this thread before its later stores
+inline auto stream_fence() noexcept -> void
+{
+#if defined(__SSE2__)
+    _mm_sfence();
+#endif
+}
+
+template <typename V>
+constexpr auto evaluate_block(
+    V*          dst,
+    auto const& src,
+    std::size_t first,
+    std::size_t last
+) noexcept -> void
+{
+    if constexpr (utility::concepts::arithmetic<V> && PacketOperand<decltype(src)>)
+    {
+        if !consteval
+        {
+            constexpr auto W    = stdx::native_simd<V>::size();
+            const auto     tail = last - (last - first) % W;
+            for (; first != tail; first += W)
+            {
+                load_packet<V, W>(src, first).copy_to(dst + first, stdx::element_aligned);
+            }
+        }
+    }
+    for (; first < last; ++first)
+    {
+        dst[first] = subscript(src, first);
+    }
+}
+
+template <typename V>
+constexpr auto update_block(
+    V*          dst,
+    auto const& src,
+    auto&&      binary_op,
+    std::size_t first,
+    std::size_t last
+) noexcept -> void
+{
+    if constexpr (utility::concepts::arithmetic<V> && PacketOperand<decltype(src)>)
+    {
+        if !consteval
+        {
+            constexpr auto W    = stdx::native_simd<V>::size();
+            const auto     tail = last - (last - first) % W;
+            for (; first != tail; first += W)
+            {
+                const packet_t<V, W> a(dst + first, stdx::element_aligned);
+                packet_t<V, W>(binary_op(a, load_packet<V, W>(src, first)))
+                    .copy_to(dst + first, stdx::element_aligned);
+            }
+        }
+    }
+    for (; first < last; ++first)
+    {
+        dst[first] = binary_op(dst[first], subscript(src, first));
+    }
+}
+
+// evaluate_block with non-temporal stores of the packets, the elements before
+// the first packet aligned one and the tail are stored normally
+template <typename V>
+inline auto stream_block(
+    V*          dst,
+    auto const& src,
+    std::size_t first,
+    std::size_t last
+) noexcept -> void
+{
+    if constexpr (utility::concepts::arithmetic<V> && PacketOperand<decltype(src)>)
+    {
+        constexpr auto W     = stdx::native_simd<V>::size();
+        constexpr auto bytes = sizeof(V) * W;
+        for (; first < last && reinterpret_cast<std::uintptr_t>(dst + first) % bytes != 0;
+             ++first)
+        {
+            dst[first] = subscript(src, first);
+        }
+        const auto tail = last - (last - first) % W;
+        for (; first != tail; first += W)
+        {
+            stream_packet<V, W>(load_packet<V, W>(src, first), dst + first);
+        }
+    }
+    evaluate_block(dst, src, first, last);
+}
+
+// dst[i] = src[i] over [first, last), through native width packets when src
+// supports them and a scalar tail. Blocked as set by the policy, see
+// for_each_fused_block
+template <typename V>
+constexpr auto evaluate_range(
+    V*                                         dst,
+    auto const&                                src,
+    std::size_t                                first,
+    std::size_t                                last,
+    utility::parallel::execution_policy const& policy = utility::parallel::seq
+) noexcept -> void
+{
+    if (!blocked(src, policy))
+    {
+        evaluate_block(dst, src, first, last);
+        return;
+    }
+    for_each_fused_block<V>(
+        src,
+        first,
+        last,
+        [&](std::size_t b, std::size_t e) {
+            if !consteval
+            {
+                if (policy.streaming_stores)
+                {
+                    stream_block(dst, src, b, e);
+                    return;
+                }
+            }
+            evaluate_block(dst, src, b, e);
+        },
+        policy
+    );
+    if !consteval
+    {
+        if (policy.streaming_stores)
+        {
+            stream_fence();
+        }
+    }
+}
+
+// dst[i] = binary_op(dst[i], src[i]) over [first, last), as evaluate_range.
+// dst is read, so it is always stored normally
+template <typename V>
+constexpr auto update_range(
+    V*                                         dst,
+    auto const&                                src,
+    auto&&                                     binary_op,
+    std::size_t                                first,
+    std::size_t                                last,
+    utility::parallel::execution_policy const& policy = utility::parallel::seq
+) noexcept -> void
+{
+    if (!blocked(src, policy))
+    {
+        update_block(dst, src, binary_op, first, last);
+        return;
+    }
+    for_each_fused_block<V>(
+        src,
+        first,
+        last,
+        [&](std::size_t b, std::size_t e) { update_block(dst, src, binary_op, b, e); },
+        policy
+    );
+}
+
+// Number of elements of a container or expression, 0 for scalars
+template <typename T>
+[[nodiscard]]
+constexpr auto extent(T const& v) noexcept -> std::size_t
+{
+    if constexpr (dt_concepts::SizedInstance<T const&>)
+    {
+        return static_cast<std::size_t>(v.size());
+    }
+    else
+    {
+        return 0uz;
+    }
+}
+
+// Extent shared by the operands of an expression given their extents, 0 being a
+// scalar. The size checks on expressions go through these two non template
+// functions: an assert in a function templated on the operands would embed the
+// name of the whole expression type, which grows exponentially with its depth.
+[[nodiscard]]
+constexpr auto common_extent(std::initializer_list<std::size_t> extents) noexcept
+    -> std::size_t
+{
+    const auto ret = std::max(extents);
+    assert(std::ranges::all_of(extents, [ret](std::size_t e) {
+        return e == 0uz || e == ret;
+    }));
+    return ret;
+}
+
+constexpr auto check_extent(
+    [[maybe_unused]] std::size_t actual,
+    [[maybe_unused]] std::size_t expected
+) noexcept -> void
+{
+    assert(actual == expected);
+}
+
+// Calls fn(line, begin, end) over the runs [begin, end) of the lines of m
+// elements covering the flat range [first, last), with a single division
+constexpr auto for_each_line(
+    std::size_t first,
+    std::size_t last,
+    std::size_t m,
+    auto&&      fn
+) noexcept -> void
+{
+    if (first >= last)
+    {
+        return;
+    }
+    auto line   = first / m;
+    auto offset = first % m;
+    while (first < last)
+    {
+        const auto end = std::min(m, offset + (last - first));
+        fn(line, offset, end);
+        first  += end - offset;
+        offset  = 0;
+        ++line;
+    }
+}
+
+// Checks that the line strided operands of src have lines of m elements
+constexpr auto check_line_extents(auto const& src, std::size_t m) noexcept -> void
+{
+    using T = std::remove_cvref_t<decltype(src)>;
+    if constexpr (dt_concepts::LineStrided<T>)
+    {
+        check_extent(static_cast<std::size_t>(src.minor_extent()), m);
+    }
+    else if constexpr (contains_line_strided_v<T>)
+    {
+        std::apply(
+            [m](auto const&... args) noexcept { (check_line_extents(args, m), ...); },
+            src.operands()
+        );
+    }
+}
+
+// End of the packet loop over [b, e) of a line of m elements: e rounded up to
+// a whole packet when the line ends there and its padding, slack elements
+// that every operand has too, holds the rest of the packet
+template <typename V, std::size_t W>
+[[nodiscard]]
+constexpr auto line_packets_end(
+    std::size_t b,
+    std::size_t e,
+    std::size_t m,
+    std::size_t slack
+) noexcept -> std::size_t
+{
+    const auto full = b + (e - b + W - 1) / W * W;
+    if (std::floating_point<V> && e == m && full - m <= slack)
+    {
+        return full;
+    }
+    return e - (e - b) % W;
+}
+
+// evaluate_block over a destination stored as lines of m elements, line j
+// starting at line_of(j). Every line runs whole packets from its start, into
+// the slack padding elements past its end when they hold the last packet, and
+// a scalar tail otherwise. Line strided operands are read at line and offset
+constexpr auto evaluate_lines(
+    auto&&      line_of,
+    auto const& src,
+    std::size_t first,
+    std::size_t last,
+    std::size_t m,
+    std::size_t slack = 0
+) noexcept -> void
+{
+    using V = std::remove_pointer_t<decltype(line_of(0uz))>;
+    for_each_line(first, last, m, [&](std::size_t line, std::size_t b, std::size_t e) {
+        const auto dst  = line_of(line);
+        const auto base = line * m;
+        if constexpr (utility::concepts::arithmetic<V> && PacketOperand<decltype(src)>)
+        {
+            if !consteval
+            {
+                constexpr auto W    = stdx::native_simd<V>::size();
+                const auto     tail = line_packets_end<V, W>(b, e, m, slack);
+                for (; b != tail; b += W)
+                {
+                    load_packet<V, W>(src, line_position{ line, b, base + b })
+                        .copy_to(dst + b, stdx::element_aligned);
+                }
+            }
+        }
+        for (; b < e; ++b)
+        {
+            dst[b] = subscript(src, line_position{ line, b, base + b });
+        }
+    });
+}
+
+// update_block over a destination stored as lines, as evaluate_lines
+constexpr auto update_lines(
+    auto&&      line_of,
+    auto const& src,
+    auto&&      binary_op,
+    std::size_t first,
+    std::size_t last,
+    std::size_t m,
+    std::size_t slack = 0
+) noexcept -> void
+{
+    using V = std::remove_pointer_t<decltype(line_of(0uz))>;
+    for_each_line(first, last, m, [&](std::size_t line, std::size_t b, std::size_t e) {
+        const auto dst  = line_of(line);
+        const auto base = line * m;
+        if constexpr (utility::concepts::arithmetic<V> && PacketOperand<decltype(src)>)
+        {
+            if !consteval
+            {
+                constexpr auto W    = stdx::native_simd<V>::size();
+                const auto     tail = line_packets_end<V, W>(b, e, m, slack);
+                for (; b != tail; b += W)
+                {
+                    const line_position  pos{ line, b, base + b };
+                    const packet_t<V, W> a(dst + b, stdx::element_aligned);
+                    packet_t<V, W>(binary_op(a, load_packet<V, W>(src, pos)))
+                        .copy_to(dst + b, stdx::element_aligned);
+                }
+            }
+        }
+        for (; b < e; ++b)
+        {
+            dst[b] =
+                binary_op(dst[b], subscript(src, line_position{ line, b, base + b }));
+        }
+    });
+}
+
+// evaluate_range over a destination stored as lines, blocked as set by the
+// policy. Streaming stores are left to contiguous destinations
+constexpr auto evaluate_line_range(
+    auto&&                                     line_of,
+    auto const&                                src,
+    std::size_t                                first,
+    std::size_t                                last,
+    std::size_t                                m,
+    std::size_t                                slack  = 0,
+    utility::parallel::execution_policy const& policy = utility::parallel::seq
+) noexcept -> void
+{
+    using V = std::remove_pointer_t<decltype(line_of(0uz))>;
+    if (!blocked(src, policy))
+    {
+        evaluate_lines(line_of, src, first, last, m, slack);
+        return;
+    }
+    for_each_fused_block<V>(
+        src,
+        first,
+        last,
+        [&](std::size_t b, std::size_t e) {
+            evaluate_lines(line_of, src, b, e, m, slack);
+        },
+        policy
+    );
+}
+
+// update_range over a destination stored as lines, as evaluate_line_range
+constexpr auto update_line_range(
+    auto&&                                     line_of,
+    auto const&                                src,
+    auto&&                                     binary_op,
+    std::size_t                                first,
+    std::size_t                                last,
+    std::size_t                                m,
+    std::size_t                                slack  = 0,
+    utility::parallel::execution_policy const& policy = utility::parallel::seq
+) noexcept -> void
+{
+    using V = std::remove_pointer_t<decltype(line_of(0uz))>;
+    if (!blocked(src, policy))
+    {
+        update_lines(line_of, src, binary_op, first, last, m, slack);
+        return;
+    }
+    for_each_fused_block<V>(
+        src,
+        first,
+        last,
+        [&](std::size_t b, std::size_t e) {
+            update_lines(line_of, src, binary_op, b, e, m, slack);
+        },
+        policy
+    );
+}
+
+// Reductions for reduce_range, usable on scalars and packets: accumulate folds
+// an element into a partial result and combine merges two partial results
+struct sum_reduction
+{
+    template <typename V>
+    [[nodiscard]]
+    static constexpr auto identity() noexcept -> V
+    {
+        return V{};
+    }
+
+    [[nodiscard]]
+    static constexpr auto accumulate(auto const& acc, auto const& x) noexcept
+    {
+        return acc + x;
+    }
+
+    [[nodiscard]]
+    static constexpr auto combine(auto const& a, auto const& b) noexcept
+    {
+        return a + b;
+    }
+
+    template <typename V, typename Abi>
+    [[nodiscard]]
+    static auto horizontal(stdx::simd<V, Abi> const& p) noexcept -> V
+    {
+        return stdx::reduce(p);
+    }
+};
+
+struct sum_squares_reduction : sum_reduction
+{
+    [[nodiscard]]
+    static constexpr auto accumulate(auto const& acc, auto const& x) noexcept
+    {
+        return acc + x * x;
+    }
+};
+
+struct max_abs_reduction
+{
+    template <typename V>
+    [[nodiscard]]
+    static constexpr auto identity() noexcept -> V
+    {
+        return V{};
+    }
+
+    [[nodiscard]]
+    static constexpr auto accumulate(auto const& acc, auto const& x) noexcept
+    {
+        if constexpr (SimdPacket<decltype(x)>)
+        {
+            return stdx::max(acc, stdx::abs(x));
+        }
+        else
+        {
+            return std::max(acc, x < decltype(x){} ? -x : x);
+        }
+    }
+
+    [[nodiscard]]
+    static constexpr auto combine(auto const& a, auto const& b) noexcept
+    {
+        return std::max(a, b);
+    }
+
+    template <typename V, typename Abi>
+    [[nodiscard]]
+    static auto horizontal(stdx::simd<V, Abi> const& p) noexcept -> V
+    {
+        return stdx::hmax(p);
+    }
+};
+
+template <typename Reduction, typename V>
+[[nodiscard]]
+constexpr auto reduce_block(auto const& src, std::size_t first, std::size_t last) noexcept
+    -> V
+{
+    V ret = Reduction::template identity<V>();
+    if constexpr (utility::concepts::arithmetic<V> && PacketOperand<decltype(src)>)
+    {
+        if !consteval
+        {
+            constexpr auto W    = stdx::native_simd<V>::size();
+            const auto     tail = last - (last - first) % W;
+            if (first != tail)
+            {
+                packet_t<V, W> acc(ret);
+                for (; first != tail; first += W)
+                {
+                    acc = Reduction::accumulate(acc, load_packet<V, W>(src, first));
+                }
+                ret = Reduction::horizontal(acc);
+            }
+        }
+    }
+    for (; first < last; ++first)
+    {
+        ret = Reduction::accumulate(ret, static_cast<V>(subscript(src, first)));
+    }
+    return ret;
+}
+
+// Reduction of src[i] over [first, last), through native width packets when
+// src supports them and a scalar tail
+template <typename Reduction, typename V>
+[[nodiscard]]
+constexpr auto reduce_range(
+    auto const&                                src,
+    std::size_t                                first,
+    std::size_t                                last,
+    utility::parallel::execution_policy const& policy = utility::parallel::seq
+) noexcept -> V
+{
+    if (!blocked(src, policy))
+    {
+        return reduce_block<Reduction, V>(src, first, last);
+    }
+    V ret = Reduction::template identity<V>();
+    for_each_fused_block<V>(
+        src,
+        first,
+        last,
+        [&](std::size_t b, std::size_t e) {
+            ret = Reduction::combine(ret, reduce_block<Reduction, V>(src, b, e));
+        },
+        policy
+    );
+    return ret;
+}
+
+// Last block of the blocked buffers an expression reads when it has rows past
+// the end of the buffer, which flat indices still run over: the rows in use,
+// and the rows and lines of a block. All 0 when every block is full
+struct last_block_t
+{
+    std::size_t rows;
+    std::size_t width;
+    std::size_t lines;
+};
+
+template <typename T>
+[[nodiscard]]
+constexpr auto last_block(T const& v) noexcept -> last_block_t
+{
+    if constexpr (dt_concepts::ExpressionTemplate<T> && !dt_concepts::CachedExpression<T>)
+    {
+        return std::apply(
+            [](auto const&... args) noexcept {
+                last_block_t ret{};
+                ((ret = ret.rows != 0 ? ret : last_block(args)), ...);
+                return ret;
+            },
+            v.operands()
+        );
+    }
+    else if constexpr (requires { v.size_y(); v.size_x(); v.minor_extent(); })
+    {
+        const auto w    = static_cast<std::size_t>(v.minor_extent());
+        const auto rows = static_cast<std::size_t>(v.size_y()) % w;
+        if (rows != 0 && static_cast<std::size_t>(v.size()) != v.size_y() * v.size_x())
+        {
+            return { rows, w, static_cast<std::size_t>(v.size_x()) };
+        }
+    }
+    return {};
+}
+
+// Reduction of every element of a container or expression in one pass, split
+// over threads as set by the policy. The unused rows of the last block of
+// blocked buffers are left out, line by line after the full blocks
+template <typename Reduction, typename T>
+[[nodiscard]]
+inline auto reduce_elements(
+    T const&                                   src,
+    utility::parallel::execution_policy const& policy
+) noexcept -> element_t<T>
+{
+    using value_type   = element_t<T>;
+    const auto combine = [](value_type const& a, value_type const& b) {
+        return static_cast<value_type>(Reduction::combine(a, b));
+    };
+    const auto block = last_block(src);
+    const auto full  = extent(src) - block.lines * block.width;
+    auto       ret   = utility::parallel::reduce_chunks<value_type>(
+        policy,
+        full,
+        Reduction::template identity<value_type>(),
+        [&src, &policy](std::size_t first, std::size_t last) {
+            return reduce_range<Reduction, value_type>(src, first, last, policy);
+        },
+        combine
+    );
+    for (auto j = 0uz; j != block.lines; ++j)
+    {
+        const auto first = full + j * block.width;
+        ret              = combine(
+            ret,
+            reduce_range<Reduction, value_type>(src, first, first + block.rows, policy)
+        );
+    }
+    mark_evaluated(src);
+    return ret;
+}
+
 template <std::ranges::range T>
 [[gnu::pure, nodiscard]]
 constexpr auto distance(T const& p1, T const& p2) noexcept -> T
@@ -63,13 +1053,7 @@ constexpr auto l2_norm_sq(std::ranges::range auto const& v) noexcept ->
     typename std::remove_cvref_t<decltype(v)>::value_type
 {
     using value_type = typename std::remove_cvref_t<decltype(v)>::value_type;
-    const auto n     = v.size();
-    value_type ret{};
-    for (auto i = decltype(n){}; i != n; ++i)
-    {
-        ret += v[i] * v[i];
-    }
-    return ret;
+    return reduce_range<sum_squares_reduction, value_type>(v, 0uz, extent(v));
 }
 
 [[gnu::pure, nodiscard]]
@@ -79,12 +1063,7 @@ constexpr auto l2_norm_sq(std::ranges::range auto const& v) noexcept ->
 {
     using value_type = typename std::remove_cvref_t<decltype(v)>::value_type;
     constexpr auto n = std::remove_reference_t<decltype(v)>::size();
-    value_type     ret{};
-    for (auto i = decltype(n){}; i != n; ++i)
-    {
-        ret += v[i] * v[i];
-    }
-    return ret;
+    return reduce_range<sum_squares_reduction, value_type>(v, 0uz, n);
 }
 
 [[gnu::pure, nodiscard]]
@@ -98,9 +1077,17 @@ constexpr auto l2_norm(std::ranges::range auto const& v) noexcept ->
 constexpr auto linfinity_norm(std::ranges::range auto const& v) noexcept ->
     typename std::remove_cvref_t<decltype(v)>::value_type
 {
-    return std::ranges::max(v | std::views::transform([](auto const& e) {
-                                return std::abs(e);
-                            }));
+    using value_type = typename std::remove_cvref_t<decltype(v)>::value_type;
+    if constexpr (dt_concepts::Indexable<decltype(v)>)
+    {
+        return reduce_range<max_abs_reduction, value_type>(v, 0uz, extent(v));
+    }
+    else
+    {
+        return std::ranges::max(v | std::views::transform([](auto const& e) {
+                                    return std::abs(e);
+                                }));
+    }
 }
 
 [[gnu::pure, nodiscard]]
@@ -0,0 +1,454 @@
+#pragma once
+
+#include "casts.hpp"
+#include "data_type_concepts.hpp"
+#include "execution_policy.hpp"
+#include "growth_policy.hpp"
+#include "lazy_container_operations.hpp"
+#include <algorithm>
+#include <concepts>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+namespace data_types::lazily_evaluated_containers
+{
+
+// dynamic_array that keeps up to Inline_N elements in the object itself and
+// only goes through the allocator beyond that, for small systems whose states
+// would otherwise cost an allocation each. Once spilled, the storage grows as
+// set by the growth policy and returns inline on shrink_to_fit. Moves of
+// inline arrays copy the elements.
+template <
+    typename                    T,
+    std::size_t                 Inline_N,
+    typename                    Allocator     = std::allocator<T>,
+    growth_policy::GrowthPolicy Growth_Policy = growth_policy::exact>
+    requires(Inline_N > 0)
+class small_dynamic_array : private Allocator, dt_concepts::dynamic_array_base
+{
+public:
+    using value_type      = T;
+    using size_type       = std::size_t;
+    using allocator_t     = Allocator;
+    using growth_policy_t = Growth_Policy;
+
+    using const_pointer  = value_type const*;
+    using pointer        = value_type*;
+    using const_iterator = const_pointer;
+    using iterator       = pointer;
+
+    inline static constexpr auto s_inline_size = Inline_N;
+
+public:
+    [[nodiscard]]
+    constexpr auto allocator() const -> allocator_t const&
+    {
+        return *static_cast<allocator_t const*>(this);
+    }
+
+    [[nodiscard]]
+    constexpr auto allocator() -> allocator_t&
+    {
+        return *static_cast<allocator_t*>(this);
+    }
+
+public:
+    constexpr small_dynamic_array() noexcept
+        : small_dynamic_array(allocator_t())
+    {
+    }
+
+    explicit constexpr small_dynamic_array(allocator_t const& alloc) noexcept
+        : allocator_t{ alloc }
+        , begin_{ inline_ }
+        , end_{ inline_ }
+        , end_of_storage_{ inline_ + s_inline_size }
+    {
+    }
+
+    explicit constexpr small_dynamic_array(
+        size_type          size,
+        allocator_t const& alloc = allocator_t()
+    ) noexcept
+        : small_dynamic_array(alloc)
+    {
+        resize_for_overwrite(size);
+    }
+
+    constexpr small_dynamic_array(
+        size_type          size,
+        value_type const&  value,
+        allocator_t const& alloc = allocator_t()
+    ) noexcept
+        : small_dynamic_array(size, alloc)
+    {
+        std::fill(begin_, end_, value);
+    }
+
+    constexpr small_dynamic_array(
+        std::initializer_list<T> init,
+        const allocator_t        alloc = allocator_t()
+    ) noexcept
+        : small_dynamic_array(init.size(), alloc)
+    {
+        std::ranges::copy(init, begin_);
+    }
+
+    constexpr small_dynamic_array(dt_concepts::ExpressionTemplate auto const& src) noexcept
+        : small_dynamic_array()
+    {
+        assign(src);
+    }
+
+    constexpr small_dynamic_array(small_dynamic_array const& other) noexcept
+        : small_dynamic_array(
+              other.size(),
+              std::allocator_traits<allocator_t>::select_on_container_copy_construction(
+                  other.allocator()
+              )
+          )
+    {
+        std::ranges::copy(other, begin_);
+    }
+
+    constexpr small_dynamic_array(small_dynamic_array&& other) noexcept
+        : allocator_t(std::move(other.allocator()))
+        , begin_{ inline_ }
+        , end_{ inline_ }
+        , end_of_storage_{ inline_ + s_inline_size }
+    {
+        take(other);
+    }
+
+    constexpr auto operator=(dt_concepts::ExpressionTemplate auto const& src) noexcept
+        -> small_dynamic_array&
+    {
+        return assign(src);
+    }
+
+    // Reuses the storage when other fits in the capacity. The allocator of other
+    // is taken along with new storage when it propagates on copy assignment
+    constexpr auto operator=(small_dynamic_array const& other) noexcept
+        -> small_dynamic_array&
+    {
+        if (this != &other)
+        {
+            if constexpr (std::allocator_traits<allocator_t>::
+                              propagate_on_container_copy_assignment::value)
+            {
+                if (other.size() > capacity())
+                {
+                    release();
+                    begin_          = inline_;
+                    end_            = inline_;
+                    end_of_storage_ = inline_ + s_inline_size;
+                    allocator()     = other.allocator();
+                }
+            }
+            resize_for_overwrite(other.size());
+            std::ranges::copy(other, begin_);
+        }
+        return *this;
+    }
+
+    constexpr auto operator=(small_dynamic_array&& other) noexcept -> small_dynamic_array&
+    {
+        if (this != &other)
+        {
+            release();
+            allocator() = std::move(other.allocator());
+            take(other);
+        }
+        return *this;
+    }
+
+    ~small_dynamic_array() noexcept
+    {
+        release();
+    }
+
+    // Evaluates src into this array, split over threads as set by the policy,
+    // as dynamic_array::assign
+    constexpr auto assign(
+        dt_concepts::ExpressionTemplate auto const& src,
+        utility::parallel::execution_policy const&  policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> small_dynamic_array&
+    {
+        resize_for_overwrite(src.size());
+        utility::parallel::for_each_chunk<value_type>(
+            policy, size(), [this, &src, &policy](size_type first, size_type last) {
+                operation_utils::evaluate_range(begin_, src, first, last, policy);
+            }
+        );
+        operation_utils::mark_evaluated(src);
+        return *this;
+    }
+
+    constexpr auto swap(small_dynamic_array& other) noexcept -> void
+    {
+        small_dynamic_array tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend constexpr auto swap(small_dynamic_array& a, small_dynamic_array& b) noexcept
+        -> void
+    {
+        a.swap(b);
+    }
+
+    // Sets the size to n keeping the first min(size(), n) elements, new
+    // elements are left unset
+    constexpr auto resize(size_type n) & noexcept -> void
+    {
+        if (n > capacity())
+        {
+            reallocate(growth_policy_t::grow(capacity(), n), size());
+        }
+        end_ = begin_ + n;
+    }
+
+    // Sets the size to n for callers that overwrite every element, nothing is
+    // copied when the storage grows
+    constexpr auto resize_for_overwrite(size_type n) & noexcept -> void
+    {
+        if (n > capacity())
+        {
+            reallocate(growth_policy_t::grow(capacity(), n), 0uz);
+        }
+        end_ = begin_ + n;
+    }
+
+    constexpr auto reserve(size_type n) & noexcept -> void
+    {
+        if (n > capacity())
+        {
+            reallocate(n, size());
+        }
+    }
+
+    constexpr auto shrink_to_fit() & noexcept -> void
+    {
+        if (!is_inline() && capacity() != size())
+        {
+            reallocate(size(), size());
+        }
+    }
+
+    constexpr auto clear() & noexcept -> void
+    {
+        end_ = begin_;
+    }
+
+    // Whether the elements are stored in the object itself
+    [[nodiscard]]
+    constexpr auto is_inline() const noexcept -> bool
+    {
+        return begin_ == inline_;
+    }
+
+    [[nodiscard]]
+    constexpr auto data(this auto&& self) noexcept -> decltype(auto)
+    {
+        return std::forward<decltype(self)>(self).begin_;
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](this auto&& self, std::integral auto idx) noexcept
+        -> decltype(auto)
+    {
+        std::forward<decltype(self)>(self).assert_in_bounds(idx);
+        return std::forward<decltype(self)>(self).begin_[idx];
+    }
+
+    [[nodiscard]]
+    constexpr auto size() const noexcept -> size_type
+    {
+        return static_cast<size_type>(std::distance(begin_, end_));
+    }
+
+    [[nodiscard]]
+    constexpr auto capacity() const noexcept -> size_type
+    {
+        return static_cast<size_type>(std::distance(begin_, end_of_storage_));
+    }
+
+    [[nodiscard]]
+    constexpr auto empty() const noexcept -> bool
+    {
+        return begin_ == end_;
+    }
+
+    [[nodiscard]]
+    constexpr auto cbegin() const noexcept -> const_iterator
+    {
+        return begin_;
+    }
+
+    [[nodiscard]]
+    constexpr auto cend() const noexcept -> const_iterator
+    {
+        return end_;
+    }
+
+    [[nodiscard]]
+    constexpr auto begin(this auto&& self) noexcept -> decltype(auto)
+    {
+        return std::forward<decltype(self)>(self).begin_;
+    }
+
+    [[nodiscard]]
+    constexpr auto end(this auto&& self) noexcept -> decltype(auto)
+    {
+        return std::forward<decltype(self)>(self).end_;
+    }
+
+    constexpr auto operator+=(this auto& self, auto&& other) noexcept
+        -> small_dynamic_array&
+    {
+        self.in_place_operator_impl_(std::forward<decltype(other)>(other), std::plus{});
+        return self;
+    }
+
+    constexpr auto operator-=(this auto& self, auto&& other) noexcept
+        -> small_dynamic_array&
+    {
+        self.in_place_operator_impl_(std::forward<decltype(other)>(other), std::minus{});
+        return self;
+    }
+
+    constexpr auto operator*=(this auto& self, auto&& other) noexcept
+        -> small_dynamic_array&
+    {
+        self.in_place_operator_impl_(
+            std::forward<decltype(other)>(other), std::multiplies{}
+        );
+        return self;
+    }
+
+    constexpr auto operator/=(this auto& self, auto&& other) noexcept
+        -> small_dynamic_array&
+    {
+        self.in_place_operator_impl_(
+            std::forward<decltype(other)>(other), std::divides{}
+        );
+        return self;
+    }
+
+    constexpr auto in_place_operator_impl_(
+        this auto&                                 a,
+        auto&&                                     b,
+        auto&&                                     binary_op,
+        utility::parallel::execution_policy const& policy =
+            utility::parallel::default_execution_policy()
+    ) noexcept -> void
+    {
+        operation_utils::check_extent(
+            operation_utils::common_extent({ a.size(), operation_utils::extent(b) }),
+            a.size()
+        );
+        utility::parallel::for_each_chunk<value_type>(
+            policy, a.size(), [&](size_type first, size_type last) {
+                operation_utils::update_range(
+                    a.data(), b, binary_op, first, last, policy
+                );
+            }
+        );
+        operation_utils::mark_evaluated(b);
+    }
+
+    [[nodiscard]]
+    constexpr auto operator==(small_dynamic_array const& other) const noexcept -> bool
+    {
+        return std::ranges::equal(*this, other);
+    }
+
+private:
+    inline constexpr auto assert_in_bounds([[maybe_unused]] std::integral auto const idx
+    ) const noexcept -> void
+    {
+        assert(idx < utility::casts::safe_cast<decltype(idx)>(size()));
+    }
+
+    // Takes the elements of other, stealing its storage unless it is inline.
+    // other is left empty and inline
+    constexpr auto take(small_dynamic_array& other) noexcept -> void
+    {
+        if (other.is_inline())
+        {
+            std::ranges::copy(other, inline_);
+            begin_          = inline_;
+            end_            = inline_ + other.size();
+            end_of_storage_ = inline_ + s_inline_size;
+        }
+        else
+        {
+            begin_          = other.begin_;
+            end_            = other.end_;
+            end_of_storage_ = other.end_of_storage_;
+        }
+        other.begin_          = other.inline_;
+        other.end_            = other.inline_;
+        other.end_of_storage_ = other.inline_ + s_inline_size;
+    }
+
+    // Moves the first keep elements to storage of capacity n, inline when n
+    // fits
+    constexpr auto reallocate(size_type n, size_type keep) noexcept -> void
+    {
+        assert(keep <= std::min(n, size()));
+        const auto spill = n > s_inline_size;
+        const auto p     = spill ? allocator().allocate(n) : pointer{ inline_ };
+        if (p != begin_)
+        {
+            std::copy(begin_, begin_ + keep, p);
+            release();
+        }
+        begin_          = p;
+        end_            = p + keep;
+        end_of_storage_ = p + (spill ? n : s_inline_size);
+    }
+
+    constexpr auto release() noexcept -> void
+    {
+        if (!is_inline())
+        {
+            allocator().deallocate(begin_, capacity());
+        }
+    }
+
+private:
+    pointer    begin_;
+    pointer    end_;
+    pointer    end_of_storage_;
+    value_type inline_[s_inline_size];
+};
+
+template <typename T, std::size_t Inline_N, typename Allocator, typename Growth_Policy>
+auto operator<<(
+    std::ostream&                                                   os,
+    small_dynamic_array<T, Inline_N, Allocator, Growth_Policy> const& v
+) noexcept -> std::ostream&
+{
+    os << "{ ";
+    const auto size = std::ranges::size(v);
+    for (std::size_t n{ 0 }; auto const& e : v)
+    {
+        if constexpr (std::ranges::range<T>)
+        {
+            os << e << (++n != size ? ",\n" : "\n");
+        }
+        else
+        {
+            os << e << (++n != size ? ", " : " ");
+        }
+    }
+    os << '}';
+
+    return os;
+}
+
+} // namespace data_types::lazily_evaluated_containers
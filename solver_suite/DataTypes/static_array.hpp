@@ -3,11 +3,16 @@
 #include "casts.hpp"
 #include "compile_time_utility.hpp"
 #include "data_type_concepts.hpp"
+#include "data_type_traits.hpp"
 #include "eager_container_operations.hpp"
+#include "execution_policy.hpp"
+#include "operation_utils.hpp"
 #include <array>
 #include <concepts>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <span>
 #include <type_traits>
 
 namespace data_types::eagerly_evaluated_containers
@@ -23,6 +28,10 @@ struct static_array
     using const_iterator                = typename container_t::const_iterator;
     using iterator                      = typename container_t::iterator;
 
+    // Arrays at least this large run their compound assignments under the
+    // default execution policy, smaller ones are always serial
+    inline static constexpr auto s_policy_min_bytes = 64uz * 1024;
+
     static constexpr auto filled(auto&&... args) noexcept -> static_array
         requires std::constructible_from<T, decltype(args)...>
     {
@@ -75,7 +84,8 @@ struct static_array
         assert(end <= s_size);
         if constexpr (std::is_same_v<Slice_Type, std::span<value_type>>)
         {
-            return Slice_Type{ self.begin_ + start, self.begin_ + end };
+            // Read only on const arrays
+            return std::span(std::to_address(self.begin()) + start, end - start);
         }
         else if constexpr (dt_concepts::StaticArray<Slice_Type>)
         {
@@ -85,7 +95,7 @@ struct static_array
         }
         else
         {
-            Slice_Type ret(s_size);
+            Slice_Type ret(end - start);
             std::copy(self.begin() + start, self.begin() + end, std::begin(ret));
             return ret;
         }
@@ -115,6 +125,23 @@ struct static_array
         return std::end(std::forward<decltype(self)>(self).data_);
     }
 
+    // Evaluates an expression, e.g. one built from lazy(), element wise in one
+    // loop
+    constexpr auto operator=(
+        this auto&                                 self,
+        dt_concepts::ExpressionTemplate auto const& e
+    ) noexcept -> static_array&
+    {
+        static_assert(
+            dt_traits::static_extents_agree_v<static_array, decltype(e)>,
+            "Operands have different sizes"
+        );
+        operation_utils::check_extent(operation_utils::extent(e), s_size);
+        operation_utils::evaluate_range(self.data_.data(), e, 0uz, s_size);
+        operation_utils::mark_evaluated(e);
+        return self;
+    }
+
     constexpr auto operator+=(this auto& self, auto&& other) noexcept -> static_array&
     {
         self.in_place_operator_impl_(std::forward<decltype(other)>(other), std::plus{});
@@ -157,10 +184,24 @@ struct static_array
             static_assert(dt_traits::is_same_size_v<a_t, b_t>);
         }
 
-        for (auto idx = 0uz; idx != s_size; ++idx)
+        if constexpr (sizeof(container_t) >= s_policy_min_bytes)
         {
-            a[idx] = binary_op(a[idx], operation_utils::subscript(b, idx));
+            if !consteval
+            {
+                auto const& policy = utility::parallel::default_execution_policy();
+                utility::parallel::for_each_chunk<value_type>(
+                    policy, s_size, [&](size_type first, size_type last) {
+                        operation_utils::update_range(
+                            a.data_.data(), b, binary_op, first, last, policy
+                        );
+                    }
+                );
+                operation_utils::mark_evaluated(b);
+                return;
+            }
         }
+        operation_utils::update_range(a.data_.data(), b, binary_op, 0uz, s_size);
+        operation_utils::mark_evaluated(b);
     }
 
     [[nodiscard]]
@@ -175,6 +216,17 @@ struct static_array
     alignas(alignof(value_type)) container_t data_;
 };
 
+// Static array holding the elements of an expression of compile time size
+[[nodiscard]]
+constexpr auto to_static_array(dt_concepts::ExpressionTemplate auto const& e) noexcept
+    requires(dt_traits::static_extent_v<decltype(e)> != std::dynamic_extent)
+{
+    using expr_t = std::remove_cvref_t<decltype(e)>;
+    static_array<typename expr_t::value_type, expr_t::s_static_extent> ret{};
+    ret = e;
+    return ret;
+}
+
 template <typename T, std::size_t N>
 auto operator<<(std::ostream& os, static_array<T, N> const& v) noexcept -> std::ostream&
 {
@@ -176,9 +176,11 @@ public:
         switch (layout_policy_)
         {
         case layout_policy_t::layout_column_major:
-            assert(capacity_y_ <= minor_stride);
+            assert(minor_stride == 0 || capacity_y_ <= minor_stride);
+            break;
+        case layout_policy_t::layout_row_major:
+            assert(minor_stride == 0 || s_size_x <= minor_stride);
             break;
-        case layout_policy_t::layout_row_major: assert(s_size_x <= minor_stride); break;
         default: utility::error_handling::assert_unreachable(); break;
         }
     }
@@ -231,6 +233,12 @@ public:
         return underlying_size_y() * underlying_size_x();
     }
 
+    [[nodiscard]]
+    constexpr auto layout_policy() const noexcept -> layout_policy_t
+    {
+        return layout_policy_;
+    }
+
     [[nodiscard, gnu::const]]
     constexpr auto flat_projection(index_t idx_y, index_t idx_x) const noexcept -> index_t
     {
@@ -259,6 +267,12 @@ public:
     static constexpr size_type s_size_x = std::dynamic_extent;
 
 public:
+    // Empty row major shape
+    constexpr dynamic_shape() noexcept
+        : dynamic_shape(0, 0, 0, 0, layout_policy_t::layout_row_major, 0)
+    {
+    }
+
     constexpr dynamic_shape(
         size_type       size_y,
         size_type       capacity_y,
@@ -292,10 +306,10 @@ public:
         switch (layout_policy_)
         {
         case layout_policy_t::layout_column_major:
-            assert(capacity_y_ <= minor_stride);
+            assert(minor_stride == 0 || capacity_y_ <= minor_stride);
             break;
         case layout_policy_t::layout_row_major:
-            assert(capacity_x_ <= minor_stride);
+            assert(minor_stride == 0 || capacity_x_ <= minor_stride);
             break;
         default: utility::error_handling::assert_unreachable(); break;
         }
@@ -349,6 +363,22 @@ public:
         return underlying_size_x_ * underlying_size_y_;
     }
 
+    [[nodiscard]]
+    constexpr auto layout_policy() const noexcept -> layout_policy_t
+    {
+        return layout_policy_;
+    }
+
+    // Sets the sizes within the capacities, the underlying layout is unchanged
+    // so every element keeps its place
+    constexpr auto resize(size_type size_y, size_type size_x) noexcept -> void
+    {
+        assert(size_y <= capacity_y_);
+        assert(size_x <= capacity_x_);
+        size_y_ = size_y;
+        size_x_ = size_x;
+    }
+
     [[nodiscard, gnu::const]]
     constexpr auto flat_projection(index_t idx_y, index_t idx_x) const noexcept -> index_t
     {
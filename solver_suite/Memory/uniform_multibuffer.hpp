@@ -1,13 +1,394 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <concepts>
 #include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace buffers::multibuffer
 {
 
+inline constexpr std::size_t cache_line_bytes = 64;
+
+// Elements between the starts of consecutive slots of n elements: a whole,
+// odd number of cache lines. Slot k then starts k * stride lines into the
+// allocation, which for up to 64 slots is a different offset within a 4 KiB
+// page for every slot, so streams over the same element of every slot
+// neither alias in the store buffer (4K aliasing) nor compete for one L1 set
+template <typename T>
+[[nodiscard, gnu::const]]
+constexpr auto slot_stride(std::size_t n) noexcept -> std::size_t
+{
+    static_assert(cache_line_bytes % sizeof(T) == 0);
+    const auto lines = (n * sizeof(T) + cache_line_bytes - 1) / cache_line_bytes;
+    return (lines | 1uz) * (cache_line_bytes / sizeof(T));
+}
+
+// Allocator for containers over one slot of a multibuffer: it hands out the
+// slot when the request fits and falls back to the heap otherwise. Copies of
+// containers get an unbound allocator and copy assignments keep their own, so
+// that two containers never share the slot, and moves take the slot along with
+// the storage
+template <typename T>
+class slot_allocator : private std::allocator<T>
+{
+public:
+    using size_type       = std::size_t;
+    using value_type      = std::remove_cvref_t<T>;
+    using pointer         = value_type*;
+    using const_pointer   = value_type const*;
+    using reference       = value_type&;
+    using const_reference = value_type const&;
+    using difference_type = std::ptrdiff_t;
+
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = slot_allocator<U>;
+    };
+
+    constexpr slot_allocator() noexcept = default;
+
+    constexpr slot_allocator(pointer slot, size_type capacity) noexcept
+        : slot_{ slot }
+        , capacity_{ capacity }
+    {
+    }
+
+    constexpr slot_allocator(slot_allocator const&) noexcept = default;
+
+    constexpr slot_allocator(slot_allocator&& other) noexcept
+        : slot_{ std::exchange(other.slot_, nullptr) }
+        , capacity_{ std::exchange(other.capacity_, 0uz) }
+    {
+    }
+
+    constexpr auto operator=(slot_allocator const&) noexcept -> slot_allocator& = default;
+
+    constexpr auto operator=(slot_allocator&& other) noexcept -> slot_allocator&
+    {
+        if (this != &other)
+        {
+            slot_     = std::exchange(other.slot_, nullptr);
+            capacity_ = std::exchange(other.capacity_, 0uz);
+        }
+        return *this;
+    }
+
+    [[nodiscard]]
+    constexpr auto select_on_container_copy_construction() const noexcept
+        -> slot_allocator
+    {
+        return {};
+    }
+
+    [[nodiscard]]
+    constexpr auto bound() const noexcept -> bool
+    {
+        return slot_ != nullptr;
+    }
+
+    [[nodiscard]]
+    constexpr auto allocate(size_type n) noexcept -> pointer
+    {
+        if (n <= capacity_)
+        {
+            return slot_;
+        }
+        return std::allocator<T>::allocate(n);
+    }
+
+    constexpr auto deallocate(pointer p, size_type n) noexcept -> void
+    {
+        if (p != slot_)
+        {
+            std::allocator<T>::deallocate(p, n);
+        }
+    }
+
+    // Storage from one allocator can be freed by the other only when both are
+    // over the same slot, or over none
+    [[nodiscard]]
+    friend constexpr auto operator==(
+        slot_allocator const& lhs,
+        slot_allocator const& rhs
+    ) noexcept -> bool
+    {
+        return lhs.slot_ == rhs.slot_;
+    }
+
+private:
+    pointer   slot_{};
+    size_type capacity_{};
+};
+
+template <typename T>
+struct is_slot_allocator : std::false_type
+{
+};
+
+template <typename T>
+struct is_slot_allocator<slot_allocator<T>> : std::true_type
+{
+};
+
+// Containers whose storage can be bound to a slot
+template <typename T>
+concept SlotAllocated = is_slot_allocator<typename T::allocator_t>::value;
+
+// Elements a container of type T allocates to hold n elements, padding and
+// alignment slack included
+template <typename T>
+[[nodiscard]]
+constexpr auto allocation_size(std::size_t n) noexcept -> std::size_t
+{
+    if constexpr (requires { T::allocation_size(n); })
+    {
+        return T::allocation_size(n);
+    }
+    else
+    {
+        return n;
+    }
+}
+
+// Slot size over which containers of n elements of any of the types Ts stay
+// in their slot
+template <typename... Ts>
+[[nodiscard]]
+constexpr auto slot_size_for(std::size_t n) noexcept -> std::size_t
+{
+    return std::max({ multibuffer::allocation_size<Ts>(n)... });
+}
+
+// K buffers of N elements in one allocation aligned to a cache line, slot k
+// starting k * s_slot_stride elements in
 template <typename T, std::size_t K, std::size_t N>
+    requires(K > 0)
 class uniform_multibuffer
 {
+public:
+    using value_type = T;
+    using size_type  = std::size_t;
+    using index_t    = std::size_t;
+    using pointer    = value_type*;
+
+    static constexpr size_type s_slot_count  = K;
+    static constexpr size_type s_slot_size   = N;
+    static constexpr size_type s_slot_stride = multibuffer::slot_stride<value_type>(N);
+
+    [[nodiscard, gnu::const]]
+    static constexpr auto slot_count() noexcept -> size_type
+    {
+        return s_slot_count;
+    }
+
+    [[nodiscard, gnu::const]]
+    static constexpr auto slot_size() noexcept -> size_type
+    {
+        return s_slot_size;
+    }
+
+    [[nodiscard, gnu::const]]
+    static constexpr auto slot_stride() noexcept -> size_type
+    {
+        return s_slot_stride;
+    }
+
+    [[nodiscard]]
+    constexpr auto buffer(this auto&& self, index_t idx) noexcept
+    {
+        assert(idx < s_slot_count);
+        return std::forward<decltype(self)>(self).data_ + idx * s_slot_stride;
+    }
+
+    // Allocator handing out slot idx
+    [[nodiscard]]
+    constexpr auto slot(index_t idx) noexcept -> slot_allocator<value_type>
+    {
+        return { buffer(idx), s_slot_stride };
+    }
+
+private:
+    alignas(cache_line_bytes) value_type data_[s_slot_count * s_slot_stride];
+};
+
+// As uniform_multibuffer, with the slot size set at run time. The storage is
+// aligned whatever the allocator
+template <typename T, std::size_t K, typename Allocator = std::allocator<T>>
+    requires(K > 0)
+class dynamic_uniform_multibuffer : private Allocator
+{
+public:
+    using value_type  = T;
+    using size_type   = std::size_t;
+    using index_t     = std::size_t;
+    using pointer     = value_type*;
+    using allocator_t = Allocator;
+
+    static constexpr size_type s_slot_count = K;
+
+private:
+    // Extra elements allocated to align storage the allocator aligns to
+    // alignof(T) only
+    static constexpr size_type s_alignment_slack =
+        (cache_line_bytes - alignof(T) + sizeof(T) - 1) / sizeof(T);
+
+public:
+    [[nodiscard]]
+    constexpr auto allocator() -> allocator_t&
+    {
+        return *static_cast<allocator_t*>(this);
+    }
+
+public:
+    constexpr dynamic_uniform_multibuffer() noexcept = default;
+
+    explicit constexpr dynamic_uniform_multibuffer(
+        size_type          slot_size,
+        allocator_t const& alloc = allocator_t()
+    ) noexcept
+        : allocator_t{ alloc }
+    {
+        resize(slot_size);
+    }
+
+    dynamic_uniform_multibuffer(dynamic_uniform_multibuffer const&) = delete;
+    auto operator=(dynamic_uniform_multibuffer const&)
+        -> dynamic_uniform_multibuffer& = delete;
+
+    constexpr dynamic_uniform_multibuffer(dynamic_uniform_multibuffer&& other) noexcept
+        : allocator_t(std::move(other.allocator()))
+        , storage_{ std::exchange(other.storage_, nullptr) }
+        , data_{ std::exchange(other.data_, nullptr) }
+        , slot_size_{ std::exchange(other.slot_size_, 0uz) }
+        , slot_stride_{ std::exchange(other.slot_stride_, 0uz) }
+    {
+    }
+
+    constexpr auto operator=(dynamic_uniform_multibuffer&& other) noexcept
+        -> dynamic_uniform_multibuffer&
+    {
+        if (this != &other)
+        {
+            release();
+            allocator()  = std::move(other.allocator());
+            storage_     = std::exchange(other.storage_, nullptr);
+            data_        = std::exchange(other.data_, nullptr);
+            slot_size_   = std::exchange(other.slot_size_, 0uz);
+            slot_stride_ = std::exchange(other.slot_stride_, 0uz);
+        }
+        return *this;
+    }
+
+    ~dynamic_uniform_multibuffer() noexcept
+    {
+        release();
+    }
+
+    // Sets the slot size to n. The storage is kept while the slots fit, else
+    // it is replaced and the elements are lost
+    constexpr auto resize(size_type n) & noexcept -> void
+    {
+        if (n > slot_stride_ || data_ == nullptr)
+        {
+            release();
+            slot_stride_     = multibuffer::slot_stride<value_type>(n);
+            storage_         = allocator().allocate(allocation_size());
+            const auto bytes = s_slot_count * slot_stride_ * sizeof(value_type);
+            void*      p     = storage_;
+            auto       space = allocation_size() * sizeof(value_type);
+
+            data_ = static_cast<pointer>(std::align(cache_line_bytes, bytes, p, space));
+        }
+        slot_size_ = n;
+    }
+
+    [[nodiscard, gnu::const]]
+    static constexpr auto slot_count() noexcept -> size_type
+    {
+        return s_slot_count;
+    }
+
+    [[nodiscard]]
+    constexpr auto slot_size() const noexcept -> size_type
+    {
+        return slot_size_;
+    }
+
+    [[nodiscard]]
+    constexpr auto slot_stride() const noexcept -> size_type
+    {
+        return slot_stride_;
+    }
+
+    [[nodiscard]]
+    constexpr auto buffer(index_t idx) const noexcept -> pointer
+    {
+        assert(idx < s_slot_count);
+        assert(data_ != nullptr);
+        return std::assume_aligned<cache_line_bytes>(data_ + idx * slot_stride_);
+    }
+
+    // Allocator handing out slot idx, until the storage is replaced
+    [[nodiscard]]
+    constexpr auto slot(index_t idx) const noexcept -> slot_allocator<value_type>
+    {
+        return { buffer(idx), slot_stride_ };
+    }
+
+private:
+    [[nodiscard]]
+    constexpr auto allocation_size() const noexcept -> size_type
+    {
+        return s_slot_count * slot_stride_ + s_alignment_slack;
+    }
+
+    constexpr auto release() noexcept -> void
+    {
+        if (storage_ != nullptr)
+        {
+            allocator().deallocate(storage_, allocation_size());
+        }
+        storage_     = nullptr;
+        data_        = nullptr;
+        slot_stride_ = 0;
+    }
+
+private:
+    pointer   storage_{};
+    pointer   data_{};
+    size_type slot_size_{};
+    size_type slot_stride_{};
 };
 
+struct no_multibuffer
+{
+};
+
+// Storage for K internal buffers of the types Ts: a multibuffer when they all
+// hold elements of one type in slot allocated storage, nothing otherwise
+template <std::size_t K, typename... Ts>
+struct multibuffer_for
+{
+    using type = no_multibuffer;
+};
+
+template <std::size_t K, typename T, typename... Ts>
+    requires SlotAllocated<T> && (SlotAllocated<Ts> && ...) &&
+             (std::same_as<typename T::value_type, typename Ts::value_type> && ...)
+struct multibuffer_for<K, T, Ts...>
+{
+    using type = dynamic_uniform_multibuffer<typename T::value_type, K>;
+};
+
+template <std::size_t K, typename... Ts>
+using multibuffer_for_t = typename multibuffer_for<K, Ts...>::type;
+
 } // namespace buffers::multibuffer
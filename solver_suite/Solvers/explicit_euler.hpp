@@ -57,6 +57,12 @@ public:
         resize_internals(n);
     }
 
+    explicit constexpr explicit_euler(state_type const& x) noexcept
+        requires data_types::dt_concepts::ResizeableLike<deriv_type, state_type>
+    {
+        resize_internals_like(x);
+    }
+
     auto do_step_impl(
         auto&&      system,
         state_type& x_in_out,
@@ -80,6 +86,13 @@ public:
         m_dxdt.resize(n);
     }
 
+    // Shapes the internal buffers as x, for states whose shape a size does not set
+    auto resize_internals_like(state_type const& x) noexcept -> void
+        requires data_types::dt_concepts::ResizeableLike<deriv_type, state_type>
+    {
+        m_dxdt.resize_like(x);
+    }
+
 private:
     deriv_type m_dxdt;
 };
@@ -2,10 +2,13 @@
 
 #include "data_type_concepts.hpp"
 #include "explicit_stepper_base.hpp"
+#include "lazy_container_operations.hpp"
 #include "operation_utils.hpp"
 #include "runge_kutta_params.hpp"
+#include "uniform_multibuffer.hpp"
 #include <concepts>
 #include <cstdint>
+#include <iterator>
 
 namespace solvers::explicit_stepers
 {
@@ -71,6 +74,14 @@ private:
         static_cast<order_type>(Error_Stepper_Order);
     inline static constexpr auto s_error_order = static_cast<order_type>(Error_Order);
 
+    // States and derivatives with slot allocators keep the internal buffers in
+    // one multibuffer, m_x_tmp in slot 0, m_dxdt_tmp in slot 1 and m_dxdt[i]
+    // in slot i + 2
+    using storage_type =
+        buffers::multibuffer::multibuffer_for_t<Stage_Count + 2, state_type, deriv_type>;
+    inline static constexpr bool s_multibuffer_backed =
+        !std::same_as<storage_type, buffers::multibuffer::no_multibuffer>;
+
 public:
     constexpr explicit_embedded_runge_kutta(rk_params_type rk_params) noexcept
         : m_rk_params{ rk_params }
@@ -86,6 +97,17 @@ public:
         resize_internals(n);
     }
 
+    constexpr explicit_embedded_runge_kutta(
+        state_type const&     x,
+        rk_params_type const& rk_params
+    ) noexcept
+        requires data_types::dt_concepts::ResizeableLike<state_type, state_type> &&
+                 data_types::dt_concepts::ResizeableLike<deriv_type, state_type>
+        : m_rk_params{ rk_params }
+    {
+        resize_internals_like(x);
+    }
+
     [[nodiscard]]
     static constexpr auto stage_count() noexcept -> order_type
     {
@@ -112,12 +134,16 @@ public:
         while (true)
         {
             try_do_step_impl(std::forward<decltype(system)>(system), x_in_out, t, m_dt);
-            m_dxdt_err = error_expr();
-            m_dxdt_tmp = result_expr();
-            m_dxdt_err /=
+            // The error norm pass also writes the step result to m_dxdt_tmp,
+            // reading every stage buffer once
+            decltype(auto) result = data_types::lazily_evaluated_containers::eval_once(
+                result_expr(), m_dxdt_tmp
+            );
+            const auto val = data_types::lazily_evaluated_containers::norm_inf(
+                error_expr() /
                 (m_epsilon_abs +
-                 m_epsilon_rel * (m_a_x * abs(x_in_out) + m_a_dxdt * abs(m_dxdt_tmp)));
-            const auto val = data_types::operation_utils::linfinity_norm(m_dxdt_err);
+                 m_epsilon_rel * (m_a_x * abs(x_in_out) + m_a_dxdt * abs(result)))
+            );
             if (val > value_type(1))
             {
                 m_dt *= std::max(
@@ -141,8 +167,8 @@ public:
                 break;
             }
         }
-        x_in_out += m_dt * result_expr();
-        t += m_dt;
+        x_in_out += m_dt * m_dxdt_tmp;
+        t        += m_dt;
     }
 
     auto try_do_step_impl(
@@ -169,10 +195,10 @@ public:
     }
 
     [[nodiscard]]
-    constexpr auto result_expr() const noexcept -> auto const&
+    constexpr auto result_expr() const noexcept -> auto
         requires data_types::dt_concepts::LazilyEvaluatedExpr<deriv_type, value_type>
     {
-        static const auto expr = data_types::operation_utils::expr_reduce<Stage_Count>(
+        const auto expr = data_types::operation_utils::expr_reduce<Stage_Count>(
             m_dxdt, m_rk_params.b()
         );
         static_assert(data_types::dt_concepts::ExpressionTemplate<decltype(expr)>);
@@ -189,10 +215,10 @@ public:
     }
 
     [[nodiscard]]
-    constexpr auto error_expr() const noexcept -> auto const&
+    constexpr auto error_expr() const noexcept -> auto
         requires data_types::dt_concepts::LazilyEvaluatedExpr<deriv_type, value_type>
     {
-        static const auto expr = data_types::operation_utils::expr_reduce<Stage_Count>(
+        const auto expr = data_types::operation_utils::expr_reduce<Stage_Count>(
             m_dxdt, m_rk_params.b_diff()
         );
         static_assert(data_types::dt_concepts::ExpressionTemplate<decltype(expr)>);
@@ -218,7 +244,6 @@ public:
         }
         if constexpr (data_types::dt_concepts::SizedInstance<deriv_type>)
         {
-            assert(n == m_dxdt_err.size());
             assert(n == m_dxdt_tmp.size());
         }
         if constexpr (data_types::dt_concepts::SizedInstance<deriv_type> &&
@@ -239,6 +264,19 @@ public:
                  data_types::dt_concepts::Resizeable<typename state_type::value_type>
     {
         assert(n > 0);
+        if constexpr (s_multibuffer_backed)
+        {
+            m_storage.resize(
+                buffers::multibuffer::slot_size_for<state_type, deriv_type>(n)
+            );
+            m_x_tmp    = state_type(n, m_storage.slot(0));
+            m_dxdt_tmp = deriv_type(n, m_storage.slot(1));
+            for (auto i = 0uz; i != std::size(m_dxdt); ++i)
+            {
+                m_dxdt[i] = deriv_type(n, m_storage.slot(i + 2));
+            }
+            return;
+        }
         if constexpr (data_types::dt_concepts::Resizeable<state_type>)
         {
             m_x_tmp.resize(n);
@@ -246,7 +284,6 @@ public:
         if constexpr (data_types::dt_concepts::Resizeable<state_type>)
         {
             m_dxdt_tmp.resize(n);
-            m_dxdt_err.resize(n);
         }
         else if constexpr (data_types::dt_concepts::Resizeable<
                                typename state_type::value_type> &&
@@ -278,17 +315,30 @@ public:
         }
     }
 
+    // Shapes the internal buffers as x, for states whose shape a size does not set
+    auto resize_internals_like(state_type const& x) noexcept -> void
+        requires data_types::dt_concepts::ResizeableLike<state_type, state_type> &&
+                 data_types::dt_concepts::ResizeableLike<deriv_type, state_type>
+    {
+        m_x_tmp.resize_like(x);
+        m_dxdt_tmp.resize_like(x);
+        for (auto& dx : m_dxdt)
+        {
+            dx.resize_like(x);
+        }
+    }
+
 private:
-    rk_params_type m_rk_params;
-    state_type     m_x_tmp;
-    deriv_type     m_dxdt_err;
-    deriv_type     m_dxdt_tmp;
-    deriv_type     m_dxdt[Stage_Count];
-    time_type      m_dt          = time_type(0.1);
-    value_type     m_epsilon_abs = 1e-5;
-    value_type     m_epsilon_rel = 1e-7;
-    value_type     m_a_x         = 1;
-    value_type     m_a_dxdt      = 1;
+    rk_params_type                     m_rk_params;
+    [[no_unique_address]] storage_type m_storage;
+    state_type                         m_x_tmp;
+    deriv_type                         m_dxdt_tmp;
+    deriv_type                         m_dxdt[Stage_Count];
+    time_type                          m_dt          = time_type(0.1);
+    value_type                         m_epsilon_abs = 1e-5;
+    value_type                         m_epsilon_rel = 1e-7;
+    value_type                         m_a_x         = 1;
+    value_type                         m_a_dxdt      = 1;
 };
 
 } // namespace solvers::explicit_stepers
@@ -4,8 +4,10 @@
 #include "explicit_stepper_base.hpp"
 #include "operation_utils.hpp"
 #include "runge_kutta_params.hpp"
+#include "uniform_multibuffer.hpp"
 #include <cassert>
 #include <concepts>
+#include <iterator>
 #include <limits>
 
 namespace solvers::explicit_stepers
@@ -57,6 +59,12 @@ public:
 private:
     inline static constexpr auto s_stage_count = static_cast<order_type>(Stage_Count);
 
+    // States and derivatives with slot allocators keep the internal buffers in
+    // one multibuffer, m_x_tmp in slot 0 and m_dxdt[i] in slot i + 1
+    using storage_type =
+        buffers::multibuffer::multibuffer_for_t<Stage_Count + 1, state_type, deriv_type>;
+    inline static constexpr bool s_multibuffer_backed =
+        !std::same_as<storage_type, buffers::multibuffer::no_multibuffer>;
 
 public:
     constexpr generic_runge_kutta(rk_params_type rk_params) noexcept
@@ -70,6 +78,17 @@ public:
         resize_internals(n);
     }
 
+    constexpr generic_runge_kutta(
+        state_type const&     x,
+        rk_params_type const& rk_params
+    ) noexcept
+        requires data_types::dt_concepts::ResizeableLike<state_type, state_type> &&
+                 data_types::dt_concepts::ResizeableLike<deriv_type, state_type>
+        : m_rk_params{ rk_params }
+    {
+        resize_internals_like(x);
+    }
+
     [[nodiscard]]
     static constexpr auto stage_count() noexcept -> order_type
     {
@@ -102,10 +121,10 @@ public:
     }
 
     [[nodiscard]]
-    constexpr auto result_expr() const noexcept -> auto const&
+    constexpr auto result_expr() const noexcept -> auto
         requires data_types::dt_concepts::LazilyEvaluatedExpr<deriv_type, value_type>
     {
-        static const auto expr = data_types::operation_utils::expr_reduce<Stage_Count>(
+        const auto expr = data_types::operation_utils::expr_reduce<Stage_Count>(
             m_dxdt, m_rk_params.b()
         );
         static_assert(data_types::dt_concepts::ExpressionTemplate<decltype(expr)>);
@@ -128,6 +147,18 @@ public:
                  data_types::dt_concepts::Resizeable<typename state_type::value_type>
     {
         assert(n > 0);
+        if constexpr (s_multibuffer_backed)
+        {
+            m_storage.resize(
+                buffers::multibuffer::slot_size_for<state_type, deriv_type>(n)
+            );
+            m_x_tmp = state_type(n, m_storage.slot(0));
+            for (auto i = 0uz; i != std::size(m_dxdt); ++i)
+            {
+                m_dxdt[i] = deriv_type(n, m_storage.slot(i + 1));
+            }
+            return;
+        }
         if constexpr (data_types::dt_concepts::Resizeable<state_type>)
         {
             m_x_tmp.resize(n);
@@ -162,6 +193,18 @@ public:
         }
     }
 
+    // Shapes the internal buffers as x, for states whose shape a size does not set
+    auto resize_internals_like(state_type const& x) noexcept -> void
+        requires data_types::dt_concepts::ResizeableLike<state_type, state_type> &&
+                 data_types::dt_concepts::ResizeableLike<deriv_type, state_type>
+    {
+        m_x_tmp.resize_like(x);
+        for (auto& dx : m_dxdt)
+        {
+            dx.resize_like(x);
+        }
+    }
+
     auto assert_size_compatibility([[maybe_unused]] const size_type n) const noexcept
         -> void
     {
@@ -182,9 +225,10 @@ public:
     }
 
 private:
-    rk_params_type m_rk_params;
-    state_type     m_x_tmp;
-    deriv_type     m_dxdt[Stage_Count];
+    rk_params_type                     m_rk_params;
+    [[no_unique_address]] storage_type m_storage;
+    state_type                         m_x_tmp;
+    deriv_type                         m_dxdt[Stage_Count];
 };
 
 } // namespace solvers::explicit_stepers
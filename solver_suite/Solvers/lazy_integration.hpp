@@ -0,0 +1,69 @@
+#pragma once
+
+#include <generator>
+
+namespace solvers::integration
+{
+
+template <typename Time_Type, typename State_Type>
+struct trajectory_point
+{
+    Time_Type         t;
+    State_Type const& x;
+};
+
+// Yields the state after every step of a fixed step stepper, starting with the
+// initial condition. The state is advanced in place and the generator never ends;
+// stop pulling (or compose it with std::views::take_while) to finish the run.
+// No history is stored, so memory use does not grow with the length of the run.
+template <typename Stepper>
+[[nodiscard]]
+auto integrate_lazily(
+    Stepper&                      stepper,
+    auto&                         system,
+    typename Stepper::state_type& x,
+    typename Stepper::time_type   t0,
+    typename Stepper::time_type   dt
+)
+    -> std::generator<
+        trajectory_point<typename Stepper::time_type, typename Stepper::state_type>>
+    requires requires { stepper.do_step(system, x, t0, dt); }
+{
+    using point_t =
+        trajectory_point<typename Stepper::time_type, typename Stepper::state_type>;
+    auto t = t0;
+    co_yield point_t{ t, x };
+    while (true)
+    {
+        stepper.do_step(system, x, t, dt);
+        t += dt;
+        co_yield point_t{ t, x };
+    }
+}
+
+// Adaptive variant, yields after every accepted step of an embedded stepper. The
+// step size is controlled by the stepper itself.
+template <typename Stepper>
+[[nodiscard]]
+auto integrate_lazily(
+    Stepper&                      stepper,
+    auto&                         system,
+    typename Stepper::state_type& x,
+    typename Stepper::time_type   t0
+)
+    -> std::generator<
+        trajectory_point<typename Stepper::time_type, typename Stepper::state_type>>
+    requires requires { stepper.do_step_impl(system, x, t0); }
+{
+    using point_t =
+        trajectory_point<typename Stepper::time_type, typename Stepper::state_type>;
+    auto t = t0;
+    co_yield point_t{ t, x };
+    while (true)
+    {
+        stepper.do_step_impl(system, x, t);
+        co_yield point_t{ t, x };
+    }
+}
+
+} // namespace solvers::integration
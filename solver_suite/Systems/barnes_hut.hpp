@@ -0,0 +1,359 @@
+#pragma once
+
+#include "dynamic_array.hpp"
+#include "monotonic_allocator.hpp"
+#include "space_filling_curves.hpp"
+#include "static_array.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <limits>
+
+namespace systems::barnes_hut
+{
+
+// Linear 2^N-tree (octree for N = 3) over unit mass particles. Particles are
+// sorted along a Morton curve and every node covers a contiguous range of the
+// sorted particles. Nodes are stored in depth first order with a skip index, so
+// the traversal is a stackless forward walk over the node array. Chains of cells
+// with a single non empty child are collapsed, which bounds the node count by 2n.
+template <std::floating_point F, std::size_t N>
+class octree
+{
+public:
+    using value_type = F;
+    using size_type  = std::size_t;
+    using vec_t      = data_types::eagerly_evaluated_containers::static_array<F, N>;
+    using key_type   = utility::space_filling_curves::key_type;
+
+    inline static constexpr auto s_dimension = N;
+    inline static constexpr auto s_max_depth =
+        utility::space_filling_curves::s_bits_per_dimension<N>;
+    inline static constexpr auto s_child_count = size_type{ 1 } << N;
+
+    struct node
+    {
+        vec_t      center_of_mass{};
+        value_type side{};
+        value_type mass{};
+        size_type  begin{};
+        size_type  end{};
+        size_type  next{};
+        bool       leaf{};
+    };
+
+    struct keyed_index
+    {
+        key_type  key;
+        size_type index;
+    };
+
+public:
+    octree(size_type capacity, value_type theta, size_type leaf_size = 1) noexcept
+        : node_allocator_{ 2 * capacity }
+        , keys_(capacity)
+        , positions_(capacity)
+        , capacity_{ capacity }
+        , theta_sq_{ theta * theta }
+        , leaf_size_{ std::max(leaf_size, size_type{ 1 }) }
+    {
+        assert(capacity > 0);
+        assert(theta >= 0);
+    }
+
+    octree(octree const&)                    = delete;
+    auto operator=(octree const&) -> octree& = delete;
+
+    // Rebuilds the tree from the first n rows of z, columns [0, N) being the
+    // positions. Node storage is recycled from the previous build.
+    auto build(auto const& z, size_type n) noexcept -> void
+    {
+        assert(n <= capacity_);
+        size_ = n;
+        node_allocator_.reset();
+        node_count_ = 0;
+        if (n == 0) [[unlikely]]
+        {
+            nodes_ = nullptr;
+            return;
+        }
+        nodes_ = node_allocator_.allocate(2 * n);
+
+        vec_t lo = vec_t::filled(std::numeric_limits<value_type>::max());
+        vec_t hi = vec_t::filled(std::numeric_limits<value_type>::lowest());
+        for (auto i = 0uz; i != n; ++i)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                lo[d] = std::min(lo[d], static_cast<value_type>(z[i, d]));
+                hi[d] = std::max(hi[d], static_cast<value_type>(z[i, d]));
+            }
+        }
+        value_type side{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            side = std::max(side, hi[d] - lo[d]);
+        }
+        // Degenerate boxes (a single particle) still need a finite cell
+        side = side > value_type{} ? side : value_type{ 1 };
+        const auto inverse_side = value_type{ 1 } / side;
+
+        for (auto i = 0uz; i != n; ++i)
+        {
+            utility::space_filling_curves::grid_coordinates<N> coords{};
+            for (auto d = 0uz; d != N; ++d)
+            {
+                coords[d] = utility::space_filling_curves::quantize<N>(
+                    static_cast<value_type>(z[i, d]), lo[d], inverse_side
+                );
+            }
+            keys_[i] = { utility::space_filling_curves::morton_encode<N>(coords), i };
+        }
+        std::sort(keys_.begin(), keys_.begin() + n, [](auto const& a, auto const& b) {
+            return a.key < b.key;
+        });
+        for (auto k = 0uz; k != n; ++k)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                positions_[k][d] = static_cast<value_type>(z[keys_[k].index, d]);
+            }
+        }
+
+        build_node(0, n, 0, side);
+        assert(node_count_ <= 2 * n);
+    }
+
+    // Softened acceleration r / (|r|^3 + epsilon) on the k-th particle in Morton
+    // order, accumulated over every other particle or over the center of mass of
+    // the cells that pass the opening criterion side / distance < theta
+    [[nodiscard]]
+    auto acceleration(size_type k, value_type epsilon) const noexcept -> vec_t
+    {
+        assert(k < size_);
+        const auto& p = positions_[k];
+        vec_t       ret{};
+        for (auto idx = 0uz; idx != node_count_;)
+        {
+            const auto& nd = nodes_[idx];
+            if (nd.leaf)
+            {
+                for (auto q = nd.begin; q != nd.end; ++q)
+                {
+                    if (q == k) continue;
+                    accumulate(ret, p, positions_[q], value_type{ 1 }, epsilon);
+                }
+                idx = nd.next;
+                continue;
+            }
+            const auto contains_k = nd.begin <= k && k < nd.end;
+            if (!contains_k &&
+                nd.side * nd.side < theta_sq_ * distance_sq(p, nd.center_of_mass))
+            {
+                accumulate(ret, p, nd.center_of_mass, nd.mass, epsilon);
+                idx = nd.next;
+            }
+            else
+            {
+                ++idx;
+            }
+        }
+        return ret;
+    }
+
+    // Index, in the order of the input rows, of the k-th particle in Morton order
+    [[nodiscard]]
+    auto original_index(size_type k) const noexcept -> size_type
+    {
+        assert(k < size_);
+        return keys_[k].index;
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> size_type
+    {
+        return size_;
+    }
+
+    [[nodiscard]]
+    auto node_count() const noexcept -> size_type
+    {
+        return node_count_;
+    }
+
+private:
+    [[nodiscard]]
+    static auto distance_sq(vec_t const& a, vec_t const& b) noexcept -> value_type
+    {
+        value_type ret{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            const auto r = b[d] - a[d];
+            ret += r * r;
+        }
+        return ret;
+    }
+
+    static auto accumulate(
+        vec_t&       acc,
+        vec_t const& p,
+        vec_t const& q,
+        value_type   mass,
+        value_type   epsilon
+    ) noexcept -> void
+    {
+        const auto d      = std::sqrt(distance_sq(p, q));
+        const auto factor = mass / (d * d * d + epsilon);
+        for (auto j = 0uz; j != N; ++j)
+        {
+            acc[j] += (q[j] - p[j]) * factor;
+        }
+    }
+
+    auto build_node(
+        size_type  begin,
+        size_type  end,
+        size_type  depth,
+        value_type side
+    ) noexcept -> void
+    {
+        const auto idx = node_count_++;
+        auto&      nd  = nodes_[idx];
+        nd             = node{};
+        nd.begin       = begin;
+        nd.end         = end;
+        nd.leaf        = end - begin <= leaf_size_;
+
+        // Collapse cells whose particles all fall in the same child
+        std::array<size_type, s_child_count + 1> bounds{};
+        while (!nd.leaf)
+        {
+            if (depth == s_max_depth)
+            {
+                nd.leaf = true;
+                break;
+            }
+            bounds[0] = begin;
+            for (auto c = 0uz; c != s_child_count; ++c)
+            {
+                bounds[c + 1] = static_cast<size_type>(
+                    std::partition_point(
+                        keys_.begin() + bounds[c],
+                        keys_.begin() + end,
+                        [depth, c](auto const& e) {
+                            return utility::space_filling_curves::morton_digit<N>(
+                                       e.key, depth
+                                   ) <= c;
+                        }
+                    ) -
+                    keys_.begin()
+                );
+            }
+            auto non_empty = 0uz;
+            for (auto c = 0uz; c != s_child_count; ++c)
+            {
+                non_empty += bounds[c + 1] != bounds[c];
+            }
+            if (non_empty > 1)
+            {
+                break;
+            }
+            side /= 2;
+            ++depth;
+        }
+        nd.side = side;
+
+        if (nd.leaf)
+        {
+            nd.mass = static_cast<value_type>(end - begin);
+            for (auto k = begin; k != end; ++k)
+            {
+                nd.center_of_mass += positions_[k];
+            }
+            nd.center_of_mass /= nd.mass;
+            nd.next = node_count_;
+            return;
+        }
+
+        for (auto c = 0uz; c != s_child_count; ++c)
+        {
+            if (bounds[c + 1] == bounds[c]) continue;
+            const auto child = node_count_;
+            build_node(bounds[c], bounds[c + 1], depth + 1, side / 2);
+            // nodes_ is not reallocated, the reference to the parent stays valid
+            nd.mass += nodes_[child].mass;
+            nd.center_of_mass += nodes_[child].center_of_mass * nodes_[child].mass;
+        }
+        nd.center_of_mass /= nd.mass;
+        nd.next = node_count_;
+    }
+
+private:
+    allocators::dynamic_monotonic_allocator<node>                        node_allocator_;
+    data_types::lazily_evaluated_containers::dynamic_array<keyed_index> keys_;
+    data_types::lazily_evaluated_containers::dynamic_array<vec_t>       positions_;
+    node*                                                                nodes_{};
+    size_type                                                            node_count_{};
+    size_type                                                            size_{};
+    size_type                                                            capacity_;
+    value_type                                                           theta_sq_;
+    size_type                                                            leaf_size_;
+};
+
+// Drop-in replacement of the all pairs nbody_system functors. Rows of the state
+// are particles, columns [0, N) positions and [N, 2N) velocities. The tree is
+// rebuilt on every call.
+template <std::floating_point F, std::size_t N>
+class nbody_system
+{
+public:
+    using value_type = F;
+    using size_type  = std::size_t;
+    using tree_t     = octree<F, N>;
+
+    nbody_system(
+        size_type  n,
+        value_type theta     = value_type{ 0.5 },
+        value_type epsilon   = value_type{ 4.5e-1 },
+        size_type  leaf_size = 1
+    ) noexcept
+        : tree_(n, theta, leaf_size)
+        , n_{ n }
+        , epsilon_{ epsilon }
+    {
+    }
+
+    inline auto operator()(
+        auto const&                  z,
+        auto&                        dzdt,
+        [[maybe_unused]] auto const& t
+    ) noexcept -> void
+    {
+        tree_.build(z, n_);
+        // Morton order keeps consecutive traversals on similar paths
+        for (auto k = 0uz; k != n_; ++k)
+        {
+            const auto i     = tree_.original_index(k);
+            const auto acc_i = tree_.acceleration(k, epsilon_);
+            for (auto j = 0uz; j != N; ++j)
+            {
+                dzdt[i, j]     = z[i, j + N];
+                dzdt[i, j + N] = acc_i[j];
+            }
+        }
+    }
+
+    [[nodiscard]]
+    auto tree() const noexcept -> tree_t const&
+    {
+        return tree_;
+    }
+
+private:
+    tree_t     tree_;
+    size_type  n_;
+    value_type epsilon_;
+};
+
+} // namespace systems::barnes_hut
@@ -0,0 +1,754 @@
+#pragma once
+
+#include "dynamic_array.hpp"
+#include "static_array.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+namespace systems::fast_multipole
+{
+
+namespace detail
+{
+
+[[nodiscard]]
+constexpr auto binomial(std::size_t n, std::size_t k) noexcept -> std::size_t
+{
+    std::size_t ret = 1;
+    for (auto i = 1uz; i <= k; ++i)
+    {
+        ret = ret * (n - k + i) / i;
+    }
+    return ret;
+}
+
+[[nodiscard]]
+constexpr auto ipow(std::size_t base, std::size_t exp) noexcept -> std::size_t
+{
+    std::size_t ret = 1;
+    for (auto i = 0uz; i != exp; ++i)
+    {
+        ret *= base;
+    }
+    return ret;
+}
+
+} // namespace detail
+
+// Multi-indices alpha of N dimensions with |alpha| <= P in graded order, so the
+// indices of degree at most m are the prefix [0, count[m]). Index arithmetic
+// (alpha + beta, alpha - e_d, ...) is tabulated at compile time.
+template <std::size_t N, std::size_t P>
+struct multi_index_set
+{
+    using index_type = std::uint16_t;
+
+    inline static constexpr auto s_size = detail::binomial(P + N, N);
+    inline static constexpr auto s_none = static_cast<index_type>(s_size);
+
+    static_assert(s_size < std::numeric_limits<index_type>::max());
+
+    std::array<std::array<std::uint8_t, N>, s_size> exponents{};
+    std::array<std::uint8_t, s_size>                degree{};
+    std::array<std::size_t, P + 1>                  count{};
+    std::array<std::array<index_type, N>, s_size>   lower{};  // alpha - e_d
+    std::array<std::array<index_type, N>, s_size>   lower2{}; // alpha - 2 e_d
+    std::array<index_type, N>                       unit{};   // e_d
+    std::array<index_type, s_size * s_size>         sum{};    // alpha + beta
+
+    [[nodiscard]]
+    static constexpr auto make() noexcept -> multi_index_set
+    {
+        constexpr auto dense_size = detail::ipow(P + 1, N);
+        std::array<index_type, dense_size> dense{};
+        dense.fill(s_none);
+
+        const auto dense_index = [](auto const& e) {
+            std::size_t ret = 0;
+            for (auto d = N; d-- != 0;)
+            {
+                ret = ret * (P + 1) + e[d];
+            }
+            return ret;
+        };
+
+        multi_index_set ret{};
+        std::size_t     next = 0;
+        for (auto m = 0uz; m <= P; ++m)
+        {
+            for (auto t = 0uz; t != dense_size; ++t)
+            {
+                std::array<std::uint8_t, N> e{};
+                std::size_t                 total = 0;
+                for (auto d = 0uz, r = t; d != N; ++d, r /= P + 1)
+                {
+                    e[d] = static_cast<std::uint8_t>(r % (P + 1));
+                    total += e[d];
+                }
+                if (total != m) continue;
+                ret.exponents[next] = e;
+                ret.degree[next]    = static_cast<std::uint8_t>(m);
+                dense[t]            = static_cast<index_type>(next);
+                ++next;
+            }
+            ret.count[m] = next;
+        }
+
+        for (auto k = 0uz; k != s_size; ++k)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                auto e            = ret.exponents[k];
+                ret.lower[k][d]   = s_none;
+                ret.lower2[k][d]  = s_none;
+                if (e[d] >= 1)
+                {
+                    --e[d];
+                    ret.lower[k][d] = dense[dense_index(e)];
+                }
+                if (e[d] >= 1)
+                {
+                    --e[d];
+                    ret.lower2[k][d] = dense[dense_index(e)];
+                }
+            }
+            for (auto l = 0uz; l != s_size; ++l)
+            {
+                auto& s = ret.sum[k * s_size + l];
+                s       = s_none;
+                if (ret.degree[k] + ret.degree[l] > P) continue;
+                std::array<std::uint8_t, N> e{};
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    e[d] = static_cast<std::uint8_t>(
+                        ret.exponents[k][d] + ret.exponents[l][d]
+                    );
+                }
+                s = dense[dense_index(e)];
+            }
+        }
+        for (auto d = 0uz; d != N; ++d)
+        {
+            std::array<std::uint8_t, N> e{};
+            e[d]        = 1;
+            ret.unit[d] = dense[dense_index(e)];
+        }
+        return ret;
+    }
+};
+
+// Cartesian Taylor expansions of G(r) = 1 / |r| truncated at order P.
+// Multipoles are M_a = sum_j (x_j - c)^a / a! and locals are the derivatives
+// L_b = d^b phi(t) of the far field potential at the expansion center, with
+// phi(x) = sum_j G(x - x_j), so the acceleration of a unit mass is grad phi.
+template <std::floating_point F, std::size_t N, std::size_t P>
+    requires(N > 0 && P > 0)
+struct cartesian_expansion
+{
+    using value_type     = F;
+    using index_set_t    = multi_index_set<N, P>;
+    using vec_t          = data_types::eagerly_evaluated_containers::static_array<F, N>;
+    using coefficients_t = data_types::eagerly_evaluated_containers::
+        static_array<F, index_set_t::s_size>;
+
+    inline static constexpr auto s_order             = P;
+    inline static constexpr auto s_coefficient_count = index_set_t::s_size;
+    inline static constexpr auto s_set               = index_set_t::make();
+
+    // h^a / a! for every |a| <= P
+    [[nodiscard]]
+    static auto scaled_powers(vec_t const& h) noexcept -> coefficients_t
+    {
+        coefficients_t ret{};
+        ret[0] = value_type{ 1 };
+        for (auto k = 1uz; k != s_coefficient_count; ++k)
+        {
+            auto d = 0uz;
+            while (s_set.exponents[k][d] == 0)
+            {
+                ++d;
+            }
+            ret[k] = ret[s_set.lower[k][d]] * h[d] /
+                     static_cast<value_type>(s_set.exponents[k][d]);
+        }
+        return ret;
+    }
+
+    // d^a G(r) for every |a| <= P, from the recurrence
+    // m |r|^2 T_a = -(2m - 1) sum_d a_d r_d T_{a - e_d}
+    //               - (m - 1) sum_d a_d (a_d - 1) T_{a - 2 e_d},   m = |a|
+    [[nodiscard]]
+    static auto derivatives(vec_t const& r) noexcept -> coefficients_t
+    {
+        value_type r_sq{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            r_sq += r[d] * r[d];
+        }
+        const auto     inverse_r_sq = value_type{ 1 } / r_sq;
+        coefficients_t ret{};
+        ret[0] = std::sqrt(inverse_r_sq);
+        for (auto k = 1uz; k != s_coefficient_count; ++k)
+        {
+            const auto m = static_cast<value_type>(s_set.degree[k]);
+            value_type first{};
+            value_type second{};
+            for (auto d = 0uz; d != N; ++d)
+            {
+                const auto a_d = static_cast<value_type>(s_set.exponents[k][d]);
+                if (s_set.lower[k][d] != index_set_t::s_none)
+                {
+                    first += a_d * r[d] * ret[s_set.lower[k][d]];
+                }
+                if (s_set.lower2[k][d] != index_set_t::s_none)
+                {
+                    second += a_d * (a_d - 1) * ret[s_set.lower2[k][d]];
+                }
+            }
+            ret[k] = -((2 * m - 1) * first + (m - 1) * second) * inverse_r_sq / m;
+        }
+        return ret;
+    }
+
+    // Particle at offset r from the expansion center
+    static auto p2m(coefficients_t& multipole, vec_t const& r) noexcept -> void
+    {
+        multipole += scaled_powers(r);
+    }
+
+    // Child expansion centered at offset h from the parent center
+    static auto m2m(
+        coefficients_t&       parent,
+        coefficients_t const& child,
+        vec_t const&          h
+    ) noexcept -> void
+    {
+        const auto powers = scaled_powers(h);
+        for (auto b = 0uz; b != s_coefficient_count; ++b)
+        {
+            const auto end = s_set.count[P - s_set.degree[b]];
+            for (auto g = 0uz; g != end; ++g)
+            {
+                parent[s_set.sum[b * s_coefficient_count + g]] += child[b] * powers[g];
+            }
+        }
+    }
+
+    // Source expansion centered at offset r from the target center
+    static auto m2l(
+        coefficients_t&       local,
+        coefficients_t const& multipole,
+        vec_t const&          r
+    ) noexcept -> void
+    {
+        const auto t = derivatives(r);
+        for (auto b = 0uz; b != s_coefficient_count; ++b)
+        {
+            const auto end = s_set.count[P - s_set.degree[b]];
+            value_type acc{};
+            for (auto a = 0uz; a != end; ++a)
+            {
+                const auto term = multipole[a] * t[s_set.sum[b * s_coefficient_count + a]];
+                acc += (s_set.degree[a] & 1u) ? -term : term;
+            }
+            local[b] += acc;
+        }
+    }
+
+    // Parent expansion centered at offset -h from the child center
+    static auto l2l(
+        coefficients_t&       child,
+        coefficients_t const& parent,
+        vec_t const&          h
+    ) noexcept -> void
+    {
+        const auto powers = scaled_powers(h);
+        for (auto b = 0uz; b != s_coefficient_count; ++b)
+        {
+            const auto end = s_set.count[P - s_set.degree[b]];
+            value_type acc{};
+            for (auto g = 0uz; g != end; ++g)
+            {
+                acc += parent[s_set.sum[b * s_coefficient_count + g]] * powers[g];
+            }
+            child[b] += acc;
+        }
+    }
+
+    // Gradient of the local expansion at offset r from its center
+    [[nodiscard]]
+    static auto l2p(coefficients_t const& local, vec_t const& r) noexcept -> vec_t
+    {
+        const auto powers = scaled_powers(r);
+        const auto end    = s_set.count[P - 1];
+        vec_t      ret{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            const auto unit = s_set.unit[d];
+            for (auto b = 0uz; b != end; ++b)
+            {
+                ret[d] += local[s_set.sum[b * s_coefficient_count + unit]] * powers[b];
+            }
+        }
+        return ret;
+    }
+};
+
+// Uniform 2^N-tree over the bounding cube of the particles, refined until the
+// leaves hold about leaf_size particles on average. Cells of a level are stored
+// in lexicographic order of their integer coordinates. The far field goes
+// through the expansions (P2M, M2M, M2L, L2L, L2P), the near field of every leaf
+// (its 3^N neighborhood) is summed directly with the softened law
+// r / (|r|^3 + epsilon). Every pass is parallel over the cells of a level.
+template <std::floating_point F, std::size_t N, std::size_t P = 4>
+class multipole_grid
+{
+public:
+    using value_type     = F;
+    using size_type      = std::size_t;
+    using expansion_t    = cartesian_expansion<F, N, P>;
+    using vec_t          = typename expansion_t::vec_t;
+    using coefficients_t = typename expansion_t::coefficients_t;
+    using coordinates_t  = std::array<size_type, N>;
+
+    inline static constexpr auto s_dimension   = N;
+    inline static constexpr auto s_order       = P;
+    inline static constexpr auto s_child_count = size_type{ 1 } << N;
+    inline static constexpr auto s_min_level   = size_type{ 2 };
+    inline static constexpr auto s_max_level   = (sizeof(size_type) * 8 - 2) / N;
+
+public:
+    multipole_grid(size_type capacity, size_type leaf_size = 32) noexcept
+        : level_{ select_level(capacity, std::max(leaf_size, size_type{ 1 })) }
+        , capacity_{ capacity }
+        , multipoles_(level_offset(level_ + 1))
+        , locals_(level_offset(level_ + 1))
+        , occupancy_(level_offset(level_ + 1))
+        , cell_begin_(cell_count(level_) + 1)
+        , order_(capacity)
+        , leaf_of_(capacity)
+        , positions_(capacity)
+        , accelerations_(capacity)
+    {
+        assert(capacity > 0);
+    }
+
+    multipole_grid(multipole_grid const&)                    = delete;
+    auto operator=(multipole_grid const&) -> multipole_grid& = delete;
+
+    // Bins the first n rows of z, columns [0, N) being the positions, into the
+    // leaves and sorts them by leaf with a counting sort
+    auto build(auto const& z, size_type n) noexcept -> void
+    {
+        assert(n <= capacity_);
+        size_ = n;
+
+        vec_t hi = vec_t::filled(std::numeric_limits<value_type>::lowest());
+        lo_      = vec_t::filled(std::numeric_limits<value_type>::max());
+        for (auto i = 0uz; i != n; ++i)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                lo_[d] = std::min(lo_[d], static_cast<value_type>(z[i, d]));
+                hi[d]  = std::max(hi[d], static_cast<value_type>(z[i, d]));
+            }
+        }
+        side_ = value_type{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            side_ = std::max(side_, hi[d] - lo_[d]);
+        }
+        side_ = side_ > value_type{} ? side_ : value_type{ 1 };
+
+        const auto leaves    = cell_count(level_);
+        const auto per_side  = size_type{ 1 } << level_;
+        const auto to_leaves = static_cast<value_type>(per_side) / side_;
+        std::fill(cell_begin_.begin(), cell_begin_.end(), size_type{});
+        for (auto i = 0uz; i != n; ++i)
+        {
+            size_type leaf{};
+            for (auto d = N; d-- != 0;)
+            {
+                const auto c = static_cast<size_type>(std::clamp(
+                    (static_cast<value_type>(z[i, d]) - lo_[d]) * to_leaves,
+                    value_type{},
+                    static_cast<value_type>(per_side - 1)
+                ));
+                leaf = (leaf << level_) | c;
+            }
+            leaf_of_[i] = leaf;
+            ++cell_begin_[leaf + 1];
+        }
+        for (auto c = 0uz; c != leaves; ++c)
+        {
+            cell_begin_[c + 1] += cell_begin_[c];
+        }
+        for (auto i = 0uz; i != n; ++i)
+        {
+            // cell_begin_[leaf] is used as the insertion cursor and restored below
+            const auto k = cell_begin_[leaf_of_[i]]++;
+            order_[k]    = i;
+            for (auto d = 0uz; d != N; ++d)
+            {
+                positions_[k][d] = static_cast<value_type>(z[i, d]);
+            }
+        }
+        for (auto c = leaves; c != 0; --c)
+        {
+            cell_begin_[c] = cell_begin_[c - 1];
+        }
+        cell_begin_[0] = 0;
+    }
+
+    // Computes the acceleration of every particle
+    auto evaluate(utility::parallel::thread_pool& pool, value_type epsilon) noexcept
+        -> void
+    {
+        upward_pass(pool);
+        downward_pass(pool);
+        leaf_pass(pool, epsilon);
+    }
+
+    // Acceleration of the k-th particle in leaf order
+    [[nodiscard]]
+    auto acceleration(size_type k) const noexcept -> vec_t const&
+    {
+        assert(k < size_);
+        return accelerations_[k];
+    }
+
+    // Index, in the order of the input rows, of the k-th particle in leaf order
+    [[nodiscard]]
+    auto original_index(size_type k) const noexcept -> size_type
+    {
+        assert(k < size_);
+        return order_[k];
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> size_type
+    {
+        return size_;
+    }
+
+    [[nodiscard]]
+    auto level() const noexcept -> size_type
+    {
+        return level_;
+    }
+
+private:
+    [[nodiscard]]
+    static auto select_level(size_type capacity, size_type leaf_size) noexcept
+        -> size_type
+    {
+        auto level = s_min_level;
+        while (level < s_max_level && (cell_count(level) * leaf_size < capacity))
+        {
+            ++level;
+        }
+        return level;
+    }
+
+    [[nodiscard]]
+    static constexpr auto cell_count(size_type level) noexcept -> size_type
+    {
+        return size_type{ 1 } << (level * N);
+    }
+
+    // Index of the first cell of a level in the per level storage
+    [[nodiscard]]
+    static constexpr auto level_offset(size_type level) noexcept -> size_type
+    {
+        return (cell_count(level) - 1) / (s_child_count - 1);
+    }
+
+    [[nodiscard]]
+    static constexpr auto coordinates(size_type level, size_type cell) noexcept
+        -> coordinates_t
+    {
+        coordinates_t ret{};
+        const auto    mask = (size_type{ 1 } << level) - 1;
+        for (auto d = 0uz; d != N; ++d)
+        {
+            ret[d] = (cell >> (level * d)) & mask;
+        }
+        return ret;
+    }
+
+    [[nodiscard]]
+    static constexpr auto cell_index(size_type level, coordinates_t const& c) noexcept
+        -> size_type
+    {
+        size_type ret{};
+        for (auto d = N; d-- != 0;)
+        {
+            ret = (ret << level) | c[d];
+        }
+        return ret;
+    }
+
+    [[nodiscard]]
+    auto center(size_type level, coordinates_t const& c) const noexcept -> vec_t
+    {
+        const auto cell_side = side_ / static_cast<value_type>(size_type{ 1 } << level);
+        vec_t      ret{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            ret[d] = lo_[d] + (static_cast<value_type>(c[d]) + value_type{ 0.5 }) * cell_side;
+        }
+        return ret;
+    }
+
+    // Calls fn(neighbor) for every cell of the 3^N neighborhood of c, c included
+    static auto for_each_neighbor(
+        size_type            level,
+        coordinates_t const& c,
+        auto&&               fn
+    ) noexcept -> void
+    {
+        constexpr auto neighborhood = detail::ipow(3, N);
+        const auto     per_side     = size_type{ 1 } << level;
+        for (auto o = 0uz; o != neighborhood; ++o)
+        {
+            coordinates_t nc{};
+            auto          inside = true;
+            for (auto d = 0uz, r = o; d != N; ++d, r /= 3)
+            {
+                nc[d]  = c[d] + r % 3 - 1; // wraps around below zero
+                inside = inside && nc[d] < per_side;
+            }
+            if (inside)
+            {
+                fn(nc);
+            }
+        }
+    }
+
+    [[nodiscard]]
+    static constexpr auto are_neighbors(coordinates_t const& a, coordinates_t const& b)
+        noexcept -> bool
+    {
+        for (auto d = 0uz; d != N; ++d)
+        {
+            if (a[d] > b[d] + 1 || b[d] > a[d] + 1) return false;
+        }
+        return true;
+    }
+
+    auto upward_pass(utility::parallel::thread_pool& pool) noexcept -> void
+    {
+        const auto leaf_offset = level_offset(level_);
+        pool.parallel_for(0, cell_count(level_), [&](size_type cell) {
+            auto& multipole = multipoles_[leaf_offset + cell];
+            auto& count     = occupancy_[leaf_offset + cell];
+            multipole       = coefficients_t{};
+            count           = cell_begin_[cell + 1] - cell_begin_[cell];
+            const auto c    = center(level_, coordinates(level_, cell));
+            for (auto k = cell_begin_[cell]; k != cell_begin_[cell + 1]; ++k)
+            {
+                expansion_t::p2m(multipole, positions_[k] - c);
+            }
+        });
+        for (auto level = level_ - 1; level >= s_min_level; --level)
+        {
+            const auto offset       = level_offset(level);
+            const auto child_offset = level_offset(level + 1);
+            pool.parallel_for(0, cell_count(level), [&](size_type cell) {
+                auto& multipole = multipoles_[offset + cell];
+                auto& count     = occupancy_[offset + cell];
+                multipole       = coefficients_t{};
+                count           = 0;
+                const auto pc   = coordinates(level, cell);
+                const auto p    = center(level, pc);
+                for (auto k = 0uz; k != s_child_count; ++k)
+                {
+                    coordinates_t cc{};
+                    for (auto d = 0uz; d != N; ++d)
+                    {
+                        cc[d] = 2 * pc[d] + ((k >> d) & 1);
+                    }
+                    const auto child = child_offset + cell_index(level + 1, cc);
+                    if (occupancy_[child] == 0) continue;
+                    count += occupancy_[child];
+                    expansion_t::m2m(
+                        multipole, multipoles_[child], center(level + 1, cc) - p
+                    );
+                }
+            });
+        }
+    }
+
+    auto downward_pass(utility::parallel::thread_pool& pool) noexcept -> void
+    {
+        for (auto level = s_min_level; level <= level_; ++level)
+        {
+            const auto offset        = level_offset(level);
+            const auto parent_offset = level_offset(level - 1);
+            pool.parallel_for(0, cell_count(level), [&](size_type cell) {
+                auto& local = locals_[offset + cell];
+                local       = coefficients_t{};
+                // Empty cells have no particles to evaluate the expansion at
+                if (occupancy_[offset + cell] == 0) return;
+
+                const auto c  = coordinates(level, cell);
+                const auto t  = center(level, c);
+                auto       pc = c;
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    pc[d] /= 2;
+                }
+                if (level > s_min_level)
+                {
+                    expansion_t::l2l(
+                        local,
+                        locals_[parent_offset + cell_index(level - 1, pc)],
+                        t - center(level - 1, pc)
+                    );
+                }
+                // Interaction list: children of the parent's neighbors that are not
+                // neighbors of the cell
+                for_each_neighbor(level - 1, pc, [&](coordinates_t const& pn) {
+                    for (auto k = 0uz; k != s_child_count; ++k)
+                    {
+                        coordinates_t sc{};
+                        for (auto d = 0uz; d != N; ++d)
+                        {
+                            sc[d] = 2 * pn[d] + ((k >> d) & 1);
+                        }
+                        if (are_neighbors(c, sc)) continue;
+                        const auto source = offset + cell_index(level, sc);
+                        if (occupancy_[source] == 0) continue;
+                        expansion_t::m2l(
+                            local, multipoles_[source], t - center(level, sc)
+                        );
+                    }
+                });
+            });
+        }
+    }
+
+    auto leaf_pass(utility::parallel::thread_pool& pool, value_type epsilon) noexcept
+        -> void
+    {
+        const auto leaf_offset = level_offset(level_);
+        pool.parallel_for(0, cell_count(level_), [&](size_type cell) {
+            const auto begin = cell_begin_[cell];
+            const auto end   = cell_begin_[cell + 1];
+            if (begin == end) return;
+            const auto  c     = coordinates(level_, cell);
+            const auto  t     = center(level_, c);
+            const auto& local = locals_[leaf_offset + cell];
+            for (auto k = begin; k != end; ++k)
+            {
+                accelerations_[k] = expansion_t::l2p(local, positions_[k] - t);
+            }
+            for_each_neighbor(level_, c, [&](coordinates_t const& nc) {
+                const auto neighbor = cell_index(level_, nc);
+                for (auto k = begin; k != end; ++k)
+                {
+                    const auto& p   = positions_[k];
+                    auto&       acc = accelerations_[k];
+                    for (auto q = cell_begin_[neighbor]; q != cell_begin_[neighbor + 1];
+                         ++q)
+                    {
+                        if (q == k) continue;
+                        value_type d_sq{};
+                        for (auto d = 0uz; d != N; ++d)
+                        {
+                            const auto r = positions_[q][d] - p[d];
+                            d_sq += r * r;
+                        }
+                        const auto dist   = std::sqrt(d_sq);
+                        const auto factor = value_type{ 1 } / (dist * dist * dist + epsilon);
+                        for (auto d = 0uz; d != N; ++d)
+                        {
+                            acc[d] += (positions_[q][d] - p[d]) * factor;
+                        }
+                    }
+                }
+            });
+        });
+    }
+
+private:
+    size_type                                                             level_;
+    size_type                                                             capacity_;
+    size_type                                                             size_{};
+    vec_t                                                                 lo_{};
+    value_type                                                            side_{};
+    data_types::lazily_evaluated_containers::dynamic_array<coefficients_t> multipoles_;
+    data_types::lazily_evaluated_containers::dynamic_array<coefficients_t> locals_;
+    // Particles under every cell of every level, zero for the empty cells
+    data_types::lazily_evaluated_containers::dynamic_array<size_type>     occupancy_;
+    data_types::lazily_evaluated_containers::dynamic_array<size_type>     cell_begin_;
+    data_types::lazily_evaluated_containers::dynamic_array<size_type>     order_;
+    data_types::lazily_evaluated_containers::dynamic_array<size_type>     leaf_of_;
+    data_types::lazily_evaluated_containers::dynamic_array<vec_t>         positions_;
+    data_types::lazily_evaluated_containers::dynamic_array<vec_t>         accelerations_;
+};
+
+// Drop-in replacement of the all pairs nbody_system functors. Rows of the state
+// are particles, columns [0, N) positions and [N, 2N) velocities. Only the near
+// field is softened, far cells are at least one cell side away where the
+// softening is negligible against |r|^3.
+template <std::floating_point F, std::size_t N, std::size_t P = 4>
+class nbody_system
+{
+public:
+    using value_type = F;
+    using size_type  = std::size_t;
+    using grid_t     = multipole_grid<F, N, P>;
+
+    nbody_system(
+        size_type  n,
+        size_type  leaf_size    = 32,
+        value_type epsilon      = value_type{ 4.5e-1 },
+        size_type  thread_count = std::max(std::thread::hardware_concurrency(), 1u)
+    ) noexcept
+        : grid_(n, leaf_size)
+        , pool_(thread_count)
+        , n_{ n }
+        , epsilon_{ epsilon }
+    {
+    }
+
+    inline auto operator()(
+        auto const&                  z,
+        auto&                        dzdt,
+        [[maybe_unused]] auto const& t
+    ) noexcept -> void
+    {
+        grid_.build(z, n_);
+        grid_.evaluate(pool_, epsilon_);
+        pool_.parallel_for(0, n_, [&](size_type k) {
+            const auto  i     = grid_.original_index(k);
+            const auto& acc_i = grid_.acceleration(k);
+            for (auto j = 0uz; j != N; ++j)
+            {
+                dzdt[i, j]     = z[i, j + N];
+                dzdt[i, j + N] = acc_i[j];
+            }
+        });
+    }
+
+    [[nodiscard]]
+    auto grid() const noexcept -> grid_t const&
+    {
+        return grid_;
+    }
+
+private:
+    grid_t                         grid_;
+    utility::parallel::thread_pool pool_;
+    size_type                      n_;
+    value_type                     epsilon_;
+};
+
+} // namespace systems::fast_multipole
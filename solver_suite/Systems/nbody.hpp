@@ -0,0 +1,391 @@
+#pragma once
+
+#include "dynamic_array.hpp"
+#include "pairwise_kernels.hpp"
+#include "softening.hpp"
+#include "static_array.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+namespace systems::nbody
+{
+
+// How a state is indexed. Rows are particles, columns [0, N) positions and
+// [N, 2N) velocities
+enum struct state_layout
+{
+    buffer,              // z[i, c], static_buffer and dynamic_length_buffer
+    array_of_structures, // z[i][c], e.g. dynamic_array<static_array<F, 2 N>>
+    structure_of_arrays, // z[c][i], e.g. static_array<dynamic_array<F>, 2 N>
+};
+
+enum struct force_backend
+{
+    direct,    // one sided loops, rows split over the threads
+    symmetric, // pairwise::symmetric_kernel, every pair once
+    tiled,     // pairwise::tiled_kernel, SIMD over structure of arrays positions
+};
+
+template <state_layout Layout>
+[[nodiscard]]
+constexpr auto element(auto&& z, std::size_t i, std::size_t c) noexcept -> decltype(auto)
+{
+    if constexpr (Layout == state_layout::buffer)
+    {
+        return z[i, c];
+    }
+    else if constexpr (Layout == state_layout::array_of_structures)
+    {
+        return z[i][c];
+    }
+    else
+    {
+        return z[c][i];
+    }
+}
+
+// z[i, c] indexing over any layout, for the pairwise kernels
+template <state_layout Layout, typename State>
+struct indexed_view
+{
+    State& state;
+
+    [[nodiscard]]
+    constexpr auto operator[](std::size_t i, std::size_t c) const noexcept
+        -> decltype(auto)
+    {
+        return element<Layout>(state, i, c);
+    }
+};
+
+// z[i, c] over views of the columns [0, N) of a buffer, the positions, taken
+// once so that the force loops read the components in place at a fixed stride
+template <typename View, std::size_t N>
+struct column_views
+{
+    std::array<View, N> columns;
+
+    [[nodiscard]]
+    constexpr auto operator[](std::size_t i, std::size_t c) const noexcept
+        -> decltype(auto)
+    {
+        return columns[c][i];
+    }
+};
+
+// Unit masses, the potential energy counts every pair once and is only
+// available for softening policies that provide a potential
+template <std::floating_point F, std::size_t N>
+struct system_diagnostics
+{
+    data_types::eagerly_evaluated_containers::static_array<F, N> momentum{};
+    F                                                            kinetic_energy{};
+    F                                                            potential_energy{};
+
+    [[nodiscard]]
+    constexpr auto total_energy() const noexcept -> F
+    {
+        return kinetic_energy + potential_energy;
+    }
+};
+
+// All pairs gravity of n unit masses, a_i = sum_j r_ij f(|r_ij|) with f given by
+// the softening policy, as the system functor of the explicit steppers. The
+// force backend is chosen at compile time, thread_count is used by the direct
+// and symmetric backends. With track_diagnostics(true) every evaluation also
+// fills diagnostics() in the same pass: the potential energy is accumulated
+// by the force loop and the kinetic energy and momentum by the loop writing the
+// derivative. Note that the steppers evaluate the system on intermediate
+// stages, measure(z) gives the diagnostics of a given state.
+template <
+    std::floating_point           F,
+    std::size_t                   N,
+    state_layout                  Layout    = state_layout::buffer,
+    softening::SofteningPolicy<F> Softening = softening::cubic<F>,
+    force_backend                 Backend   = force_backend::direct>
+class nbody_system
+{
+public:
+    using value_type       = F;
+    using size_type        = std::size_t;
+    using vec_t            = data_types::eagerly_evaluated_containers::static_array<F, N>;
+    using softening_type   = Softening;
+    using diagnostics_type = system_diagnostics<F, N>;
+
+    inline static constexpr auto s_dimension = N;
+    inline static constexpr auto s_layout    = Layout;
+    inline static constexpr auto s_backend   = Backend;
+    inline static constexpr bool s_has_potential =
+        softening::SofteningPolicyWithPotential<Softening, F>;
+
+private:
+    // The pairwise kernel of the symmetric and tiled backends, the accelerations
+    // written by the direct one
+    using backend_type = std::conditional_t<
+        Backend == force_backend::symmetric,
+        pairwise::symmetric_kernel<F, N>,
+        std::conditional_t<
+            Backend == force_backend::tiled,
+            pairwise::tiled_kernel<F, N>,
+            data_types::lazily_evaluated_containers::dynamic_array<vec_t>>>;
+
+public:
+    explicit nbody_system(
+        size_type n,
+        Softening softening    = {},
+        size_type thread_count = 1
+    ) noexcept
+        : backend_{ make_backend(n, std::max(thread_count, size_type{ 1 })) }
+        , potentials_(std::max(thread_count, size_type{ 1 }))
+        , pool_(std::max(thread_count, size_type{ 1 }))
+        , softening_{ softening }
+        , n_{ n }
+    {
+    }
+
+    nbody_system(nbody_system const&)                    = delete;
+    auto operator=(nbody_system const&) -> nbody_system& = delete;
+
+    inline auto operator()(
+        auto const&                  z,
+        auto&                        dzdt,
+        [[maybe_unused]] auto const& t
+    ) noexcept -> void
+    {
+        if (track_diagnostics_)
+        {
+            diagnostics_ = evaluate<true>(z, &dzdt);
+        }
+        else
+        {
+            evaluate<false>(z, &dzdt);
+        }
+    }
+
+    // Diagnostics of the state z, without writing any derivative
+    [[nodiscard]]
+    auto measure(auto const& z) noexcept -> diagnostics_type
+    {
+        return evaluate<true>(z, nullptr);
+    }
+
+    auto track_diagnostics(bool enable) noexcept -> void
+    {
+        track_diagnostics_ = enable;
+    }
+
+    // Diagnostics of the last evaluation with tracking enabled
+    [[nodiscard]]
+    auto diagnostics() const noexcept -> diagnostics_type const&
+    {
+        return diagnostics_;
+    }
+
+    [[nodiscard]]
+    auto acceleration(size_type i) const noexcept -> vec_t
+    {
+        assert(i < n_);
+        if constexpr (Backend == force_backend::direct)
+        {
+            return backend_[i];
+        }
+        else
+        {
+            return backend_.acceleration(i);
+        }
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> size_type
+    {
+        return n_;
+    }
+
+    [[nodiscard]]
+    auto softening() const noexcept -> Softening const&
+    {
+        return softening_;
+    }
+
+private:
+    [[nodiscard]]
+    static auto make_backend(size_type n, size_type thread_count) noexcept -> backend_type
+    {
+        if constexpr (Backend == force_backend::symmetric)
+        {
+            return backend_type(n, thread_count);
+        }
+        else
+        {
+            return backend_type(n);
+        }
+    }
+
+    // dzdt may be nullptr, in which case no derivative is written
+    template <bool With_Diagnostics>
+    auto evaluate(auto const& z, auto dzdt) noexcept -> diagnostics_type
+    {
+        constexpr auto write_derivative = !std::is_null_pointer_v<decltype(dzdt)>;
+
+        diagnostics_type ret{};
+        decltype(auto)   view = positions(z);
+        if constexpr (With_Diagnostics && s_has_potential)
+        {
+            ret.potential_energy = accelerations_with_potential(view);
+        }
+        else
+        {
+            accelerations(view);
+        }
+
+        for (auto i = 0uz; i != n_; ++i)
+        {
+            const auto acc_i = acceleration(i);
+            for (auto d = 0uz; d != N; ++d)
+            {
+                const auto v = static_cast<value_type>(element<Layout>(z, i, d + N));
+                if constexpr (write_derivative)
+                {
+                    element<Layout>(*dzdt, i, d)     = v;
+                    element<Layout>(*dzdt, i, d + N) = acc_i[d];
+                }
+                if constexpr (With_Diagnostics)
+                {
+                    ret.momentum[d]    += v;
+                    ret.kinetic_energy += v * v / 2;
+                }
+            }
+        }
+        return ret;
+    }
+
+    [[nodiscard]]
+    static auto positions(auto const& z) noexcept -> decltype(auto)
+    {
+        if constexpr (Layout == state_layout::buffer)
+        {
+            return (z);
+        }
+        else
+        {
+            return indexed_view<Layout, std::remove_reference_t<decltype(z)>>{ z };
+        }
+    }
+
+    auto accelerations(auto const& z) noexcept -> void
+    {
+        if constexpr (Backend == force_backend::direct)
+        {
+            direct<false>(z);
+        }
+        else if constexpr (Backend == force_backend::symmetric)
+        {
+            backend_.evaluate(z, n_, softening_, pool_);
+        }
+        else
+        {
+            backend_.evaluate(z, n_, softening_);
+        }
+    }
+
+    auto accelerations_with_potential(auto const& z) noexcept -> value_type
+    {
+        if constexpr (Backend == force_backend::direct)
+        {
+            return direct<true>(z);
+        }
+        else if constexpr (Backend == force_backend::symmetric)
+        {
+            return backend_.evaluate_with_potential(z, n_, softening_, pool_);
+        }
+        else
+        {
+            return backend_.evaluate_with_potential(z, n_, softening_);
+        }
+    }
+
+    // Column views of buffers whose columns have a stride set at compile time,
+    // z itself otherwise
+    [[nodiscard]]
+    static auto position_columns(auto const& z) noexcept -> decltype(auto)
+    {
+        if constexpr (requires {
+                          requires decltype(z.column(0uz))::s_stride !=
+                                       std::dynamic_extent;
+                      })
+        {
+            using view_t = decltype(z.column(0uz));
+            return [&]<std::size_t... D>(std::index_sequence<D...>) {
+                return column_views<view_t, N>{ { z.column(D)... } };
+            }(std::make_index_sequence<N>{});
+        }
+        else
+        {
+            return (z);
+        }
+    }
+
+    template <bool With_Potential>
+    auto direct(auto const& state) noexcept -> value_type
+    {
+        decltype(auto) z = position_columns(state);
+        std::fill(potentials_.begin(), potentials_.end(), value_type{});
+        pool_.parallel_for_chunks(0, n_, [&](size_type b, size_type e, size_type w) {
+            value_type potential{};
+            for (auto i = b; i != e; ++i)
+            {
+                vec_t p{};
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    p[d] = static_cast<value_type>(z[i, d]);
+                }
+                vec_t acc_i{};
+                for (auto j = 0uz; j != n_; ++j)
+                {
+                    if (j == i) [[unlikely]]
+                    {
+                        continue;
+                    }
+                    vec_t      r{};
+                    value_type d_sq{};
+                    for (auto d = 0uz; d != N; ++d)
+                    {
+                        r[d]  = static_cast<value_type>(z[j, d]) - p[d];
+                        d_sq += r[d] * r[d];
+                    }
+                    const auto factor = softening_(d_sq);
+                    for (auto d = 0uz; d != N; ++d)
+                    {
+                        acc_i[d] += r[d] * factor;
+                    }
+                    if constexpr (With_Potential)
+                    {
+                        potential += softening_.potential(d_sq);
+                    }
+                }
+                backend_[i] = acc_i;
+            }
+            potentials_[w] = potential;
+        });
+        // Every pair is visited from both ends
+        return std::accumulate(potentials_.begin(), potentials_.end(), value_type{}) / 2;
+    }
+
+private:
+    backend_type                                               backend_;
+    data_types::lazily_evaluated_containers::dynamic_array<F> potentials_;
+    utility::parallel::thread_pool                             pool_;
+    Softening                                                  softening_;
+    diagnostics_type                                           diagnostics_{};
+    size_type                                                  n_;
+    bool                                                       track_diagnostics_{};
+};
+
+} // namespace systems::nbody
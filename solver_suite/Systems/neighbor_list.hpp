@@ -0,0 +1,444 @@
+#pragma once
+
+#include "dynamic_array.hpp"
+#include "static_array.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace systems::neighbor_list
+{
+
+// Uniform binning of the particles over their bounding box, cells being at least
+// cell_side wide. Particle indices are sorted by cell with a counting sort, the
+// particles of cell c are sorted()[cell_begin(c), cell_begin(c + 1)).
+template <std::floating_point F, std::size_t N>
+class cell_list
+{
+public:
+    using value_type = F;
+    using size_type  = std::size_t;
+    using vec_t      = data_types::eagerly_evaluated_containers::static_array<F, N>;
+    using cell_t     = std::array<size_type, N>;
+
+    inline static constexpr auto s_dimension = N;
+
+public:
+    explicit cell_list(size_type capacity) noexcept
+        : cell_of_(capacity)
+        , sorted_(capacity)
+        , capacity_{ capacity }
+    {
+        assert(capacity > 0);
+    }
+
+    // Bins the first n rows of z, columns [0, N) being the positions
+    auto build(auto const& z, size_type n, value_type cell_side) noexcept -> void
+    {
+        assert(n <= capacity_);
+        assert(cell_side > 0);
+        size_ = n;
+
+        vec_t hi = vec_t::filled(std::numeric_limits<value_type>::lowest());
+        lo_      = vec_t::filled(std::numeric_limits<value_type>::max());
+        for (auto i = 0uz; i != n; ++i)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                lo_[d] = std::min(lo_[d], static_cast<value_type>(z[i, d]));
+                hi[d]  = std::max(hi[d], static_cast<value_type>(z[i, d]));
+            }
+        }
+        // Sparse systems would otherwise allocate far more cells than particles
+        const auto per_dimension = std::pow(
+            static_cast<value_type>(2 * n), value_type{ 1 } / static_cast<value_type>(N)
+        );
+        const auto max_per_dimension =
+            static_cast<size_type>(std::max(per_dimension, value_type{ 1 }));
+        cell_count_ = 1;
+        for (auto d = 0uz; d != N; ++d)
+        {
+            const auto extent = n == 0 ? value_type{} : hi[d] - lo_[d];
+            cells_[d]         = std::clamp(
+                static_cast<size_type>(extent / cell_side),
+                size_type{ 1 },
+                max_per_dimension
+            );
+            inverse_side_[d] = static_cast<value_type>(cells_[d]) /
+                               std::max(extent, std::numeric_limits<value_type>::min());
+            cell_count_ *= cells_[d];
+        }
+
+        cell_begin_.assign(cell_count_ + 1, 0);
+        for (auto i = 0uz; i != n; ++i)
+        {
+            cell_of_[i] = linear_index(cell_of(z, i));
+            ++cell_begin_[cell_of_[i] + 1];
+        }
+        for (auto c = 0uz; c != cell_count_; ++c)
+        {
+            cell_begin_[c + 1] += cell_begin_[c];
+        }
+        // cell_begin_[c] is used as the insertion cursor and restored below
+        for (auto i = 0uz; i != n; ++i)
+        {
+            sorted_[cell_begin_[cell_of_[i]]++] = i;
+        }
+        for (auto c = cell_count_; c != 0; --c)
+        {
+            cell_begin_[c] = cell_begin_[c - 1];
+        }
+        cell_begin_[0] = 0;
+    }
+
+    // Calls fn(j) for every particle j in the 3^N cells around the cell of
+    // particle i, i included
+    auto for_each_candidate(size_type i, auto&& fn) const noexcept -> void
+    {
+        assert(i < size_);
+        const auto c = coordinates(cell_of_[i]);
+        for_each_neighbor_cell(c, [&](size_type cell) {
+            for (auto k = cell_begin_[cell]; k != cell_begin_[cell + 1]; ++k)
+            {
+                fn(sorted_[k]);
+            }
+        });
+    }
+
+    [[nodiscard]]
+    auto sorted() const noexcept -> std::span<size_type const>
+    {
+        return { sorted_.begin(), size_ };
+    }
+
+    [[nodiscard]]
+    auto cell_begin(size_type c) const noexcept -> size_type
+    {
+        assert(c <= cell_count_);
+        return cell_begin_[c];
+    }
+
+    [[nodiscard]]
+    auto cell_count() const noexcept -> size_type
+    {
+        return cell_count_;
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> size_type
+    {
+        return size_;
+    }
+
+private:
+    [[nodiscard]]
+    auto cell_of(auto const& z, size_type i) const noexcept -> cell_t
+    {
+        cell_t ret{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            const auto u = (static_cast<value_type>(z[i, d]) - lo_[d]) * inverse_side_[d];
+            ret[d]       = std::min(static_cast<size_type>(u), cells_[d] - 1);
+        }
+        return ret;
+    }
+
+    [[nodiscard]]
+    auto linear_index(cell_t const& c) const noexcept -> size_type
+    {
+        size_type ret{};
+        for (auto d = N; d-- != 0;)
+        {
+            ret = ret * cells_[d] + c[d];
+        }
+        return ret;
+    }
+
+    [[nodiscard]]
+    auto coordinates(size_type cell) const noexcept -> cell_t
+    {
+        cell_t ret{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            ret[d] = cell % cells_[d];
+            cell /= cells_[d];
+        }
+        return ret;
+    }
+
+    auto for_each_neighbor_cell(cell_t const& c, auto&& fn) const noexcept -> void
+    {
+        auto neighborhood = 1uz;
+        for (auto d = 0uz; d != N; ++d)
+        {
+            neighborhood *= 3;
+        }
+        for (auto o = 0uz; o != neighborhood; ++o)
+        {
+            cell_t nc{};
+            auto   inside = true;
+            for (auto d = 0uz, r = o; d != N; ++d, r /= 3)
+            {
+                nc[d]  = c[d] + r % 3 - 1; // wraps around below zero
+                inside = inside && nc[d] < cells_[d];
+            }
+            if (inside)
+            {
+                fn(linear_index(nc));
+            }
+        }
+    }
+
+private:
+    data_types::lazily_evaluated_containers::dynamic_array<size_type> cell_of_;
+    data_types::lazily_evaluated_containers::dynamic_array<size_type> sorted_;
+    std::vector<size_type>                                            cell_begin_;
+    vec_t                                                             lo_{};
+    vec_t                                                             inverse_side_{};
+    cell_t                                                            cells_{};
+    size_type                                                         cell_count_{};
+    size_type                                                         size_{};
+    size_type                                                         capacity_;
+};
+
+// Verlet neighbor lists with a skin. Lists hold every particle closer than
+// cutoff + skin and are stored in CSR form (neighbors of i are
+// neighbors(i) = list[begin[i], begin[i + 1])). update() only rebuilds them once
+// some particle moved more than skin / 2 since the last build, so every pair
+// within the cutoff is guaranteed to be in the lists in between rebuilds.
+template <std::floating_point F, std::size_t N>
+class verlet_list
+{
+public:
+    using value_type = F;
+    using size_type  = std::size_t;
+    using vec_t      = typename cell_list<F, N>::vec_t;
+
+public:
+    verlet_list(size_type capacity, value_type cutoff, value_type skin) noexcept
+        : cells_(capacity)
+        , reference_(capacity)
+        , begin_(capacity + 1)
+        , capacity_{ capacity }
+        , cutoff_{ cutoff }
+        , skin_{ skin }
+    {
+        assert(cutoff > 0);
+        assert(skin >= 0);
+    }
+
+    verlet_list(verlet_list const&)                    = delete;
+    auto operator=(verlet_list const&) -> verlet_list& = delete;
+
+    // Rebuilds the lists if needed, returns whether they were rebuilt
+    auto update(auto const& z, size_type n) noexcept -> bool
+    {
+        assert(n <= capacity_);
+        if (built_ && n == size_ && !moved_beyond_skin(z))
+        {
+            return false;
+        }
+        rebuild(z, n);
+        return true;
+    }
+
+    // Forces a rebuild on the next update, e.g. after the rows were permuted
+    auto invalidate() noexcept -> void
+    {
+        built_ = false;
+    }
+
+    auto rebuild(auto const& z, size_type n) noexcept -> void
+    {
+        assert(n <= capacity_);
+        size_                   = n;
+        built_                  = true;
+        const auto list_radius  = cutoff_ + skin_;
+        const auto list_radius2 = list_radius * list_radius;
+        cells_.build(z, n, list_radius);
+        for (auto i = 0uz; i != n; ++i)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                reference_[i][d] = static_cast<value_type>(z[i, d]);
+            }
+        }
+
+        list_.clear();
+        for (auto i = 0uz; i != n; ++i)
+        {
+            begin_[i]     = list_.size();
+            const auto& p = reference_[i];
+            cells_.for_each_candidate(i, [&](size_type j) {
+                if (j == i) return;
+                value_type d_sq{};
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    const auto r = reference_[j][d] - p[d];
+                    d_sq += r * r;
+                }
+                if (d_sq < list_radius2)
+                {
+                    list_.push_back(j);
+                }
+            });
+        }
+        begin_[n] = list_.size();
+        ++rebuild_count_;
+    }
+
+    [[nodiscard]]
+    auto neighbors(size_type i) const noexcept -> std::span<size_type const>
+    {
+        assert(i < size_);
+        return { list_.data() + begin_[i], list_.data() + begin_[i + 1] };
+    }
+
+    [[nodiscard]]
+    auto cutoff() const noexcept -> value_type
+    {
+        return cutoff_;
+    }
+
+    [[nodiscard]]
+    auto skin() const noexcept -> value_type
+    {
+        return skin_;
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> size_type
+    {
+        return size_;
+    }
+
+    [[nodiscard]]
+    auto pair_count() const noexcept -> size_type
+    {
+        return list_.size();
+    }
+
+    [[nodiscard]]
+    auto rebuild_count() const noexcept -> size_type
+    {
+        return rebuild_count_;
+    }
+
+private:
+    [[nodiscard]]
+    auto moved_beyond_skin(auto const& z) const noexcept -> bool
+    {
+        const auto limit2 = skin_ * skin_ / 4;
+        for (auto i = 0uz; i != size_; ++i)
+        {
+            value_type d_sq{};
+            for (auto d = 0uz; d != N; ++d)
+            {
+                const auto r = static_cast<value_type>(z[i, d]) - reference_[i][d];
+                d_sq += r * r;
+            }
+            if (d_sq > limit2)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    cell_list<F, N>                                                   cells_;
+    data_types::lazily_evaluated_containers::dynamic_array<vec_t>     reference_;
+    data_types::lazily_evaluated_containers::dynamic_array<size_type> begin_;
+    std::vector<size_type>                                            list_;
+    size_type                                                         capacity_;
+    size_type                                                         size_{};
+    size_type                                                         rebuild_count_{};
+    value_type                                                        cutoff_;
+    value_type                                                        skin_;
+    bool                                                              built_{};
+};
+
+// Short range variant of the nbody_system functors: the softened law
+// r / (|r|^3 + epsilon) truncated at the cutoff radius. Rows of the state are
+// particles, columns [0, N) positions and [N, 2N) velocities.
+template <std::floating_point F, std::size_t N>
+class cutoff_system
+{
+public:
+    using value_type = F;
+    using size_type  = std::size_t;
+    using list_t     = verlet_list<F, N>;
+
+    cutoff_system(
+        size_type  n,
+        value_type cutoff,
+        value_type skin    = value_type{ 0.3 },
+        value_type epsilon = value_type{ 4.5e-1 }
+    ) noexcept
+        : list_(n, cutoff, skin)
+        , n_{ n }
+        , cutoff2_{ cutoff * cutoff }
+        , epsilon_{ epsilon }
+    {
+    }
+
+    inline auto operator()(
+        auto const&                  z,
+        auto&                        dzdt,
+        [[maybe_unused]] auto const& t
+    ) noexcept -> void
+    {
+        list_.update(z, n_);
+        for (auto i = 0uz; i != n_; ++i)
+        {
+            std::array<value_type, N> acc_i{};
+            for (const auto j : list_.neighbors(i))
+            {
+                std::array<value_type, N> r{};
+                value_type                d_sq{};
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    r[d] = static_cast<value_type>(z[j, d]) -
+                           static_cast<value_type>(z[i, d]);
+                    d_sq += r[d] * r[d];
+                }
+                if (d_sq >= cutoff2_) continue;
+                const auto dist   = std::sqrt(d_sq);
+                const auto factor = value_type{ 1 } / (dist * dist * dist + epsilon_);
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    acc_i[d] += r[d] * factor;
+                }
+            }
+            for (auto j = 0uz; j != N; ++j)
+            {
+                dzdt[i, j]     = z[i, j + N];
+                dzdt[i, j + N] = acc_i[j];
+            }
+        }
+    }
+
+    auto invalidate() noexcept -> void
+    {
+        list_.invalidate();
+    }
+
+    [[nodiscard]]
+    auto neighbor_list() const noexcept -> list_t const&
+    {
+        return list_;
+    }
+
+private:
+    list_t     list_;
+    size_type  n_;
+    value_type cutoff2_;
+    value_type epsilon_;
+};
+
+} // namespace systems::neighbor_list
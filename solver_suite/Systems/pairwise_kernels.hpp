@@ -0,0 +1,469 @@
+#pragma once
+
+#include "dynamic_array.hpp"
+#include "softening.hpp"
+#include "static_array.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <experimental/simd>
+#include <numeric>
+#include <type_traits>
+
+namespace systems::pairwise
+{
+
+namespace stdx = std::experimental;
+
+// Buffers whose columns are contiguous, i.e. static_buffer with
+// layout_column_major (structure of arrays)
+template <typename Buffer>
+concept ColumnMajorBuffer = requires {
+    std::remove_cvref_t<Buffer>::s_layout_policy;
+    typename std::remove_cvref_t<Buffer>::layout_policy_t;
+} && (std::remove_cvref_t<Buffer>::s_layout_policy ==
+      std::remove_cvref_t<Buffer>::layout_policy_t::layout_column_major);
+
+// Static buffers with a blocked layout (array of structures of arrays) whose
+// blocks are whole packs of Lanes
+template <typename Buffer, std::size_t Lanes>
+concept BlockedBuffer = requires {
+    std::remove_cvref_t<Buffer>::s_layout_policy.blocked();
+    std::remove_cvref_t<Buffer>::s_block_width;
+} && (std::remove_cvref_t<Buffer>::s_layout_policy.blocked() &&
+      std::remove_cvref_t<Buffer>::s_block_width % Lanes == 0);
+
+// All pairs accelerations visiting every pair i < j once and scattering +f to i
+// and -f to j (unit masses, Newton's third law), which halves the flops of the
+// one sided loops. Positions are packed once per evaluation instead of once per
+// pair. The parallel evaluation gives every task its own accumulator, rows are
+// dealt cyclically so that the triangular loop stays balanced, and the
+// accumulators are reduced at the end, so no two threads write the same memory.
+template <std::floating_point F, std::size_t N>
+class symmetric_kernel
+{
+public:
+    using value_type = F;
+    using size_type  = std::size_t;
+    using vec_t      = data_types::eagerly_evaluated_containers::static_array<F, N>;
+
+public:
+    explicit symmetric_kernel(size_type capacity, size_type thread_count = 1) noexcept
+        : positions_(capacity)
+        , accumulators_(capacity * std::max(thread_count, size_type{ 1 }))
+        , potentials_(std::max(thread_count, size_type{ 1 }))
+        , capacity_{ capacity }
+        , thread_count_{ std::max(thread_count, size_type{ 1 }) }
+    {
+    }
+
+    // Accelerations of the first n rows of z, columns [0, N) being the positions
+    template <softening::SofteningPolicy<F> Softening>
+    auto evaluate(auto const& z, size_type n, Softening const& softening) noexcept
+        -> void
+    {
+        pack(z, n);
+        accumulate_rows<false>(0, 1, softening);
+    }
+
+    template <softening::SofteningPolicy<F> Softening>
+    auto evaluate(
+        auto const&                     z,
+        size_type                       n,
+        Softening const&                softening,
+        utility::parallel::thread_pool& pool
+    ) noexcept -> void
+    {
+        evaluate_parallel<false>(z, n, softening, pool);
+    }
+
+    // Same as evaluate, also returning the potential energy, every pair once
+    template <softening::SofteningPolicyWithPotential<F> Softening>
+    auto evaluate_with_potential(
+        auto const&      z,
+        size_type        n,
+        Softening const& softening
+    ) noexcept -> value_type
+    {
+        pack(z, n);
+        return accumulate_rows<true>(0, 1, softening);
+    }
+
+    template <softening::SofteningPolicyWithPotential<F> Softening>
+    auto evaluate_with_potential(
+        auto const&                     z,
+        size_type                       n,
+        Softening const&                softening,
+        utility::parallel::thread_pool& pool
+    ) noexcept -> value_type
+    {
+        return evaluate_parallel<true>(z, n, softening, pool);
+    }
+
+    [[nodiscard]]
+    auto acceleration(size_type i) const noexcept -> vec_t const&
+    {
+        assert(i < size_);
+        return accumulators_[i];
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> size_type
+    {
+        return size_;
+    }
+
+private:
+    template <bool With_Potential, typename Softening>
+    auto evaluate_parallel(
+        auto const&                     z,
+        size_type                       n,
+        Softening const&                softening,
+        utility::parallel::thread_pool& pool
+    ) noexcept -> value_type
+    {
+        pack(z, n);
+        const auto tasks = std::min(pool.size(), thread_count_);
+        pool.parallel_for(0, tasks, [&](size_type task) {
+            potentials_[task] = accumulate_rows<With_Potential>(task, tasks, softening);
+        });
+        if (tasks != 1)
+        {
+            pool.parallel_for(0, size_, [&](size_type i) {
+                auto& acc = accumulators_[i];
+                for (auto task = 1uz; task != tasks; ++task)
+                {
+                    acc += accumulators_[task * capacity_ + i];
+                }
+            });
+        }
+        return std::accumulate(
+            potentials_.begin(), potentials_.begin() + tasks, value_type{}
+        );
+    }
+
+    auto pack(auto const& z, size_type n) noexcept -> void
+    {
+        assert(n <= capacity_);
+        size_ = n;
+        for (auto i = 0uz; i != n; ++i)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                positions_[i][d] = static_cast<value_type>(z[i, d]);
+            }
+        }
+    }
+
+    // Rows first, first + stride, ... into the accumulator of task first, returns
+    // the potential energy of the pairs visited when With_Potential
+    template <bool With_Potential, typename Softening>
+    auto accumulate_rows(size_type first, size_type stride, Softening const& softening)
+        noexcept -> value_type
+    {
+        auto* acc = accumulators_.begin() + first * capacity_;
+        std::fill(acc, acc + size_, vec_t{});
+        value_type potential{};
+        for (auto i = first; i < size_; i += stride)
+        {
+            const auto p   = positions_[i];
+            vec_t      a_i = acc[i];
+            for (auto j = i + 1; j != size_; ++j)
+            {
+                vec_t      r{};
+                value_type d_sq{};
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    r[d] = positions_[j][d] - p[d];
+                    d_sq += r[d] * r[d];
+                }
+                const auto factor = softening(d_sq);
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    const auto f = r[d] * factor;
+                    a_i[d] += f;
+                    acc[j][d] -= f;
+                }
+                if constexpr (With_Potential)
+                {
+                    potential += softening.potential(d_sq);
+                }
+            }
+            acc[i] = a_i;
+        }
+        return potential;
+    }
+
+private:
+    data_types::lazily_evaluated_containers::dynamic_array<vec_t> positions_;
+    data_types::lazily_evaluated_containers::dynamic_array<vec_t> accumulators_;
+    data_types::lazily_evaluated_containers::dynamic_array<F>     potentials_;
+    size_type                                                     capacity_;
+    size_type                                                     thread_count_;
+    size_type                                                     size_{};
+};
+
+// All pairs accelerations over structure of arrays positions with
+// std::experimental::native_simd. Tiles of s_tile_rows i-particles are broadcast
+// and kept in registers while packs of j-particles are streamed past them, so
+// every j load is reused s_tile_rows times. Distances accumulate with fma and
+// the softening is evaluated on whole packs. Column major buffers and blocked
+// buffers with blocks of whole packs are read in place, any other state is first
+// transposed to an internal structure of arrays. The self pairs (i == j) are
+// skipped by index.
+template <std::floating_point F, std::size_t N>
+class tiled_kernel
+{
+public:
+    using value_type = F;
+    using size_type  = std::size_t;
+    using vec_t      = data_types::eagerly_evaluated_containers::static_array<F, N>;
+    using simd_t     = stdx::native_simd<F>;
+
+    inline static constexpr auto s_lanes     = simd_t::size();
+    inline static constexpr auto s_tile_rows = size_type{ 2 };
+
+public:
+    explicit tiled_kernel(size_type capacity) noexcept
+        : columns_(N * capacity)
+        , accelerations_(N * capacity)
+        , capacity_{ capacity }
+    {
+    }
+
+    // Accelerations of the first n rows of z, columns [0, N) being the positions
+    template <softening::SofteningPolicy<F> Softening>
+    auto evaluate(auto const& z, size_type n, Softening const& softening) noexcept
+        -> void
+    {
+        evaluate_impl<false>(z, n, softening);
+    }
+
+    // Same as evaluate, also returning the potential energy, every pair once
+    template <softening::SofteningPolicyWithPotential<F> Softening>
+    auto evaluate_with_potential(
+        auto const&      z,
+        size_type        n,
+        Softening const& softening
+    ) noexcept -> value_type
+    {
+        return evaluate_impl<true>(z, n, softening);
+    }
+
+    [[nodiscard]]
+    auto acceleration(size_type i) const noexcept -> vec_t
+    {
+        assert(i < size_);
+        vec_t ret{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            ret[d] = accelerations_[d * capacity_ + i];
+        }
+        return ret;
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> size_type
+    {
+        return size_;
+    }
+
+private:
+    // Component d of particle j is at columns[d][j / run * run_stride + j % run],
+    // runs of contiguous particles being whole packs: the columns of a structure
+    // of arrays are runs of s_lanes that follow each other, in blocked buffers
+    // the runs are the blocks
+    struct positions_t
+    {
+        std::array<value_type const*, N> columns{};
+        size_type                        run{ s_lanes };
+        size_type                        run_stride{ s_lanes };
+
+        [[nodiscard]]
+        auto operator()(size_type d, size_type j) const noexcept -> value_type
+        {
+            return columns[d][j / run * run_stride + j % run];
+        }
+    };
+
+    template <bool With_Potential, typename Softening>
+    auto evaluate_impl(auto const& z, size_type n, Softening const& softening) noexcept
+        -> value_type
+    {
+        assert(n <= capacity_);
+        size_ = n;
+        if (n == 0) [[unlikely]]
+        {
+            return value_type{};
+        }
+        using state_t = std::remove_cvref_t<decltype(z)>;
+        constexpr bool same_value_type =
+            std::same_as<std::remove_cvref_t<decltype(z[0uz, 0uz])>, value_type>;
+
+        positions_t x{};
+        if constexpr (BlockedBuffer<state_t, s_lanes> && same_value_type)
+        {
+            x.run        = state_t::s_block_width;
+            x.run_stride = state_t::s_block_width * state_t::s_size_x;
+            for (auto d = 0uz; d != N; ++d)
+            {
+                x.columns[d] = &z[0uz, d];
+            }
+        }
+        else if constexpr (ColumnMajorBuffer<state_t> && same_value_type)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                x.columns[d] = &z[0uz, d];
+            }
+        }
+        else
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                auto* column = columns_.begin() + d * capacity_;
+                for (auto i = 0uz; i != n; ++i)
+                {
+                    column[i] = static_cast<value_type>(z[i, d]);
+                }
+                x.columns[d] = column;
+            }
+        }
+
+        // Every pair is visited from both ends
+        value_type potential{};
+        auto       i = 0uz;
+        for (; i + s_tile_rows <= n; i += s_tile_rows)
+        {
+            potential += tile<s_tile_rows, With_Potential>(x, i, softening);
+        }
+        for (; i != n; ++i)
+        {
+            potential += tile<1, With_Potential>(x, i, softening);
+        }
+        return potential / 2;
+    }
+
+    template <size_type Rows, bool With_Potential, typename Softening>
+    auto tile(positions_t const& x, size_type first, Softening const& softening) noexcept
+        -> value_type
+    {
+        simd_t     potential(value_type{});
+        value_type tail_potential{};
+        std::array<std::array<simd_t, N>, Rows>     p{};
+        std::array<std::array<simd_t, N>, Rows>     acc{};
+        std::array<std::array<value_type, N>, Rows> tail{};
+        for (auto r = 0uz; r != Rows; ++r)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                p[r][d]   = simd_t(x(d, first + r));
+                acc[r][d] = simd_t(value_type{});
+            }
+        }
+
+        auto j      = 0uz;
+        auto offset = 0uz; // of pack j in the columns
+        auto in_run = 0uz;
+        for (; j + s_lanes <= size_; j += s_lanes)
+        {
+            std::array<simd_t, N> q{};
+            for (auto d = 0uz; d != N; ++d)
+            {
+                q[d].copy_from(x.columns[d] + offset, stdx::element_aligned);
+            }
+            offset += s_lanes;
+            in_run += s_lanes;
+            if (in_run == x.run)
+            {
+                offset += x.run_stride - x.run;
+                in_run = 0;
+            }
+            for (auto r = 0uz; r != Rows; ++r)
+            {
+                std::array<simd_t, N> dist{};
+                simd_t                d_sq(value_type{});
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    dist[d] = q[d] - p[r][d];
+                    d_sq    = fma(dist[d], dist[d], d_sq);
+                }
+                // Lane of particle first + r when it is in the pack
+                const auto self     = first + r - j;
+                const auto has_self = first + r >= j && self < s_lanes;
+                simd_t     factor   = softening(d_sq);
+                if (has_self)
+                {
+                    factor[self] = value_type{};
+                }
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    acc[r][d] = fma(dist[d], factor, acc[r][d]);
+                }
+                if constexpr (With_Potential)
+                {
+                    simd_t u = softening.potential(d_sq);
+                    if (has_self)
+                    {
+                        u[self] = value_type{};
+                    }
+                    potential += u;
+                }
+            }
+        }
+        for (; j != size_; ++j)
+        {
+            for (auto r = 0uz; r != Rows; ++r)
+            {
+                std::array<value_type, N> dist{};
+                value_type                d_sq{};
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    dist[d] = x(d, j) - x(d, first + r);
+                    d_sq += dist[d] * dist[d];
+                }
+                if (j == first + r) continue;
+                const auto factor = softening(d_sq);
+                for (auto d = 0uz; d != N; ++d)
+                {
+                    tail[r][d] += dist[d] * factor;
+                }
+                if constexpr (With_Potential)
+                {
+                    tail_potential += softening.potential(d_sq);
+                }
+            }
+        }
+
+        for (auto r = 0uz; r != Rows; ++r)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                auto sum = tail[r][d];
+                for (auto lane = 0uz; lane != s_lanes; ++lane)
+                {
+                    sum += acc[r][d][lane];
+                }
+                accelerations_[d * capacity_ + first + r] = sum;
+            }
+        }
+        if constexpr (With_Potential)
+        {
+            for (auto lane = 0uz; lane != s_lanes; ++lane)
+            {
+                tail_potential += potential[lane];
+            }
+        }
+        return tail_potential;
+    }
+
+private:
+    data_types::lazily_evaluated_containers::dynamic_array<value_type> columns_;
+    data_types::lazily_evaluated_containers::dynamic_array<value_type> accelerations_;
+    size_type                                                          capacity_;
+    size_type                                                          size_{};
+};
+
+} // namespace systems::pairwise
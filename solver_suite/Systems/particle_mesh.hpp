@@ -0,0 +1,330 @@
+#pragma once
+
+#include "buffer_interface.hpp"
+#include "dynamic_array.hpp"
+#include "fft.hpp"
+#include "static_array.hpp"
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <concepts>
+#include <numbers>
+
+namespace systems::particle_mesh
+{
+
+// Periodic particle-mesh gravity on a cube of side box_length with M cells per
+// side. Mass is deposited with cloud-in-cell (CIC) weights, Poisson's equation
+// lap(phi) = -S_N rho (S_N the area of the unit sphere, 4 pi for N = 3) is solved
+// with FFTs, the gradient of phi is taken with central differences on the mesh
+// and interpolated back to the particles with the same CIC weights, which keeps
+// the self force zero. The mean density is removed (k = 0 mode), as usual for
+// periodic boxes. Cost is O(n + M^N log M).
+//
+// The mesh is stored as M^(N-1) rows of M cells, axis 0 being the contiguous one,
+// and indexed through a dynamic_shape so that rows can be padded.
+template <std::floating_point F, std::size_t N>
+    requires(N > 0)
+class pm_grid
+{
+public:
+    using value_type   = F;
+    using size_type    = std::size_t;
+    using complex_type = std::complex<F>;
+    using vec_t        = data_types::eagerly_evaluated_containers::static_array<F, N>;
+    using shape_t      = buffers::buffer_interface::dynamic_shape;
+    using index_t      = std::array<size_type, N>;
+
+    inline static constexpr auto s_dimension    = N;
+    inline static constexpr auto s_corner_count = size_type{ 1 } << N;
+
+public:
+    pm_grid(
+        size_type  cells_per_side,
+        value_type box_length,
+        size_type  minor_stride = 0
+    ) noexcept
+        : cells_per_side_{ cells_per_side }
+        , cell_count_{ ipow(cells_per_side, N) }
+        , box_length_{ box_length }
+        , cell_size_{ box_length / static_cast<value_type>(cells_per_side) }
+        , shape_{ cell_count_ / cells_per_side,
+                  cell_count_ / cells_per_side,
+                  cells_per_side,
+                  cells_per_side,
+                  buffers::buffer_config::LayoutPolicy::layout_row_major,
+                  minor_stride }
+        , mesh_(shape_.underlying_flat_size())
+        , field_(shape_.underlying_flat_size())
+        , plan_(cells_per_side)
+    {
+        assert(cells_per_side > 1);
+        assert(box_length > 0);
+    }
+
+    pm_grid(pm_grid const&)                    = delete;
+    auto operator=(pm_grid const&) -> pm_grid& = delete;
+
+    // CIC deposit of the first n rows of z, columns [0, N) being the positions
+    auto deposit(auto const& z, size_type n, value_type mass = value_type{ 1 }) noexcept
+        -> void
+    {
+        std::fill(mesh_.begin(), mesh_.end(), complex_type{});
+        const auto density = mass / ipow(cell_size_, N);
+        for (auto i = 0uz; i != n; ++i)
+        {
+            vec_t position{};
+            for (auto d = 0uz; d != N; ++d)
+            {
+                position[d] = static_cast<value_type>(z[i, d]);
+            }
+            for_each_corner(position, [&](size_type flat, value_type weight) {
+                mesh_[flat] += density * weight;
+            });
+        }
+    }
+
+    // Solves for the potential and stores its gradient on the mesh
+    auto solve() noexcept -> void
+    {
+        for (auto d = 0uz; d != N; ++d)
+        {
+            transform_axis(d, [this](complex_type* line, size_type stride) {
+                plan_.forward(line, stride);
+            });
+        }
+
+        const auto fundamental = 2 * std::numbers::pi_v<value_type> / box_length_;
+        const auto source      = unit_sphere_area();
+        for_each_cell([&](index_t const& c, size_type flat) {
+            if (c == index_t{})
+            {
+                mesh_[flat] = complex_type{};
+                return;
+            }
+            value_type k_sq{};
+            for (auto d = 0uz; d != N; ++d)
+            {
+                const auto wave = c[d] <= cells_per_side_ / 2
+                                      ? static_cast<value_type>(c[d])
+                                      : static_cast<value_type>(c[d]) -
+                                            static_cast<value_type>(cells_per_side_);
+                k_sq += wave * wave;
+            }
+            k_sq        *= fundamental * fundamental;
+            mesh_[flat] *= source / k_sq;
+        });
+
+        for (auto d = 0uz; d != N; ++d)
+        {
+            transform_axis(d, [this](complex_type* line, size_type stride) {
+                plan_.inverse(line, stride);
+            });
+        }
+
+        const auto inverse_2h = value_type{ 1 } / (2 * cell_size_);
+        for_each_cell([&](index_t const& c, size_type flat) {
+            auto& g = field_[flat];
+            for (auto d = 0uz; d != N; ++d)
+            {
+                auto up   = c;
+                auto down = c;
+                up[d]     = c[d] + 1 == cells_per_side_ ? 0 : c[d] + 1;
+                down[d]   = c[d] == 0 ? cells_per_side_ - 1 : c[d] - 1;
+                g[d] = (mesh_[flat_index(up)].real() - mesh_[flat_index(down)].real()) *
+                       inverse_2h;
+            }
+        });
+    }
+
+    // CIC interpolation of the mesh acceleration at a position
+    [[nodiscard]]
+    auto acceleration(vec_t const& position) const noexcept -> vec_t
+    {
+        vec_t ret{};
+        for_each_corner(position, [&](size_type flat, value_type weight) {
+            ret += field_[flat] * weight;
+        });
+        return ret;
+    }
+
+    [[nodiscard]]
+    auto cells_per_side() const noexcept -> size_type
+    {
+        return cells_per_side_;
+    }
+
+    [[nodiscard]]
+    auto box_length() const noexcept -> value_type
+    {
+        return box_length_;
+    }
+
+    [[nodiscard]]
+    auto shape() const noexcept -> shape_t const&
+    {
+        return shape_;
+    }
+
+private:
+    [[nodiscard]]
+    static constexpr auto ipow(auto base, std::size_t exp) noexcept
+    {
+        decltype(base) ret{ 1 };
+        for (auto i = 0uz; i != exp; ++i)
+        {
+            ret *= base;
+        }
+        return ret;
+    }
+
+    [[nodiscard]]
+    static auto unit_sphere_area() noexcept -> value_type
+    {
+        constexpr auto half_n = static_cast<value_type>(N) / 2;
+        return 2 * std::pow(std::numbers::pi_v<value_type>, half_n) / std::tgamma(half_n);
+    }
+
+    [[nodiscard]]
+    auto flat_index(index_t const& c) const noexcept -> size_type
+    {
+        size_type row{};
+        for (auto d = N; d-- > 1;)
+        {
+            row = row * cells_per_side_ + c[d];
+        }
+        return shape_.flat_projection(row, c[0]);
+    }
+
+    // Calls fn(c, flat) for every cell, axis 0 varying fastest
+    auto for_each_cell(auto&& fn) const noexcept -> void
+    {
+        index_t c{};
+        for (auto linear = 0uz; linear != cell_count_; ++linear)
+        {
+            fn(c, shape_.flat_projection(linear / cells_per_side_, c[0]));
+            for (auto d = 0uz; d != N && ++c[d] == cells_per_side_; ++d)
+            {
+                c[d] = 0;
+            }
+        }
+    }
+
+    // Calls fn(line, stride) for every line of the mesh along an axis
+    auto transform_axis(size_type axis, auto&& fn) noexcept -> void
+    {
+        const auto below  = ipow(cells_per_side_, axis);
+        const auto stride = axis == 0 ? size_type{ 1 }
+                                      : below / cells_per_side_ *
+                                            shape_.flat_projection(1, 0);
+        for (auto line = 0uz; line != cell_count_ / cells_per_side_; ++line)
+        {
+            const auto linear = line % below + line / below * below * cells_per_side_;
+            fn(mesh_.begin() +
+                   shape_.flat_projection(
+                       linear / cells_per_side_, linear % cells_per_side_
+                   ),
+               stride);
+        }
+    }
+
+    // Calls fn(flat, weight) for the 2^N cells around a position, with periodic
+    // wrapping
+    auto for_each_corner(vec_t const& position, auto&& fn) const noexcept -> void
+    {
+        const auto cells = static_cast<value_type>(cells_per_side_);
+        index_t    base{};
+        vec_t      fraction{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            auto u = position[d] / cell_size_;
+            u -= cells * std::floor(u / cells);
+            const auto cell = std::floor(u);
+            fraction[d]     = u - cell;
+            base[d]         = static_cast<size_type>(cell) % cells_per_side_;
+        }
+        for (auto corner = 0uz; corner != s_corner_count; ++corner)
+        {
+            auto       c = base;
+            value_type weight{ 1 };
+            for (auto d = 0uz; d != N; ++d)
+            {
+                if ((corner >> d) & 1)
+                {
+                    c[d]   = c[d] + 1 == cells_per_side_ ? 0 : c[d] + 1;
+                    weight *= fraction[d];
+                }
+                else
+                {
+                    weight *= 1 - fraction[d];
+                }
+            }
+            fn(flat_index(c), weight);
+        }
+    }
+
+private:
+    size_type                                                            cells_per_side_;
+    size_type                                                            cell_count_;
+    value_type                                                           box_length_;
+    value_type                                                           cell_size_;
+    shape_t                                                              shape_;
+    data_types::lazily_evaluated_containers::dynamic_array<complex_type> mesh_;
+    data_types::lazily_evaluated_containers::dynamic_array<vec_t>        field_;
+    utility::fft::plan<F>                                                plan_;
+};
+
+// Drop-in replacement of the all pairs nbody_system functors for periodic boxes.
+// Rows of the state are particles, columns [0, N) positions and [N, 2N)
+// velocities. Positions outside [0, box_length) are wrapped.
+template <std::floating_point F, std::size_t N>
+class nbody_system
+{
+public:
+    using value_type = F;
+    using size_type  = std::size_t;
+    using grid_t     = pm_grid<F, N>;
+
+    nbody_system(size_type n, value_type box_length, size_type cells_per_side) noexcept
+        : grid_(cells_per_side, box_length)
+        , n_{ n }
+    {
+    }
+
+    inline auto operator()(
+        auto const&                  z,
+        auto&                        dzdt,
+        [[maybe_unused]] auto const& t
+    ) noexcept -> void
+    {
+        grid_.deposit(z, n_);
+        grid_.solve();
+        for (auto i = 0uz; i != n_; ++i)
+        {
+            typename grid_t::vec_t position{};
+            for (auto j = 0uz; j != N; ++j)
+            {
+                position[j] = static_cast<value_type>(z[i, j]);
+            }
+            const auto acc_i = grid_.acceleration(position);
+            for (auto j = 0uz; j != N; ++j)
+            {
+                dzdt[i, j]     = z[i, j + N];
+                dzdt[i, j + N] = acc_i[j];
+            }
+        }
+    }
+
+    [[nodiscard]]
+    auto grid() const noexcept -> grid_t const&
+    {
+        return grid_;
+    }
+
+private:
+    grid_t    grid_;
+    size_type n_;
+};
+
+} // namespace systems::particle_mesh
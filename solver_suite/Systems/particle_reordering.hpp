@@ -0,0 +1,256 @@
+#pragma once
+
+#include "dynamic_array.hpp"
+#include "radix_sort.hpp"
+#include "space_filling_curves.hpp"
+#include "static_array.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace systems::reordering
+{
+
+enum struct curve
+{
+    morton,
+    hilbert,
+};
+
+// Sorts the rows of particle states along a space filling curve over their
+// bounding box, so that particles close in space are close in memory and the
+// force loops of the tree, cell and neighbor list solvers touch fewer cache
+// lines. advance() is meant to be called once per step and reorders every
+// period-th call, period 0 never reorders.
+//
+// Every buffer passed along with the state gets the same row permutation. The
+// Runge-Kutta steppers write their stage buffers before reading them on every
+// step, so only buffers that carry particle data across steps (the state
+// itself, histories, per particle parameters) need to be passed. Solvers that
+// cache per row data (e.g. verlet_list) must be invalidated after a reorder.
+//
+// original_index(row) maps a row back to the particle it held initially and
+// row_of(particle) is its inverse, gather_original() writes a state in the
+// original order for output.
+template <std::floating_point F, std::size_t N>
+class spatial_reorder
+{
+public:
+    using value_type = F;
+    using size_type  = std::size_t;
+    using key_type   = utility::space_filling_curves::key_type;
+    using vec_t      = data_types::eagerly_evaluated_containers::static_array<F, N>;
+
+public:
+    spatial_reorder(
+        size_type capacity,
+        size_type period,
+        curve     c = curve::hilbert
+    ) noexcept
+        : keys_(capacity)
+        , order_(capacity)
+        , original_(capacity)
+        , row_of_(capacity)
+        , sorter_(capacity)
+        , capacity_{ capacity }
+        , period_{ period }
+        , curve_{ c }
+    {
+        for (auto i = 0uz; i != capacity; ++i)
+        {
+            original_[i] = i;
+            row_of_[i]   = i;
+        }
+    }
+
+    spatial_reorder(spatial_reorder const&)                    = delete;
+    auto operator=(spatial_reorder const&) -> spatial_reorder& = delete;
+
+    // Counts a step and reorders on every period-th call, returns whether the
+    // rows were permuted
+    auto advance(
+        auto&                           z,
+        size_type                       n,
+        utility::parallel::thread_pool& pool,
+        auto&... others
+    ) noexcept -> bool
+    {
+        if (period_ == 0 || ++steps_ % period_ != 0)
+        {
+            return false;
+        }
+        reorder(z, n, pool, others...);
+        return true;
+    }
+
+    // Sorts the first n rows of z by the curve key of columns [0, N) and applies
+    // the same permutation to the first n rows of others
+    auto reorder(
+        auto&                           z,
+        size_type                       n,
+        utility::parallel::thread_pool& pool,
+        auto&... others
+    ) noexcept -> void
+    {
+        assert(n <= capacity_);
+        compute_keys(z, n, pool);
+        sorter_.sort(
+            pool,
+            keys_.data(),
+            order_.data(),
+            n,
+            utility::space_filling_curves::s_bits_per_dimension<N> * N
+        );
+
+        permute_rows(z, n, pool);
+        (permute_rows(others, n, pool), ...);
+
+        // Row k now holds what row order_[k] held
+        for (auto k = 0uz; k != n; ++k)
+        {
+            order_[k] = original_[order_[k]];
+        }
+        std::copy(order_.begin(), order_.begin() + n, original_.begin());
+        for (auto k = 0uz; k != n; ++k)
+        {
+            row_of_[original_[k]] = k;
+        }
+        ++reorder_count_;
+    }
+
+    // out[p, c] = z[row_of(p), c] for the first n particles
+    auto gather_original(auto const& z, auto& out, size_type n) const noexcept -> void
+    {
+        for (auto p = 0uz; p != n; ++p)
+        {
+            for (auto c = 0uz; c != z.size_x(); ++c)
+            {
+                out[p, c] = z[row_of_[p], c];
+            }
+        }
+    }
+
+    [[nodiscard]]
+    auto original_index(size_type row) const noexcept -> size_type
+    {
+        assert(row < capacity_);
+        return original_[row];
+    }
+
+    [[nodiscard]]
+    auto row_of(size_type particle) const noexcept -> size_type
+    {
+        assert(particle < capacity_);
+        return row_of_[particle];
+    }
+
+    [[nodiscard]]
+    auto period() const noexcept -> size_type
+    {
+        return period_;
+    }
+
+    [[nodiscard]]
+    auto reorder_count() const noexcept -> size_type
+    {
+        return reorder_count_;
+    }
+
+private:
+    auto compute_keys(auto const& z, size_type n, utility::parallel::thread_pool& pool)
+        noexcept -> void
+    {
+        vec_t lo = vec_t::filled(std::numeric_limits<value_type>::max());
+        vec_t hi = vec_t::filled(std::numeric_limits<value_type>::lowest());
+        for (auto i = 0uz; i != n; ++i)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                lo[d] = std::min(lo[d], static_cast<value_type>(z[i, d]));
+                hi[d] = std::max(hi[d], static_cast<value_type>(z[i, d]));
+            }
+        }
+        value_type side{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            side = std::max(side, hi[d] - lo[d]);
+        }
+        side                    = side > value_type{} ? side : value_type{ 1 };
+        const auto inverse_side = value_type{ 1 } / side;
+
+        pool.parallel_for(0, n, [&](size_type i) {
+            utility::space_filling_curves::grid_coordinates<N> coords{};
+            for (auto d = 0uz; d != N; ++d)
+            {
+                coords[d] = utility::space_filling_curves::quantize<N>(
+                    static_cast<value_type>(z[i, d]), lo[d], inverse_side
+                );
+            }
+            keys_[i] = curve_ == curve::hilbert
+                           ? utility::space_filling_curves::hilbert_encode<N>(coords)
+                           : utility::space_filling_curves::morton_encode<N>(coords);
+            order_[i] = i;
+        });
+    }
+
+    // Row k of z becomes row order_[k], through a row major copy in scratch of
+    // the element type of z. Buffers of other types than the state get scratch
+    // of their own on every reorder
+    auto permute_rows(auto& z, size_type n, utility::parallel::thread_pool& pool) noexcept
+        -> void
+    {
+        using element_t = std::remove_cvref_t<decltype(z[0uz, 0uz])>;
+        if constexpr (std::same_as<element_t, value_type>)
+        {
+            permute_rows(z, n, pool, scratch_);
+        }
+        else
+        {
+            std::vector<element_t> scratch;
+            permute_rows(z, n, pool, scratch);
+        }
+    }
+
+    template <typename U>
+    auto permute_rows(
+        auto&                           z,
+        size_type                       n,
+        utility::parallel::thread_pool& pool,
+        std::vector<U>&                 scratch
+    ) noexcept -> void
+    {
+        const auto columns = z.size_x();
+        scratch.resize(n * columns);
+        pool.parallel_for(0, n, [&](size_type k) {
+            for (auto c = 0uz; c != columns; ++c)
+            {
+                scratch[k * columns + c] = z[order_[k], c];
+            }
+        });
+        pool.parallel_for(0, n, [&](size_type k) {
+            for (auto c = 0uz; c != columns; ++c)
+            {
+                z[k, c] = scratch[k * columns + c];
+            }
+        });
+    }
+
+private:
+    std::vector<key_type>                                keys_;
+    std::vector<size_type>                               order_;
+    std::vector<size_type>                               original_;
+    std::vector<size_type>                               row_of_;
+    std::vector<value_type>                              scratch_;
+    utility::parallel::radix_sorter<key_type, size_type> sorter_;
+    size_type                                            capacity_;
+    size_type                                            period_;
+    size_type                                            steps_{};
+    size_type                                            reorder_count_{};
+    curve                                                curve_;
+};
+
+} // namespace systems::reordering
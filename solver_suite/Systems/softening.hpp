@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cmath>
+#include <concepts>
+#include <numbers>
+
+namespace systems::softening
+{
+
+// Softening policies give the factor f(|r|) of the pairwise acceleration
+// a_i += r_ij * f(|r_ij|) from the squared distance. The call operators are
+// generic so that SIMD kernels can evaluate them on whole packs of distances,
+// sqrt being found by argument dependent lookup for simd types.
+
+template <typename S, typename F>
+concept SofteningPolicy = std::floating_point<F> && requires(S const s, F d_sq) {
+    { s(d_sq) } -> std::convertible_to<F>;
+};
+
+// Policies that also give the pair potential U(|r|), U' = |r| f(|r|) and
+// U(inf) = 0, used for energy diagnostics
+template <typename S, typename F>
+concept SofteningPolicyWithPotential =
+    SofteningPolicy<S, F> && requires(S const s, F d_sq) {
+        { s.potential(d_sq) } -> std::convertible_to<F>;
+    };
+
+// f = 1 / (|r|^3 + epsilon), the law used by the nbody examples
+template <std::floating_point F>
+struct cubic
+{
+    F epsilon{ static_cast<F>(4.5e-1) };
+
+    template <typename V>
+    [[nodiscard]]
+    inline auto operator()(V const& d_sq) const noexcept -> V
+    {
+        using std::sqrt;
+        const V d = sqrt(d_sq);
+        return V(F{ 1 }) / (d * d * d + V(epsilon));
+    }
+
+    // Integral of s / (s^3 + a^3), a^3 = epsilon, from infinity to |r|
+    template <typename V>
+    [[nodiscard]]
+    inline auto potential(V const& d_sq) const noexcept -> V
+    {
+        using std::atan;
+        using std::log;
+        using std::sqrt;
+        const auto a       = std::cbrt(epsilon);
+        const auto sqrt_3  = std::numbers::sqrt3_v<F>;
+        const auto shift   = std::numbers::pi_v<F> / (2 * a * sqrt_3);
+        const V    d       = sqrt(d_sq);
+        const V    d_p_a   = d + V(a);
+        const V    quad    = d_sq - V(a) * d + V(a * a);
+        const V    log_arg = quad / (d_p_a * d_p_a);
+        return log(log_arg) * V(1 / (6 * a)) +
+               atan((V(2) * d - V(a)) * V(1 / (a * sqrt_3))) * V(1 / (a * sqrt_3)) -
+               V(shift);
+    }
+};
+
+// f = 1 / (|r|^2 + epsilon^2)^(3/2)
+template <std::floating_point F>
+struct plummer
+{
+    F epsilon{ static_cast<F>(1e-2) };
+
+    template <typename V>
+    [[nodiscard]]
+    inline auto operator()(V const& d_sq) const noexcept -> V
+    {
+        using std::sqrt;
+        const V s = d_sq + V(epsilon * epsilon);
+        return V(F{ 1 }) / (s * sqrt(s));
+    }
+
+    template <typename V>
+    [[nodiscard]]
+    inline auto potential(V const& d_sq) const noexcept -> V
+    {
+        using std::sqrt;
+        return V(F{ -1 }) / sqrt(d_sq + V(epsilon * epsilon));
+    }
+};
+
+// f = 1 / |r|^3, coincident particles are the caller's problem
+template <std::floating_point F>
+struct none
+{
+    template <typename V>
+    [[nodiscard]]
+    inline auto operator()(V const& d_sq) const noexcept -> V
+    {
+        using std::sqrt;
+        return V(F{ 1 }) / (d_sq * sqrt(d_sq));
+    }
+
+    template <typename V>
+    [[nodiscard]]
+    inline auto potential(V const& d_sq) const noexcept -> V
+    {
+        using std::sqrt;
+        return V(F{ -1 }) / sqrt(d_sq);
+    }
+};
+
+} // namespace systems::softening
@@ -0,0 +1,128 @@
+#ifndef INCLUDED_UTILITY_EXECUTION_POLICY
+#define INCLUDED_UTILITY_EXECUTION_POLICY
+
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace utility::parallel
+{
+
+// How element wise loops over containers are run. Without a pool, or below
+// min_size elements, loops stay serial. Otherwise the range is cut in blocks of
+// grain_bytes and the blocks are split statically in one contiguous run per
+// thread, so every thread touches the same pages on every call: the first
+// assignment to a freshly allocated container places its pages next to the
+// threads that will keep using them (first touch), and no two threads share a
+// cache line.
+//
+// Within its run, every thread evaluates expressions in blocks of block_bytes of
+// each operand: cached subexpressions are written one block at a time, and with
+// prefetch_blocks > 0 the operands of the block that many blocks ahead are
+// prefetched, which keeps wide expressions fed where the hardware prefetchers
+// lose track of their many streams. With streaming_stores, assignments write
+// around the cache, for results that are not read again soon.
+struct execution_policy
+{
+    using size_type = std::size_t;
+
+    thread_pool* pool             = nullptr;
+    size_type    min_size         = size_type{ 1 } << 16;
+    size_type    grain_bytes      = size_type{ 4096 };
+    size_type    block_bytes      = size_type{ 16 } * 1024;
+    size_type    prefetch_blocks  = 0;
+    bool         streaming_stores = false;
+
+    [[nodiscard]]
+    constexpr auto parallel() const noexcept -> bool
+    {
+        return pool != nullptr && pool->size() > 1;
+    }
+};
+
+inline constexpr execution_policy seq{};
+
+[[nodiscard]]
+inline auto par(
+    thread_pool&                pool,
+    execution_policy::size_type min_size = execution_policy{}.min_size
+) noexcept -> execution_policy
+{
+    return { &pool, min_size };
+}
+
+// Policy used by the assignment and compound assignment operators of the
+// containers, sequential unless changed. Every thread has its own, so setting
+// it affects only the loops run by the calling thread and the workers of its
+// pool stay sequential inside the chunks they are handed. A pool runs one loop
+// at a time: it must not be shared by the defaults of several threads that
+// assign concurrently, nor be used from inside its own tasks.
+[[nodiscard]]
+inline auto default_execution_policy() noexcept -> execution_policy&
+{
+    thread_local execution_policy policy{};
+    return policy;
+}
+
+// Calls fn(begin, end) over contiguous sub-ranges covering [0, n), in parallel
+// as described by the policy. Value_Type sets the block size in elements.
+template <typename Value_Type>
+inline auto for_each_chunk(
+    execution_policy const&     policy,
+    execution_policy::size_type n,
+    auto&&                      fn
+) noexcept -> void
+{
+    using size_type = execution_policy::size_type;
+    if (!policy.parallel() || n < policy.min_size)
+    {
+        fn(size_type{ 0 }, n);
+        return;
+    }
+    const auto grain  = std::max(policy.grain_bytes / sizeof(Value_Type), size_type{ 1 });
+    const auto blocks = (n + grain - 1) / grain;
+    policy.pool->parallel_for_chunks(
+        0, blocks, [&fn, grain, n](size_type b, size_type e, size_type) {
+            fn(b * grain, std::min(e * grain, n));
+        }
+    );
+}
+
+// Folds fn(begin, end) -> T over the sub-ranges of for_each_chunk. The partial
+// results are merged with combine in thread order, so for a given thread count
+// the result does not depend on scheduling.
+template <typename Value_Type, typename T>
+inline auto reduce_chunks(
+    execution_policy const&     policy,
+    execution_policy::size_type n,
+    T const&                    identity,
+    auto&&                      fn,
+    auto&&                      combine
+) noexcept -> T
+{
+    using size_type = execution_policy::size_type;
+    if (!policy.parallel() || n < policy.min_size)
+    {
+        return fn(size_type{ 0 }, n);
+    }
+    const auto grain  = std::max(policy.grain_bytes / sizeof(Value_Type), size_type{ 1 });
+    const auto blocks = (n + grain - 1) / grain;
+
+    std::vector<T> partials(policy.pool->size(), identity);
+    policy.pool->parallel_for_chunks(
+        0, blocks, [&fn, &partials, grain, n](size_type b, size_type e, size_type w) {
+            partials[w] = fn(b * grain, std::min(e * grain, n));
+        }
+    );
+    T ret = identity;
+    for (auto const& partial : partials)
+    {
+        ret = combine(ret, partial);
+    }
+    return ret;
+}
+
+} // namespace utility::parallel
+
+#endif // INCLUDED_UTILITY_EXECUTION_POLICY
@@ -0,0 +1,244 @@
+#ifndef INCLUDED_UTILITY_FFT
+#define INCLUDED_UTILITY_FFT
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <concepts>
+#include <cstddef>
+#include <numbers>
+#include <vector>
+
+namespace utility::fft
+{
+
+// Complex FFT of a fixed length, any length is supported. The length is
+// factorized into radix 4 and 2 passes first and then odd prime factors, every
+// pass being a self sorting Stockham step (no bit reversal). Lengths with a large
+// prime factor p degrade towards O(n p). A plan owns its scratch space, so a
+// single plan must not be used by several threads at once.
+template <std::floating_point F>
+class plan
+{
+public:
+    using value_type   = F;
+    using complex_type = std::complex<F>;
+    using size_type    = std::size_t;
+
+    explicit plan(size_type n) noexcept
+        : n_{ n }
+        , roots_(n)
+        , scratch_(n)
+        , line_(n)
+    {
+        assert(n > 0);
+        for (auto t = 0uz; t != n; ++t)
+        {
+            const auto angle = -2 * std::numbers::pi_v<value_type> *
+                               static_cast<value_type>(t) / static_cast<value_type>(n);
+            roots_[t] = { std::cos(angle), std::sin(angle) };
+        }
+
+        auto rest = n;
+        while (rest % 4 == 0)
+        {
+            factors_.push_back(4);
+            rest /= 4;
+        }
+        while (rest % 2 == 0)
+        {
+            factors_.push_back(2);
+            rest /= 2;
+        }
+        for (auto p = 3uz; p * p <= rest; p += 2)
+        {
+            while (rest % p == 0)
+            {
+                factors_.push_back(p);
+                rest /= p;
+            }
+        }
+        if (rest > 1)
+        {
+            factors_.push_back(rest);
+        }
+        terms_.resize(factors_.empty() ? 1 : std::ranges::max(factors_));
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> size_type
+    {
+        return n_;
+    }
+
+    // Unnormalized forward transform, X_k = sum_t x_t exp(-2 pi i t k / n), of the
+    // n elements data[0], data[stride], ...
+    auto forward(complex_type* data, size_type stride = 1) noexcept -> void
+    {
+        if (stride == 1)
+        {
+            transform(data);
+            return;
+        }
+        for (auto t = 0uz; t != n_; ++t)
+        {
+            line_[t] = data[t * stride];
+        }
+        transform(line_.data());
+        for (auto t = 0uz; t != n_; ++t)
+        {
+            data[t * stride] = line_[t];
+        }
+    }
+
+    // Inverse transform normalized by 1 / n, inverse(forward(x)) == x
+    auto inverse(complex_type* data, size_type stride = 1) noexcept -> void
+    {
+        const auto scale = value_type{ 1 } / static_cast<value_type>(n_);
+        for (auto t = 0uz; t != n_; ++t)
+        {
+            line_[t] = std::conj(data[t * stride]);
+        }
+        transform(line_.data());
+        for (auto t = 0uz; t != n_; ++t)
+        {
+            data[t * stride] = std::conj(line_[t]) * scale;
+        }
+    }
+
+private:
+    auto transform(complex_type* x) noexcept -> void
+    {
+        complex_type* src    = x;
+        complex_type* dst    = scratch_.data();
+        auto          length = n_;
+        auto          s      = 1uz;
+        for (const auto r : factors_)
+        {
+            const auto m           = length / r;
+            const auto root_stride = n_ / length;
+            switch (r)
+            {
+            case 2: radix_2_pass(src, dst, m, s, root_stride); break;
+            case 4: radix_4_pass(src, dst, m, s, root_stride); break;
+            default: generic_pass(src, dst, r, m, s, root_stride); break;
+            }
+            std::swap(src, dst);
+            length = m;
+            s *= r;
+        }
+        if (src != x)
+        {
+            std::copy(src, src + n_, x);
+        }
+    }
+
+    // Twiddle w_length^(p k), length = n / root_stride
+    [[nodiscard]]
+    auto twiddle(size_type p, size_type k, size_type root_stride) const noexcept
+        -> complex_type
+    {
+        return roots_[(p * k * root_stride) % n_];
+    }
+
+    auto radix_2_pass(
+        complex_type const* src,
+        complex_type*       dst,
+        size_type           m,
+        size_type           s,
+        size_type           root_stride
+    ) const noexcept -> void
+    {
+        for (auto p = 0uz; p != m; ++p)
+        {
+            const auto w1 = twiddle(p, 1, root_stride);
+            for (auto q = 0uz; q != s; ++q)
+            {
+                const auto a = src[q + s * p];
+                const auto b = src[q + s * (p + m)];
+                dst[q + s * (2 * p)]     = a + b;
+                dst[q + s * (2 * p + 1)] = (a - b) * w1;
+            }
+        }
+    }
+
+    auto radix_4_pass(
+        complex_type const* src,
+        complex_type*       dst,
+        size_type           m,
+        size_type           s,
+        size_type           root_stride
+    ) const noexcept -> void
+    {
+        // (x, y) * -i == (y, -x)
+        const auto rotate = [](complex_type const& z) {
+            return complex_type{ z.imag(), -z.real() };
+        };
+        for (auto p = 0uz; p != m; ++p)
+        {
+            const auto w1 = twiddle(p, 1, root_stride);
+            const auto w2 = twiddle(p, 2, root_stride);
+            const auto w3 = twiddle(p, 3, root_stride);
+            for (auto q = 0uz; q != s; ++q)
+            {
+                const auto a0 = src[q + s * p];
+                const auto a1 = src[q + s * (p + m)];
+                const auto a2 = src[q + s * (p + 2 * m)];
+                const auto a3 = src[q + s * (p + 3 * m)];
+                const auto t0 = a0 + a2;
+                const auto t1 = a0 - a2;
+                const auto t2 = a1 + a3;
+                const auto t3 = rotate(a1 - a3);
+                dst[q + s * (4 * p)]     = t0 + t2;
+                dst[q + s * (4 * p + 1)] = (t1 + t3) * w1;
+                dst[q + s * (4 * p + 2)] = (t0 - t2) * w2;
+                dst[q + s * (4 * p + 3)] = (t1 - t3) * w3;
+            }
+        }
+    }
+
+    auto generic_pass(
+        complex_type const* src,
+        complex_type*       dst,
+        size_type           r,
+        size_type           m,
+        size_type           s,
+        size_type           root_stride
+    ) noexcept -> void
+    {
+        // w_r^(j k) == roots_[(j k mod r) * n / r]
+        const auto inner_stride = n_ / r;
+        for (auto p = 0uz; p != m; ++p)
+        {
+            for (auto q = 0uz; q != s; ++q)
+            {
+                for (auto j = 0uz; j != r; ++j)
+                {
+                    terms_[j] = src[q + s * (p + j * m)];
+                }
+                for (auto k = 0uz; k != r; ++k)
+                {
+                    complex_type acc = terms_[0];
+                    for (auto j = 1uz; j != r; ++j)
+                    {
+                        acc += terms_[j] * roots_[((j * k) % r) * inner_stride];
+                    }
+                    dst[q + s * (r * p + k)] = acc * twiddle(p, k, root_stride);
+                }
+            }
+        }
+    }
+
+private:
+    size_type                 n_;
+    std::vector<complex_type> roots_;
+    std::vector<complex_type> scratch_;
+    std::vector<complex_type> line_;
+    std::vector<complex_type> terms_;
+    std::vector<size_type>    factors_;
+};
+
+} // namespace utility::fft
+
+#endif // INCLUDED_UTILITY_FFT
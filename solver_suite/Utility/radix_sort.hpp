@@ -0,0 +1,135 @@
+#ifndef INCLUDED_UTILITY_RADIX_SORT
+#define INCLUDED_UTILITY_RADIX_SORT
+
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <vector>
+
+namespace utility::parallel
+{
+
+// Stable least significant digit radix sort of (key, value) pairs held in two
+// parallel arrays, one byte per pass. Every pass splits the input in one
+// contiguous chunk per thread: the threads histogram their chunk, the
+// histograms are scanned into per thread write cursors and the threads scatter
+// their chunk, so the result does not depend on the thread count. Passes whose
+// byte is the same for every key are skipped. The sorter owns the scratch
+// arrays, so a single sorter must not be used by several threads at once.
+template <std::unsigned_integral Key, typename Value>
+class radix_sorter
+{
+public:
+    using key_type   = Key;
+    using value_type = Value;
+    using size_type  = std::size_t;
+
+    inline static constexpr auto s_radix_bits = 8uz;
+    inline static constexpr auto s_radix      = 1uz << s_radix_bits;
+
+private:
+    using histogram_t = std::array<size_type, s_radix>;
+
+public:
+    explicit radix_sorter(size_type capacity) noexcept
+        : key_scratch_(capacity)
+        , value_scratch_(capacity)
+    {
+    }
+
+    // Sorts keys[0, n) ascending, applying the same permutation to values[0, n).
+    // Only the low key_bits bits of the keys are looked at.
+    auto sort(
+        thread_pool& pool,
+        key_type*    keys,
+        value_type*  values,
+        size_type    n,
+        size_type    key_bits = sizeof(key_type) * 8
+    ) noexcept -> void
+    {
+        assert(n <= key_scratch_.size());
+        assert(key_bits <= sizeof(key_type) * 8);
+        if (n < 2)
+        {
+            return;
+        }
+        const auto chunks = std::min(pool.size(), n);
+        histograms_.resize(chunks);
+
+        key_type*   src_keys   = keys;
+        value_type* src_values = values;
+        key_type*   dst_keys   = key_scratch_.data();
+        value_type* dst_values = value_scratch_.data();
+        for (auto shift = 0uz; shift < key_bits; shift += s_radix_bits)
+        {
+            const auto digit = [shift](key_type key) {
+                return static_cast<size_type>((key >> shift) & (s_radix - 1));
+            };
+            pool.parallel_for(0, chunks, [&](size_type c) {
+                auto& histogram = histograms_[c];
+                histogram.fill(0);
+                for (auto i = n * c / chunks; i != n * (c + 1) / chunks; ++i)
+                {
+                    ++histogram[digit(src_keys[i])];
+                }
+            });
+            if (std::ranges::any_of(totals(chunks), [n](size_type t) { return t == n; }))
+            {
+                continue;
+            }
+            auto offset = 0uz;
+            for (auto d = 0uz; d != s_radix; ++d)
+            {
+                for (auto c = 0uz; c != chunks; ++c)
+                {
+                    const auto count   = histograms_[c][d];
+                    histograms_[c][d]  = offset;
+                    offset            += count;
+                }
+            }
+            pool.parallel_for(0, chunks, [&](size_type c) {
+                auto& cursor = histograms_[c];
+                for (auto i = n * c / chunks; i != n * (c + 1) / chunks; ++i)
+                {
+                    const auto k  = cursor[digit(src_keys[i])]++;
+                    dst_keys[k]   = src_keys[i];
+                    dst_values[k] = src_values[i];
+                }
+            });
+            std::swap(src_keys, dst_keys);
+            std::swap(src_values, dst_values);
+        }
+        if (src_keys != keys)
+        {
+            std::copy(src_keys, src_keys + n, keys);
+            std::copy(src_values, src_values + n, values);
+        }
+    }
+
+private:
+    [[nodiscard]]
+    auto totals(size_type chunks) const noexcept -> histogram_t
+    {
+        histogram_t ret{};
+        for (auto c = 0uz; c != chunks; ++c)
+        {
+            for (auto d = 0uz; d != s_radix; ++d)
+            {
+                ret[d] += histograms_[c][d];
+            }
+        }
+        return ret;
+    }
+
+private:
+    std::vector<key_type>    key_scratch_;
+    std::vector<value_type>  value_scratch_;
+    std::vector<histogram_t> histograms_;
+};
+
+} // namespace utility::parallel
+
+#endif // INCLUDED_UTILITY_RADIX_SORT
@@ -0,0 +1,156 @@
+#ifndef INCLUDED_UTILITY_SPACE_FILLING_CURVES
+#define INCLUDED_UTILITY_SPACE_FILLING_CURVES
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace utility::space_filling_curves
+{
+
+using key_type = std::uint64_t;
+
+// Bits per dimension such that the interleaved key fits in a key_type
+template <std::size_t N>
+    requires(N > 0)
+inline constexpr std::size_t s_bits_per_dimension = std::min(63uz / N, 32uz);
+
+template <std::size_t N>
+using grid_coordinates = std::array<std::uint32_t, N>;
+
+// Maps value from [min, min + extent] to an integer in [0, 2^bits). The last
+// cell is clamped to as an integer, cells - 1 is not representable in float
+template <std::size_t N, std::floating_point F>
+[[nodiscard]]
+constexpr auto quantize(F value, F min, F inverse_extent) noexcept -> std::uint32_t
+{
+    constexpr auto cells  = key_type{ 1 } << s_bits_per_dimension<N>;
+    const auto     scaled = std::clamp(
+        (value - min) * inverse_extent * static_cast<F>(cells),
+        F{ 0 },
+        static_cast<F>(cells)
+    );
+    return static_cast<std::uint32_t>(std::min(static_cast<key_type>(scaled), cells - 1));
+}
+
+namespace detail
+{
+
+[[nodiscard, gnu::const]]
+constexpr auto spread_bits_2(key_type x) noexcept -> key_type
+{
+    x &= 0x00000000ffffffff;
+    x = (x | (x << 16)) & 0x0000ffff0000ffff;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ff;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0f;
+    x = (x | (x << 2)) & 0x3333333333333333;
+    x = (x | (x << 1)) & 0x5555555555555555;
+    return x;
+}
+
+[[nodiscard, gnu::const]]
+constexpr auto spread_bits_3(key_type x) noexcept -> key_type
+{
+    x &= 0x00000000001fffff;
+    x = (x | (x << 32)) & 0x001f00000000ffff;
+    x = (x | (x << 16)) & 0x001f0000ff0000ff;
+    x = (x | (x << 8)) & 0x100f00f00f00f00f;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3;
+    x = (x | (x << 2)) & 0x1249249249249249;
+    return x;
+}
+
+} // namespace detail
+
+// Interleaves the bits of the coordinates, bit b of dimension d ends up in bit
+// b * N + d of the key
+template <std::size_t N>
+[[nodiscard]]
+constexpr auto morton_encode(grid_coordinates<N> const& coords) noexcept -> key_type
+{
+    if constexpr (N == 2)
+    {
+        return detail::spread_bits_2(coords[0]) | (detail::spread_bits_2(coords[1]) << 1);
+    }
+    else if constexpr (N == 3)
+    {
+        return detail::spread_bits_3(coords[0]) | (detail::spread_bits_3(coords[1]) << 1) |
+               (detail::spread_bits_3(coords[2]) << 2);
+    }
+    else
+    {
+        key_type key{};
+        for (auto b = 0uz; b != s_bits_per_dimension<N>; ++b)
+        {
+            for (auto d = 0uz; d != N; ++d)
+            {
+                key |= static_cast<key_type>((coords[d] >> b) & 1u) << (b * N + d);
+            }
+        }
+        return key;
+    }
+}
+
+// Position along the Hilbert curve, keys of cells adjacent along the curve
+// differ by one. Uses Skilling's transform ("Programming the Hilbert curve",
+// 2004) to the transposed index, whose bits are then interleaved with the most
+// significant dimension first.
+template <std::size_t N>
+[[nodiscard]]
+constexpr auto hilbert_encode(grid_coordinates<N> coords) noexcept -> key_type
+{
+    constexpr auto top = std::uint32_t{ 1 } << (s_bits_per_dimension<N> - 1);
+    for (auto q = top; q > 1; q >>= 1)
+    {
+        const auto p = q - 1;
+        for (auto d = 0uz; d != N; ++d)
+        {
+            if (coords[d] & q)
+            {
+                coords[0] ^= p;
+            }
+            else
+            {
+                const auto t = (coords[0] ^ coords[d]) & p;
+                coords[0] ^= t;
+                coords[d] ^= t;
+            }
+        }
+    }
+    for (auto d = 1uz; d != N; ++d)
+    {
+        coords[d] ^= coords[d - 1];
+    }
+    std::uint32_t t{};
+    for (auto q = top; q > 1; q >>= 1)
+    {
+        if (coords[N - 1] & q)
+        {
+            t ^= q - 1;
+        }
+    }
+    grid_coordinates<N> transposed{};
+    for (auto d = 0uz; d != N; ++d)
+    {
+        transposed[N - 1 - d] = coords[d] ^ t;
+    }
+    return morton_encode<N>(transposed);
+}
+
+// Child index (one bit per dimension) of the cell containing key at the given
+// depth, depth 0 being the children of the root cell
+template <std::size_t N>
+[[nodiscard]]
+constexpr auto morton_digit(key_type key, std::size_t depth) noexcept -> std::size_t
+{
+    assert(depth < s_bits_per_dimension<N>);
+    const auto shift = (s_bits_per_dimension<N> - 1 - depth) * N;
+    return static_cast<std::size_t>((key >> shift) & ((key_type{ 1 } << N) - 1));
+}
+
+} // namespace utility::space_filling_curves
+
+#endif // INCLUDED_UTILITY_SPACE_FILLING_CURVES
@@ -0,0 +1,174 @@
+#ifndef INCLUDED_UTILITY_THREAD_POOL
+#define INCLUDED_UTILITY_THREAD_POOL
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace utility::parallel
+{
+
+// Persistent pool of worker threads for fork-join loops. parallel_for splits the
+// range statically in one contiguous chunk per thread, the calling thread runs
+// the first chunk and returns once every chunk is done. Tasks are not
+// allocated, the callable is passed to the workers by address, so the pool runs
+// one loop at a time: it is not reentrant (a task must not call back into its
+// pool) and must not be used by several threads at once, which asserts.
+class thread_pool
+{
+public:
+    using size_type = std::size_t;
+
+    explicit thread_pool(
+        size_type thread_count = std::max(std::thread::hardware_concurrency(), 1u)
+    ) noexcept
+    {
+        assert(thread_count > 0);
+        workers_.reserve(thread_count - 1);
+        for (auto w = 1uz; w != thread_count; ++w)
+        {
+            workers_.emplace_back([this, w] { worker_loop(w); });
+        }
+    }
+
+    thread_pool(thread_pool const&)                    = delete;
+    auto operator=(thread_pool const&) -> thread_pool& = delete;
+
+    ~thread_pool() noexcept
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+        for (auto& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> size_type
+    {
+        return workers_.size() + 1;
+    }
+
+    // Calls fn(i) for every i in [begin, end)
+    auto parallel_for(size_type begin, size_type end, auto&& fn) noexcept -> void
+    {
+        parallel_for_chunks(begin, end, [&fn](size_type b, size_type e, size_type) {
+            for (auto i = b; i != e; ++i)
+            {
+                fn(i);
+            }
+        });
+    }
+
+    // Calls fn(chunk_begin, chunk_end, thread_index) once per thread with a non
+    // empty chunk. The thread index is in [0, size()) and can be used to address
+    // per thread scratch storage.
+    auto parallel_for_chunks(size_type begin, size_type end, auto&& fn) noexcept -> void
+    {
+        assert(begin <= end);
+        const auto count = end - begin;
+        if (count == 0) [[unlikely]]
+        {
+            return;
+        }
+        if (workers_.empty() || count == 1)
+        {
+            fn(begin, end, 0uz);
+            return;
+        }
+
+        [[maybe_unused]] const auto was_busy = busy_.exchange(true);
+        assert(!was_busy);
+
+        using fn_t = std::remove_reference_t<decltype(fn)>;
+        {
+            std::lock_guard lock(mutex_);
+            task_ = task{ [](void* ctx, size_type b, size_type e, size_type w) {
+                             (*static_cast<fn_t*>(ctx))(b, e, w);
+                         },
+                          const_cast<void*>(static_cast<void const*>(&fn)),
+                          begin,
+                          end };
+            pending_ = workers_.size();
+            ++generation_;
+        }
+        start_cv_.notify_all();
+        run_chunk(task_, 0);
+        std::unique_lock lock(mutex_);
+        done_cv_.wait(lock, [this] { return pending_ == 0; });
+        busy_.store(false);
+    }
+
+private:
+    struct task
+    {
+        void (*invoke)(void*, size_type, size_type, size_type);
+        void*     context;
+        size_type begin;
+        size_type end;
+    };
+
+    auto run_chunk(task const& t, size_type w) const noexcept -> void
+    {
+        const auto threads = size();
+        const auto count   = t.end - t.begin;
+        const auto b       = t.begin + count * w / threads;
+        const auto e       = t.begin + count * (w + 1) / threads;
+        if (b != e)
+        {
+            t.invoke(t.context, b, e, w);
+        }
+    }
+
+    auto worker_loop(size_type w) noexcept -> void
+    {
+        auto seen = 0uz;
+        while (true)
+        {
+            task t{};
+            {
+                std::unique_lock lock(mutex_);
+                start_cv_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+                if (stop_)
+                {
+                    return;
+                }
+                seen = generation_;
+                t    = task_;
+            }
+            run_chunk(t, w);
+            {
+                std::lock_guard lock(mutex_);
+                if (--pending_ == 0)
+                {
+                    done_cv_.notify_one();
+                }
+            }
+        }
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex               mutex_;
+    std::condition_variable  start_cv_;
+    std::condition_variable  done_cv_;
+    task                     task_{};
+    size_type                generation_{};
+    size_type                pending_{};
+    std::atomic<bool>        busy_{};
+    bool                     stop_{};
+};
+
+} // namespace utility::parallel
+
+#endif // INCLUDED_UTILITY_THREAD_POOL
@@ -0,0 +1,566 @@
+#include "barnes_hut.hpp"
+#include "buffer_config.hpp"
+#include "data_buffer.hpp"
+#include "fast_multipole.hpp"
+#include "nbody.hpp"
+#include "neighbor_list.hpp"
+#include "pairwise_kernels.hpp"
+#include "particle_mesh.hpp"
+#include "particle_reordering.hpp"
+#include "radix_sort.hpp"
+#include "random.hpp"
+#include "softening.hpp"
+#include "space_filling_curves.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+template <
+    typename F,
+    std::size_t                             Size_Y,
+    std::size_t                             Size_X,
+    data_types::buffer_config::LayoutPolicy Layout_Policy =
+        data_types::buffer_config::LayoutPolicy::layout_row_major>
+using buffer_t = data_types::lazily_evaluated_containers::static_buffer<
+    F,
+    Size_Y,
+    Size_X,
+    Layout_Policy,
+    data_types::buffer_config::layout_stride{ 0 }>;
+
+// Positions uniform in [-1, 1)^N, velocities zero
+template <std::size_t N, typename Buffer>
+auto fill_positions(Buffer& z, unsigned int seed) -> void
+{
+    using F = typename Buffer::value_type;
+    utility::random::srandom::seed<F>(seed);
+    for (auto i = 0uz; i != z.size_y(); ++i)
+    {
+        for (auto d = 0uz; d != N; ++d)
+        {
+            z[i, d]     = utility::random::srandom::randrange(F{ -1 }, F{ 1 });
+            z[i, d + N] = F{ 0 };
+        }
+    }
+}
+
+// Softened accelerations r / (|r|^3 + epsilon) of the first n rows of z by
+// direct summation, in double
+template <std::size_t N>
+auto direct_accelerations(auto const& z, std::size_t n, double epsilon)
+    -> std::vector<std::array<double, N>>
+{
+    std::vector<std::array<double, N>> acc(n);
+    for (auto i = 0uz; i != n; ++i)
+    {
+        for (auto j = 0uz; j != n; ++j)
+        {
+            if (j == i) continue;
+            std::array<double, N> r{};
+            auto                  d_sq = 0.;
+            for (auto d = 0uz; d != N; ++d)
+            {
+                r[d]  = static_cast<double>(z[j, d]) - static_cast<double>(z[i, d]);
+                d_sq += r[d] * r[d];
+            }
+            const auto dist   = std::sqrt(d_sq);
+            const auto factor = 1. / (dist * dist * dist + epsilon);
+            for (auto d = 0uz; d != N; ++d)
+            {
+                acc[i][d] += r[d] * factor;
+            }
+        }
+    }
+    return acc;
+}
+
+// Largest error of the accelerations in columns [N, 2N) of dzdt relative to
+// the largest reference component
+template <std::size_t N>
+auto relative_error(auto const& dzdt, std::vector<std::array<double, N>> const& ref)
+    -> double
+{
+    auto scale = 0.;
+    auto error = 0.;
+    for (auto i = 0uz; i != ref.size(); ++i)
+    {
+        for (auto d = 0uz; d != N; ++d)
+        {
+            scale = std::max(scale, std::abs(ref[i][d]));
+            error = std::max(
+                error, std::abs(static_cast<double>(dzdt[i, d + N]) - ref[i][d])
+            );
+        }
+    }
+    return error / scale;
+}
+
+template <typename F, std::size_t N>
+auto barnes_hut_matches_direct_summation() -> void
+{
+    constexpr auto n       = 300uz;
+    const auto     epsilon = static_cast<F>(0.01);
+    auto           z       = std::make_unique<buffer_t<F, n, 2 * N>>();
+    auto           dzdt    = std::make_unique<buffer_t<F, n, 2 * N>>();
+    fill_positions<N>(*z, 104845342u);
+    const auto ref = direct_accelerations<N>(*z, n, static_cast<double>(epsilon));
+
+    // Opening every cell sums over every particle, so only rounding is left.
+    // The particles on the upper faces of the bounding box quantize to the
+    // last cell and must still be found by the traversal
+    systems::barnes_hut::nbody_system<F, N> exact(n, F{ 0 }, epsilon);
+    exact(*z, *dzdt, F{ 0 });
+    EXPECT_LT(relative_error<N>(*dzdt, ref), 1e-4);
+
+    systems::barnes_hut::nbody_system<F, N> approximate(n, F{ 0.5 }, epsilon);
+    approximate(*z, *dzdt, F{ 0 });
+    EXPECT_LT(relative_error<N>(*dzdt, ref), 5e-2);
+}
+
+template <typename F, std::size_t N>
+auto fast_multipole_matches_direct_summation() -> void
+{
+    constexpr auto n = 1000uz;
+    // The far field is not softened, so the reference is barely softened
+    const auto epsilon = static_cast<F>(1e-6);
+    auto       z       = std::make_unique<buffer_t<F, n, 2 * N>>();
+    auto       dzdt    = std::make_unique<buffer_t<F, n, 2 * N>>();
+    fill_positions<N>(*z, 104845342u);
+    const auto ref = direct_accelerations<N>(*z, n, static_cast<double>(epsilon));
+
+    // Sparse leaves leave empty cells in the interaction lists
+    systems::fast_multipole::nbody_system<F, N, 4> coarse(n, 8, epsilon, 4);
+    coarse(*z, *dzdt, F{ 0 });
+    const auto coarse_error = relative_error<N>(*dzdt, ref);
+    EXPECT_LT(coarse_error, 1e-2);
+
+    // Higher orders shrink the truncation error of the far field
+    systems::fast_multipole::nbody_system<F, N, 6> fine(n, 8, epsilon, 4);
+    fine(*z, *dzdt, F{ 0 });
+    EXPECT_LT(relative_error<N>(*dzdt, ref), coarse_error / 2);
+}
+
+// Accelerations of a kernel, acceleration(i) indexed in the order of the rows
+template <std::size_t N>
+auto relative_error(auto const& kernel, std::vector<std::array<double, N>> const& ref)
+    -> double
+    requires requires { kernel.acceleration(0uz); }
+{
+    auto scale = 0.;
+    auto error = 0.;
+    for (auto i = 0uz; i != ref.size(); ++i)
+    {
+        const auto acc = kernel.acceleration(i);
+        for (auto d = 0uz; d != N; ++d)
+        {
+            scale = std::max(scale, std::abs(ref[i][d]));
+            error = std::max(error, std::abs(static_cast<double>(acc[d]) - ref[i][d]));
+        }
+    }
+    return error / scale;
+}
+
+// tiled_kernel over a state laid out as Layout_Policy against direct summation,
+// n not being a multiple of the pack size so that the scalar tail is covered
+template <data_types::buffer_config::LayoutPolicy Layout_Policy>
+auto tiled_kernel_matches_direct_summation() -> void
+{
+    using F                  = double;
+    constexpr auto N         = 3uz;
+    constexpr auto n         = 203uz;
+    const auto     softening = systems::softening::cubic<F>{ F{ 0.01 } };
+    auto           z         = std::make_unique<buffer_t<F, n, 2 * N, Layout_Policy>>();
+    fill_positions<N>(*z, 104845342u);
+
+    systems::pairwise::tiled_kernel<F, N> tiled(n);
+    tiled.evaluate(*z, n, softening);
+    EXPECT_LT(relative_error<N>(tiled, direct_accelerations<N>(*z, n, 0.01)), 1e-12);
+
+    // Every pair once, as the symmetric kernel sums them
+    systems::pairwise::symmetric_kernel<F, N> symmetric(n);
+    const auto expected = symmetric.evaluate_with_potential(*z, n, softening);
+    EXPECT_NEAR(
+        tiled.evaluate_with_potential(*z, n, softening),
+        expected,
+        1e-12 * std::abs(expected)
+    );
+}
+
+// Derivative written by nbody_system with a force backend against direct
+// summation, returns the potential energy it measures
+template <systems::nbody::force_backend Backend>
+auto nbody_backend_matches_direct_summation() -> double
+{
+    using F          = double;
+    constexpr auto N = 3uz;
+    constexpr auto n = 203uz;
+    using system_t   = systems::nbody::nbody_system<
+          F,
+          N,
+          systems::nbody::state_layout::buffer,
+          systems::softening::cubic<F>,
+          Backend>;
+    auto z    = std::make_unique<buffer_t<F, n, 2 * N>>();
+    auto dzdt = std::make_unique<buffer_t<F, n, 2 * N>>();
+    fill_positions<N>(*z, 104845342u);
+    for (auto i = 0uz; i != n; ++i)
+    {
+        (*z)[i, N] = static_cast<F>(i);
+    }
+
+    system_t s(n, { F{ 0.01 } }, 3);
+    s(*z, *dzdt, F{ 0 });
+    EXPECT_LT(relative_error<N>(*dzdt, direct_accelerations<N>(*z, n, 0.01)), 1e-12);
+    for (auto i = 0uz; i != n; ++i)
+    {
+        EXPECT_EQ(((*dzdt)[i, 0]), static_cast<F>(i));
+    }
+    return s.measure(*z).potential_energy;
+}
+
+// Indices j != i of the first n rows of z closer than radius to row i
+template <std::size_t N>
+auto brute_force_neighbors(auto const& z, std::size_t n, std::size_t i, double radius)
+    -> std::set<std::size_t>
+{
+    std::set<std::size_t> ret;
+    for (auto j = 0uz; j != n; ++j)
+    {
+        auto d_sq = 0.;
+        for (auto d = 0uz; d != N; ++d)
+        {
+            const auto r = static_cast<double>(z[j, d]) - static_cast<double>(z[i, d]);
+            d_sq += r * r;
+        }
+        if (j != i && d_sq < radius * radius)
+        {
+            ret.insert(j);
+        }
+    }
+    return ret;
+}
+
+} // namespace
+
+TEST(BarnesHut, DirectSummationFloat2D)
+{
+    barnes_hut_matches_direct_summation<float, 2>();
+}
+
+TEST(BarnesHut, DirectSummationFloat3D)
+{
+    barnes_hut_matches_direct_summation<float, 3>();
+}
+
+TEST(BarnesHut, QuantizeUpperBound)
+{
+    namespace sfc = utility::space_filling_curves;
+    EXPECT_EQ(sfc::quantize<1>(1.f, 0.f, 1.f), 0xffffffffu);
+    EXPECT_EQ(sfc::quantize<2>(1.f, 0.f, 1.f), 0x7fffffffu);
+    EXPECT_EQ(sfc::quantize<3>(1.f, 0.f, 1.f), 0x001fffffu);
+    EXPECT_EQ(sfc::quantize<2>(2.f, 0.f, 1.f), 0x7fffffffu);
+    EXPECT_EQ(sfc::quantize<2>(-1.f, 0.f, 1.f), 0u);
+    EXPECT_EQ(sfc::quantize<2>(1., 0., 1.), 0x7fffffffu);
+}
+
+TEST(FastMultipole, DirectSummation2D)
+{
+    fast_multipole_matches_direct_summation<double, 2>();
+}
+
+TEST(FastMultipole, DirectSummation3D)
+{
+    fast_multipole_matches_direct_summation<double, 3>();
+}
+
+TEST(ParticleMesh, DirectSummationPair)
+{
+    // Two particles 6 cells apart, far from their periodic images, attract as
+    // the 1 / r^2 law within the smoothing of the mesh
+    using F                 = double;
+    constexpr auto box      = F{ 32 };
+    constexpr auto distance = F{ 6 };
+    auto           z        = std::make_unique<buffer_t<F, 2, 6>>();
+    auto           dzdt     = std::make_unique<buffer_t<F, 2, 6>>();
+    const auto     first    = std::array{ F{ 10.3 }, F{ 12.7 }, F{ 15.1 } };
+    for (auto d = 0uz; d != 3; ++d)
+    {
+        (*z)[0, d]     = first[d];
+        (*z)[1, d]     = first[d] + (d == 0 ? distance : F{ 0 });
+        (*z)[0, d + 3] = F{ 0 };
+        (*z)[1, d + 3] = F{ 0 };
+    }
+
+    systems::particle_mesh::nbody_system<F, 3> s(2, box, 32);
+    s(*z, *dzdt, F{ 0 });
+    const auto direct = 1 / (distance * distance);
+    EXPECT_NEAR(((*dzdt)[0, 3]), direct, 0.03 * direct);
+    EXPECT_NEAR(((*dzdt)[1, 3]), (-(*dzdt)[0, 3]), 1e-12);
+    for (auto d = 4uz; d != 6; ++d)
+    {
+        EXPECT_NEAR(((*dzdt)[0, d]), F{ 0 }, 1e-12);
+        EXPECT_NEAR(((*dzdt)[1, d]), F{ 0 }, 1e-12);
+    }
+}
+
+TEST(NeighborList, BruteForcePairs)
+{
+    using F               = double;
+    constexpr auto N      = 3uz;
+    constexpr auto n      = 400uz;
+    const auto     cutoff = F{ 0.3 };
+    const auto     skin   = F{ 0.1 };
+    auto           z      = std::make_unique<buffer_t<F, n, 2 * N>>();
+    fill_positions<N>(*z, 104845342u);
+
+    systems::neighbor_list::verlet_list<F, N> list(n, cutoff, skin);
+    EXPECT_TRUE(list.update(*z, n));
+    auto pairs = 0uz;
+    for (auto i = 0uz; i != n; ++i)
+    {
+        const auto neighbors = list.neighbors(i);
+        const auto listed    = std::set<std::size_t>(neighbors.begin(), neighbors.end());
+        EXPECT_EQ(listed.size(), neighbors.size());
+        EXPECT_EQ(listed, brute_force_neighbors<N>(*z, n, i, cutoff + skin));
+        pairs += neighbors.size();
+    }
+    EXPECT_EQ(list.pair_count(), pairs);
+
+    // Moves below half the skin keep the lists, which still hold every pair
+    // within the cutoff
+    for (auto i = 0uz; i != n; ++i)
+    {
+        (*z)[i, i % N] += (i % 2 == 0 ? F{ 1 } : F{ -1 }) * skin * F{ 0.4 };
+    }
+    EXPECT_FALSE(list.update(*z, n));
+    for (auto i = 0uz; i != n; ++i)
+    {
+        const auto neighbors = list.neighbors(i);
+        const auto listed    = std::set<std::size_t>(neighbors.begin(), neighbors.end());
+        for (const auto j : brute_force_neighbors<N>(*z, n, i, cutoff))
+        {
+            EXPECT_TRUE(listed.contains(j));
+        }
+    }
+
+    // A move beyond it rebuilds them
+    (*z)[0, 0] += skin;
+    EXPECT_TRUE(list.update(*z, n));
+    EXPECT_EQ(list.rebuild_count(), 2uz);
+    for (auto i = 0uz; i != n; ++i)
+    {
+        const auto neighbors = list.neighbors(i);
+        EXPECT_EQ(
+            std::set<std::size_t>(neighbors.begin(), neighbors.end()),
+            brute_force_neighbors<N>(*z, n, i, cutoff + skin)
+        );
+    }
+}
+
+TEST(PairwiseKernels, SymmetricKernel)
+{
+    using F                  = double;
+    constexpr auto N         = 3uz;
+    constexpr auto n         = 257uz;
+    const auto     softening = systems::softening::cubic<F>{ F{ 0.01 } };
+    auto           z         = std::make_unique<buffer_t<F, n, 2 * N>>();
+    fill_positions<N>(*z, 104845342u);
+    const auto ref = direct_accelerations<N>(*z, n, softening.epsilon);
+
+    // Every pair once, potential energy over the pairs
+    auto potential = 0.;
+    for (auto i = 0uz; i != n; ++i)
+    {
+        for (auto j = i + 1; j != n; ++j)
+        {
+            auto d_sq = 0.;
+            for (auto d = 0uz; d != N; ++d)
+            {
+                d_sq += ((*z)[j, d] - (*z)[i, d]) * ((*z)[j, d] - (*z)[i, d]);
+            }
+            potential += softening.potential(d_sq);
+        }
+    }
+
+    systems::pairwise::symmetric_kernel<F, N> serial(n);
+    serial.evaluate(*z, n, softening);
+    EXPECT_LT(relative_error<N>(serial, ref), 1e-12);
+    EXPECT_NEAR(
+        serial.evaluate_with_potential(*z, n, softening),
+        potential,
+        1e-12 * std::abs(potential)
+    );
+
+    // Every task its own accumulator, reduced at the end
+    utility::parallel::thread_pool            pool(3);
+    systems::pairwise::symmetric_kernel<F, N> parallel(n, 3);
+    parallel.evaluate(*z, n, softening, pool);
+    EXPECT_LT(relative_error<N>(parallel, ref), 1e-12);
+    EXPECT_NEAR(
+        parallel.evaluate_with_potential(*z, n, softening, pool),
+        potential,
+        1e-12 * std::abs(potential)
+    );
+
+    // Fewer rows than the capacity
+    serial.evaluate(*z, n - 1, softening);
+    EXPECT_LT(
+        relative_error<N>(serial, direct_accelerations<N>(*z, n - 1, softening.epsilon)),
+        1e-12
+    );
+}
+
+TEST(PairwiseKernels, TiledKernel)
+{
+    using layout = data_types::buffer_config::LayoutPolicy;
+    // Transposed, read in place as columns and read in place as blocks
+    tiled_kernel_matches_direct_summation<layout::layout_row_major>();
+    tiled_kernel_matches_direct_summation<layout::layout_column_major>();
+    tiled_kernel_matches_direct_summation<
+        data_types::buffer_config::layout_blocked<16>>();
+}
+
+TEST(Reordering, RadixSort)
+{
+    using key_type   = std::uint64_t;
+    constexpr auto n = 5000uz;
+    std::mt19937_64  engine(104845342u);
+
+    // Full keys, and keys on their low 42 bits with many duplicates
+    for (const auto key_bits : { 64uz, 42uz })
+    {
+        const auto mask = key_bits == 64 ? ~key_type{} : (key_type{ 1 } << key_bits) - 1;
+        std::vector<key_type>                         keys(n);
+        std::vector<std::size_t>                      values(n);
+        std::vector<std::pair<key_type, std::size_t>> expected(n);
+        for (auto i = 0uz; i != n; ++i)
+        {
+            keys[i] = engine() & mask;
+            if (i % 3 == 0)
+            {
+                keys[i] &= 0xffff;
+            }
+            values[i]   = i;
+            expected[i] = { keys[i], i };
+        }
+        std::stable_sort(expected.begin(), expected.end(), [](auto a, auto b) {
+            return a.first < b.first;
+        });
+
+        // The result does not depend on the thread count
+        for (const auto threads : { 1uz, 3uz })
+        {
+            auto                                                   k = keys;
+            auto                                                   v = values;
+            utility::parallel::thread_pool                         pool(threads);
+            utility::parallel::radix_sorter<key_type, std::size_t> sorter(n);
+            sorter.sort(pool, k.data(), v.data(), n, key_bits);
+            for (auto i = 0uz; i != n; ++i)
+            {
+                EXPECT_EQ(k[i], expected[i].first);
+                EXPECT_EQ(v[i], expected[i].second);
+            }
+        }
+    }
+}
+
+TEST(Reordering, SpatialReorder)
+{
+    namespace sfc    = utility::space_filling_curves;
+    using F          = double;
+    constexpr auto N = 3uz;
+    constexpr auto n = 500uz;
+    auto           z = std::make_unique<buffer_t<F, n, 2 * N>>();
+    // Tags no double represents exactly
+    constexpr auto tag = std::uint64_t{ 1 } << 60;
+    auto           w   = std::make_unique<buffer_t<std::uint64_t, n, 1>>();
+    fill_positions<N>(*z, 104845342u);
+    for (auto i = 0uz; i != n; ++i)
+    {
+        (*z)[i, N] = static_cast<F>(i);
+        (*w)[i, 0] = tag + 2 * i + 1;
+    }
+    const auto initial = std::make_unique<buffer_t<F, n, 2 * N>>(*z);
+
+    utility::parallel::thread_pool             pool(3);
+    systems::reordering::spatial_reorder<F, N> reorder(
+        n, 2, systems::reordering::curve::morton
+    );
+    EXPECT_FALSE(reorder.advance(*z, n, pool, *w));
+    EXPECT_TRUE(reorder.advance(*z, n, pool, *w));
+    EXPECT_EQ(reorder.reorder_count(), 1uz);
+
+    // Rows are a permutation of the initial ones, the same for every buffer
+    for (auto k = 0uz; k != n; ++k)
+    {
+        const auto p = reorder.original_index(k);
+        EXPECT_EQ(reorder.row_of(p), k);
+        EXPECT_EQ(((*w)[k, 0]), tag + 2 * p + 1);
+        for (auto c = 0uz; c != 2 * N; ++c)
+        {
+            EXPECT_EQ(((*z)[k, c]), ((*initial)[p, c]));
+        }
+    }
+
+    // in Morton order over the bounding box
+    std::array<F, N> lo{};
+    std::array<F, N> hi{};
+    lo.fill(F{ 1 });
+    hi.fill(F{ -1 });
+    for (auto k = 0uz; k != n; ++k)
+    {
+        for (auto d = 0uz; d != N; ++d)
+        {
+            lo[d] = std::min(lo[d], (*z)[k, d]);
+            hi[d] = std::max(hi[d], (*z)[k, d]);
+        }
+    }
+    const auto inverse_side =
+        1 / std::max({ hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2] });
+    auto previous = sfc::key_type{};
+    for (auto k = 0uz; k != n; ++k)
+    {
+        sfc::grid_coordinates<N> coords{};
+        for (auto d = 0uz; d != N; ++d)
+        {
+            coords[d] = sfc::quantize<N>((*z)[k, d], lo[d], inverse_side);
+        }
+        const auto key = sfc::morton_encode<N>(coords);
+        EXPECT_LE(previous, key);
+        previous = key;
+    }
+
+    // and gathered back in the initial order
+    auto gathered = std::make_unique<buffer_t<F, n, 2 * N>>();
+    reorder.gather_original(*z, *gathered, n);
+    for (auto p = 0uz; p != n; ++p)
+    {
+        for (auto c = 0uz; c != 2 * N; ++c)
+        {
+            EXPECT_EQ(((*gathered)[p, c]), ((*initial)[p, c]));
+        }
+    }
+}
+
+TEST(NbodySystem, ForceBackends)
+{
+    using backend        = systems::nbody::force_backend;
+    const auto direct    = nbody_backend_matches_direct_summation<backend::direct>();
+    const auto symmetric = nbody_backend_matches_direct_summation<backend::symmetric>();
+    const auto tiled     = nbody_backend_matches_direct_summation<backend::tiled>();
+    const auto tolerance = 1e-12 * std::abs(direct);
+    EXPECT_NEAR(symmetric, direct, tolerance);
+    EXPECT_NEAR(tiled, direct, tolerance);
+}
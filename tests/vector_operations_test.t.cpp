@@ -1,8 +1,31 @@
+#if __has_include(<mdspan>)
+#include "buffer_interface.hpp"
+#include "buffer_mdspan.hpp"
+#endif
+#include "data_buffer.hpp"
 #include "dynamic_array.hpp"
+#include "dynamic_buffer.hpp"
+#include "execution_policy.hpp"
+#include "explicit_generic_embedded_runge_kutta.hpp"
+#include "explicit_generic_runge_kutta.hpp"
+#if __has_include(<generator>)
+#include "lazy_integration.hpp"
+#endif
 #include "random.hpp"
+#include "runge_kutta_params.hpp"
+#include "small_dynamic_array.hpp"
+#include "static_array.hpp"
+#include "thread_pool.hpp"
+#include "uniform_multibuffer.hpp"
 #include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <gtest/gtest.h>
 #include <limits>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 TEST(DynamicArrayBasics, Assignment)
 {
@@ -28,6 +51,186 @@ TEST(DynamicArrayBasics, Assignment)
     }
 }
 
+TEST(DynamicArrayBasics, MoveAndSwap)
+{
+    using F        = float;
+    using vector_t = data_types::lazily_evaluated_containers::dynamic_array<F>;
+
+    vector_t   a(100, F{ 1 });
+    const auto data = a.data();
+
+    vector_t b(std::move(a));
+    EXPECT_EQ(b.data(), data);
+    EXPECT_EQ(b.size(), 100);
+    EXPECT_TRUE(a.empty());
+
+    vector_t c(10, F{ 2 });
+    c = std::move(b);
+    EXPECT_EQ(c.data(), data);
+    EXPECT_EQ(c[99], F{ 1 });
+
+    vector_t d(5, F{ 3 });
+    swap(c, d);
+    EXPECT_EQ(d.data(), data);
+    EXPECT_EQ(c.size(), 5);
+    EXPECT_EQ(c[4], F{ 3 });
+}
+
+TEST(DynamicArrayBasics, CapacityReuse)
+{
+    using F         = float;
+    using vector_t  = data_types::lazily_evaluated_containers::dynamic_array<F>;
+    using growing_t = data_types::lazily_evaluated_containers::dynamic_array<
+        F,
+        std::allocator<F>,
+        data_types::growth_policy::geometric<2, 1>>;
+
+    vector_t   v(100, F{ 1 });
+    const auto data = v.data();
+    v.resize(10);
+    EXPECT_EQ(v.capacity(), 100);
+    v.resize(80);
+    EXPECT_EQ(v.data(), data);
+    EXPECT_EQ(v[9], F{ 1 });
+
+    const vector_t w(50, F{ 2 });
+    v = w;
+    EXPECT_EQ(v.data(), data);
+    EXPECT_EQ(v.size(), 50);
+
+    v.resize(150);
+    EXPECT_EQ(v.capacity(), 150);
+    EXPECT_EQ(v[49], F{ 2 });
+    v.resize(20);
+    v.shrink_to_fit();
+    EXPECT_EQ(v.capacity(), 20);
+
+    growing_t g(10);
+    g.resize(11);
+    EXPECT_EQ(g.capacity(), 20);
+    g.reserve(100);
+    EXPECT_EQ(g.capacity(), 100);
+    EXPECT_EQ(g.size(), 11);
+}
+
+TEST(DynamicArrayBasics, SmallDynamicArray)
+{
+    using F        = double;
+    using vector_t = data_types::lazily_evaluated_containers::small_dynamic_array<F, 4>;
+
+    vector_t a{ F{ 1 }, F{ 2 } };
+    vector_t b(2, F{ 3 });
+    EXPECT_TRUE(a.is_inline());
+    EXPECT_EQ(a.capacity(), 4);
+
+    vector_t v = a * F{ 2 } + b;
+    v         += a;
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_EQ(v, (vector_t{ F{ 6 }, F{ 9 } }));
+
+    vector_t w(std::move(v));
+    EXPECT_TRUE(w.is_inline());
+    EXPECT_EQ(w[1], F{ 9 });
+
+    w.resize(10);
+    EXPECT_FALSE(w.is_inline());
+    EXPECT_EQ(w[1], F{ 9 });
+    const auto data = w.data();
+
+    vector_t x(std::move(w));
+    EXPECT_EQ(x.data(), data);
+    EXPECT_TRUE(w.is_inline());
+    EXPECT_TRUE(w.empty());
+
+    x.resize(3);
+    x.shrink_to_fit();
+    EXPECT_TRUE(x.is_inline());
+    EXPECT_EQ(x[0], F{ 6 });
+}
+
+TEST(DynamicArrayBasics, AlignedDynamicArray)
+{
+    using F         = double;
+    using vector_t  = data_types::lazily_evaluated_containers::aligned_dynamic_array<F>;
+    using plain_t   = data_types::lazily_evaluated_containers::dynamic_array<F>;
+    const auto addr = [](auto const& v) {
+        return reinterpret_cast<std::uintptr_t>(v.data()) % vector_t::s_alignment;
+    };
+
+    static constexpr auto N = 13;
+
+    vector_t a(N);
+    vector_t b(N, F{ 3 });
+    plain_t  c(N, F{ 1 });
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        a[i] = static_cast<F>(i);
+    }
+    EXPECT_EQ(addr(a), 0);
+    EXPECT_EQ(a.capacity() % vector_t::s_padding, 0);
+    EXPECT_GE(a.capacity(), N);
+
+    vector_t v  = a * F{ 2 } + b;
+    v          += a;
+    v          -= c;
+    EXPECT_EQ(addr(v), 0);
+    EXPECT_EQ(v.size(), N);
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        EXPECT_EQ(v[i], F(3 * i + 2));
+    }
+
+    v.resize(100);
+    EXPECT_EQ(addr(v), 0);
+    EXPECT_EQ(v[N - 1], F(3 * (N - 1) + 2));
+
+    vector_t w(std::move(v));
+    w.resize(N);
+    w.shrink_to_fit();
+    EXPECT_EQ(addr(w), 0);
+    EXPECT_EQ(w.capacity() % vector_t::s_padding, 0);
+    EXPECT_EQ(w[0], F{ 2 });
+}
+
+TEST(DynamicArrayBasics, ZeroedPadding)
+{
+    using F = double;
+
+    // Fresh storage full of NaN, as it may hold anything
+    struct scribbling_allocator : std::allocator<F>
+    {
+        auto allocate(std::size_t n) -> F*
+        {
+            const auto p = std::allocator<F>::allocate(n);
+            std::fill(p, p + n, std::numeric_limits<F>::quiet_NaN());
+            return p;
+        }
+    };
+    using vector_t = data_types::lazily_evaluated_containers::
+        dynamic_array<F, scribbling_allocator, data_types::growth_policy::exact, 64>;
+
+    static constexpr auto N = 13;
+    static constexpr auto M = (N + vector_t::s_padding - 1) / vector_t::s_padding
+                              * vector_t::s_padding;
+
+    // The packets past the end only ever see zeroes
+    vector_t a(N, F{ 1 });
+    vector_t b(N, F{ 2 });
+    a += b;
+    a *= b;
+    for (std::size_t i = N; i != M; ++i)
+    {
+        EXPECT_EQ(a.data()[i], F{ 0 });
+    }
+    a.resize(3 * N);
+    a.resize(N - 1);
+    for (std::size_t i = N - 1; i != M; ++i)
+    {
+        EXPECT_EQ(a.data()[i], F{ 0 });
+    }
+    EXPECT_EQ(a[N - 2], F{ 6 });
+}
+
 TEST(DynamicArrayOperations, VectorScalarPlus)
 {
     using F                 = float;
@@ -261,3 +464,775 @@ TEST(DynamicArrayOperations, VectorVectorDivides)
         }
     }
 }
+
+TEST(DynamicArrayOperations, ConstructFromExpression)
+{
+    using F                 = float;
+    static constexpr auto N = 250;
+
+    using vector_t = data_types::lazily_evaluated_containers::dynamic_array<F>;
+
+    for (std::size_t j = 0; j != 200; ++j)
+    {
+        std::array<F, N> data1{};
+        std::array<F, N> data2{};
+        vector_t         tmp1(N);
+        vector_t         tmp2(N);
+
+        for (std::size_t i = 0; i != N; ++i)
+        {
+            data1[i] = utility::random::srandom::randfloat<F>();
+            data2[i] = utility::random::srandom::randfloat<F>();
+            tmp1[i]  = data1[i];
+            tmp2[i]  = data2[i];
+        }
+        const auto r = utility::random::srandom::randfloat<F>();
+        vector_t   v = tmp1 + tmp2 * r - F{ 1 };
+        EXPECT_EQ(v.size(), N);
+        for (std::size_t i = 0; i != N; ++i)
+        {
+            EXPECT_NEAR(
+                v[i],
+                data1[i] + data2[i] * r - F{ 1 },
+                4 * std::numeric_limits<F>::epsilon()
+            );
+        }
+    }
+}
+
+TEST(DynamicArrayOperations, ExpressionSize)
+{
+    using F                 = float;
+    static constexpr auto N = 250;
+
+    using vector_t = data_types::lazily_evaluated_containers::dynamic_array<F>;
+
+    vector_t   a(N, F{ 1 });
+    vector_t   b(N, F{ 2 });
+    const auto e = F{ 3 } * (a + b) / b;
+    EXPECT_EQ(e.size(), N);
+    EXPECT_EQ(decltype(e)::s_static_extent, std::dynamic_extent);
+
+    vector_t v;
+    v = e;
+    EXPECT_EQ(v.size(), N);
+    EXPECT_NEAR(v[N - 1], F{ 4.5 }, std::numeric_limits<F>::epsilon());
+}
+
+TEST(DynamicArrayOperations, EvalOnce)
+{
+    using F                 = float;
+    static constexpr auto N = 250;
+
+    using vector_t = data_types::lazily_evaluated_containers::dynamic_array<F>;
+
+    vector_t a(N, F{ 1 });
+    vector_t b(N, F{ 2 });
+    vector_t storage;
+
+    auto cached = data_types::lazily_evaluated_containers::eval_once(a + b, storage);
+    EXPECT_EQ(storage.size(), N);
+    EXPECT_FALSE(cached.evaluated());
+
+    const vector_t v = cached * F{ 2 } - b;
+    EXPECT_TRUE(cached.evaluated());
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        EXPECT_NEAR(storage[i], F{ 3 }, std::numeric_limits<F>::epsilon());
+        EXPECT_NEAR(v[i], F{ 4 }, std::numeric_limits<F>::epsilon());
+    }
+
+    // Later passes read the storage
+    a[0] = F{ 10 };
+    const vector_t w = cached + F{ 1 };
+    EXPECT_NEAR(w[0], F{ 4 }, std::numeric_limits<F>::epsilon());
+}
+
+TEST(DynamicArrayOperations, BlockedEvaluation)
+{
+    using F                 = double;
+    static constexpr auto N = 1001;
+
+    using vector_t = data_types::lazily_evaluated_containers::dynamic_array<F>;
+
+    utility::parallel::execution_policy policy{};
+    policy.block_bytes      = 256;
+    policy.prefetch_blocks  = 2;
+    policy.streaming_stores = true;
+
+    vector_t a(N);
+    vector_t b(N, F{ 2 });
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        a[i] = static_cast<F>(i);
+    }
+    vector_t v(N);
+    v.assign(a * b + F{ 1 }, policy);
+    v.in_place_operator_impl_(a, std::minus{}, policy);
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        EXPECT_NEAR(v[i], static_cast<F>(i + 1), std::numeric_limits<F>::epsilon());
+    }
+}
+
+TEST(DynamicArrayOperations, DefaultExecutionPolicy)
+{
+    using F                 = double;
+    static constexpr auto N = 10001;
+
+    using vector_t = data_types::lazily_evaluated_containers::dynamic_array<F>;
+
+    // Every thread assigns with its own default, and so its own pool
+    const auto assign = [](vector_t& v) {
+        utility::parallel::thread_pool pool(3);
+        auto& policy = utility::parallel::default_execution_policy();
+        EXPECT_EQ(policy.pool, nullptr);
+        policy = utility::parallel::par(pool, 0);
+
+        vector_t a(N, F{ 1 });
+        vector_t b(N, F{ 2 });
+        v  = a * b + F{ 1 };
+        v += a;
+        policy = utility::parallel::seq;
+    };
+    vector_t v(N);
+    vector_t w(N);
+    std::thread other(assign, std::ref(w));
+    assign(v);
+    other.join();
+    for (std::size_t i = 0; i != N; ++i)
+    {
+        EXPECT_EQ(v[i], F{ 4 });
+        EXPECT_EQ(w[i], F{ 4 });
+    }
+}
+
+TEST(DynamicArrayOperations, PacketEvaluation)
+{
+    using F        = double;
+    using vector_t = data_types::lazily_evaluated_containers::dynamic_array<F>;
+    using index_t  = data_types::lazily_evaluated_containers::dynamic_array<int>;
+
+    static constexpr auto W = data_types::operation_utils::stdx::native_simd<F>::size();
+
+    // Every size up to three packets and a tail, so both the packet loop and
+    // the scalar tail run, against the scalar subscript of the same expression
+    for (std::size_t n = 0; n != 3 * W + 2; ++n)
+    {
+        vector_t a(n);
+        vector_t b(n);
+        index_t  c(n);
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            a[i] = static_cast<F>(i) - F{ 3.5 };
+            b[i] = F{ 0.25 } * static_cast<F>(i + 1);
+            c[i] = static_cast<int>(i % 3) - 1;
+        }
+        const auto e = abs(a - b) * c + a / (b + F{ 1 });
+        static_assert(decltype(e)::s_packet_evaluable);
+
+        vector_t v(n);
+        v = e;
+        vector_t w(n, F{ 1 });
+        w += e * a;
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            EXPECT_EQ(v[i], e[i]);
+            EXPECT_EQ(w[i], F{ 1 } + e[i] * a[i]);
+        }
+        for (std::size_t i = 0; i + W <= n; i += W)
+        {
+            const auto p = e.packet<W>(i);
+            for (std::size_t lane = 0; lane != W; ++lane)
+            {
+                EXPECT_EQ(p[lane], e[i + lane]);
+            }
+        }
+    }
+}
+
+TEST(DynamicArrayOperations, Reductions)
+{
+    using F        = double;
+    using vector_t = data_types::lazily_evaluated_containers::dynamic_array<F>;
+
+    static constexpr auto W = data_types::operation_utils::stdx::native_simd<F>::size();
+
+    utility::parallel::thread_pool pool(3);
+    const auto                     par = utility::parallel::par(pool, 0);
+
+    for (const std::size_t n : { 0uz, 1uz, W - 1, W, 3 * W + 1, 1001uz })
+    {
+        vector_t a(n);
+        vector_t b(n);
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            a[i] = std::sin(static_cast<F>(i)) * static_cast<F>(i % 7);
+            b[i] = std::cos(static_cast<F>(i));
+        }
+
+        F sum_ref{};
+        F dot_ref{};
+        F max_ref{};
+        F sq_ref{};
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            sum_ref += a[i] + F{ 2 } * b[i];
+            dot_ref += a[i] * b[i];
+            max_ref  = std::max(max_ref, std::abs(a[i] - b[i]));
+            sq_ref  += a[i] * a[i];
+        }
+
+        // Summation order differs from the scalar loop
+        const auto tol = F{ 1e-12 } * static_cast<F>(n + 1);
+        EXPECT_NEAR(sum(a + F{ 2 } * b), sum_ref, tol);
+        EXPECT_NEAR(sum(a + F{ 2 } * b, par), sum_ref, tol);
+        EXPECT_NEAR(dot(a, b), dot_ref, tol);
+        EXPECT_NEAR(dot(a, b, par), dot_ref, tol);
+        EXPECT_EQ(norm_inf(a - b), max_ref);
+        EXPECT_EQ(norm_inf(a - b, par), max_ref);
+        EXPECT_NEAR(data_types::operation_utils::l2_norm_sq(a), sq_ref, tol);
+        EXPECT_EQ(data_types::operation_utils::linfinity_norm(a), norm_inf(a));
+    }
+}
+
+TEST(StaticArrayOperations, LazyExpression)
+{
+    using F       = double;
+    using array_t = data_types::eagerly_evaluated_containers::static_array<F, 3>;
+
+    static constexpr auto evaluate = [] {
+        const array_t p{ { 1, 2, 3 } };
+        const array_t q{ { 4, 6, 8 } };
+        array_t       ret{};
+        ret += (lazy(q) - p) / F{ 2 };
+        return to_static_array(lazy(ret) * F{ 2 } + p);
+    };
+    static constexpr auto ret = evaluate();
+    static_assert(ret == array_t{ { 4, 6, 8 } });
+
+    const array_t p{ { 1, 2, 3 } };
+    const auto    e = lazy(p) * p - F{ 1 };
+    EXPECT_EQ(decltype(e)::s_static_extent, 3uz);
+
+    array_t v{};
+    v = e;
+    EXPECT_EQ(v, (array_t{ { 0, 3, 8 } }));
+}
+
+TEST(BufferOperations, PaddedLines)
+{
+    using F      = double;
+    using layout = data_types::buffer_config::LayoutPolicy;
+    using stride = data_types::buffer_config::layout_stride;
+    using padded_t = data_types::lazily_evaluated_containers::
+        static_buffer<F, 5, 3, layout::layout_row_major, stride{ 8 }>;
+    using column_t = data_types::lazily_evaluated_containers::
+        static_buffer<F, 5, 3, layout::layout_column_major, stride{ 8 }>;
+    using plain_t = data_types::lazily_evaluated_containers::
+        static_buffer<F, 5, 3, layout::layout_row_major, stride{ 0 }>;
+
+    padded_t a{};
+    padded_t b{};
+    column_t c{};
+    column_t d{};
+    plain_t  e{};
+    for (std::size_t j = 0; j != 5; ++j)
+    {
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            a[j, i] = static_cast<F>(3 * j + i);
+            b[j, i] = F{ 1 };
+            c[j, i] = static_cast<F>(3 * j + i);
+            d[j, i] = F{ 1 };
+            e[j, i] = F{ 2 };
+        }
+    }
+
+    padded_t v{};
+    v  = a * F{ 2 } + b;
+    v += a;
+    v -= e;
+    column_t w{};
+    w  = c + d;
+    w += c;
+    e += a;
+    for (std::size_t j = 0; j != 5; ++j)
+    {
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            EXPECT_EQ((v[j, i]), F(3 * (3 * j + i)) - F{ 1 });
+            EXPECT_EQ((w[j, i]), F(2 * (3 * j + i) + 1));
+            EXPECT_EQ((e[j, i]), F(3 * j + i + 2));
+        }
+    }
+}
+
+TEST(BufferOperations, BlockedLayout)
+{
+    using F        = double;
+    using stride   = data_types::buffer_config::layout_stride;
+    using static_t = data_types::lazily_evaluated_containers::static_buffer<
+        F,
+        10,
+        3,
+        data_types::buffer_config::layout_blocked<4>,
+        stride{ 0 }>;
+    using dynamic_t =
+        data_types::lazily_evaluated_containers::dynamic_length_buffer<F, 3>;
+
+    // 3 blocks of 4 rows, the last one half used
+    static_assert(static_t::size() == 36uz);
+    static_assert(static_t::flat_projection(5, 1) == 17uz);
+    dynamic_t a(10, 10, data_types::buffer_config::layout_blocked<4>, stride{ 0 });
+    dynamic_t b(10, 10, data_types::buffer_config::layout_blocked<4>, stride{ 0 });
+    EXPECT_EQ(a.size(), 36uz);
+    EXPECT_EQ(a.capacity_y(), 12uz);
+    EXPECT_EQ(a.flat_projection(5, 1), 17uz);
+
+    static_t c{};
+    static_t d{};
+    for (std::size_t j = 0; j != 10; ++j)
+    {
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            a[j, i] = static_cast<F>(3 * j + i);
+            b[j, i] = F{ 1 };
+            c[j, i] = static_cast<F>(3 * j + i);
+            d[j, i] = F{ 1 };
+        }
+    }
+
+    dynamic_t v(10, 10, data_types::buffer_config::layout_blocked<4>, stride{ 0 });
+    v  = a * F{ 2 } + b;
+    v -= a;
+    static_t w{};
+    w  = c * F{ 2 } + d;
+    w -= c;
+    for (std::size_t j = 0; j != 10; ++j)
+    {
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            EXPECT_EQ((v[j, i]), F(3 * j + i + 1));
+            EXPECT_EQ((w[j, i]), F(3 * j + i + 1));
+        }
+    }
+}
+
+TEST(BufferOperations, BlockedReductions)
+{
+    using F        = double;
+    using stride   = data_types::buffer_config::layout_stride;
+    using static_t = data_types::lazily_evaluated_containers::static_buffer<
+        F,
+        10,
+        3,
+        data_types::buffer_config::layout_blocked<4>,
+        stride{ 0 }>;
+    using dynamic_t =
+        data_types::lazily_evaluated_containers::dynamic_length_buffer<F, 3>;
+
+    // The last block has two rows past the tenth, zeroed and left out
+    static_t  a;
+    dynamic_t b(10, 10, data_types::buffer_config::layout_blocked<4>, stride{ 0 });
+    for (std::size_t i = 0; i != 3; ++i)
+    {
+        for (std::size_t r = 2; r != 4; ++r)
+        {
+            EXPECT_EQ(a[(2 * 3 + i) * 4 + r], F{ 0 });
+            EXPECT_EQ(b[(2 * 3 + i) * 4 + r], F{ 0 });
+        }
+    }
+    F sum_ref{};
+    F sq_ref{};
+    for (std::size_t j = 0; j != 10; ++j)
+    {
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            a[j, i]  = static_cast<F>(3 * j + i + 1);
+            b[j, i]  = static_cast<F>(3 * j + i + 1);
+            sum_ref += static_cast<F>(3 * j + i + 1);
+            sq_ref  += static_cast<F>((3 * j + i + 1) * (3 * j + i + 1));
+        }
+    }
+
+    // 0 / 0 in the unused rows
+    static_t  v;
+    dynamic_t w(10, 10, data_types::buffer_config::layout_blocked<4>, stride{ 0 });
+    v = a / a + a - F{ 1 };
+    w = b / b + b - F{ 1 };
+    EXPECT_EQ(sum(v), sum_ref);
+    EXPECT_EQ(sum(w), sum_ref);
+    EXPECT_EQ(dot(v, w), sq_ref);
+    EXPECT_EQ(norm_inf(v - F{ 100 }), F{ 99 });
+    EXPECT_EQ(norm_inf(w * F{ -1 }), F{ 30 });
+    v += a;
+    EXPECT_EQ(sum(v), F{ 2 } * sum_ref);
+}
+
+TEST(BufferOperations, Views)
+{
+    using F      = double;
+    using layout = data_types::buffer_config::LayoutPolicy;
+    using stride = data_types::buffer_config::layout_stride;
+    using row_t  = data_types::lazily_evaluated_containers::
+        static_buffer<F, 4, 3, layout::layout_row_major, stride{ 0 }>;
+    using dynamic_t =
+        data_types::lazily_evaluated_containers::dynamic_length_buffer<F, 3>;
+
+    row_t     a{};
+    dynamic_t b(4, 4, layout::layout_row_major, stride{ 4 });
+    for (std::size_t j = 0; j != 4; ++j)
+    {
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            a[j, i] = static_cast<F>(3 * j + i);
+            b[j, i] = F{ 0 };
+        }
+    }
+
+    // Rows of row major buffers are contiguous, their columns strided
+    static_assert(decltype(a.row(0))::s_contiguous);
+    EXPECT_EQ(a.column(1).stride(), 3uz);
+    EXPECT_EQ((a.row(2)[1]), F{ 7 });
+    b.column(2) = a.column(1) * F{ 2 };
+    b.row(0)   += a.row(3);
+    auto block  = b.sub_block(1, 0, 3, 2);
+    block       = a.sub_block(0, 1, 3, 2) + F{ 1 };
+    for (std::size_t j = 0; j != 4; ++j)
+    {
+        EXPECT_EQ((b[j, 2]), F(2 * (3 * j + 1)) + (j == 0 ? F{ 11 } : F{ 0 }));
+    }
+    EXPECT_EQ((b[0, 0]), F{ 9 });
+    EXPECT_EQ((b[3, 1]), F{ 9 });
+    EXPECT_EQ((block[1, 1]), F{ 6 });
+
+    data_types::lazily_evaluated_containers::dynamic_array<F> v(
+        { 0., 1., 2., 3., 4., 5. }
+    );
+    v.strided(1, 3, 2) *= F{ 10 };
+    EXPECT_EQ(v[5], F{ 50 });
+    EXPECT_EQ(v[4], F{ 4 });
+    EXPECT_EQ(data_types::lazily_evaluated_containers::sum(v.slice(2, 4)), F{ 32 });
+}
+
+TEST(BufferOperations, CachedIntoStridedViews)
+{
+    using F        = double;
+    using layout   = data_types::buffer_config::LayoutPolicy;
+    using stride   = data_types::buffer_config::layout_stride;
+    using row_t    = data_types::lazily_evaluated_containers::
+        static_buffer<F, 4, 3, layout::layout_row_major, stride{ 0 }>;
+    using vector_t = data_types::lazily_evaluated_containers::dynamic_array<F>;
+
+    // Stale storage, which the views must not read
+    const auto nan = std::numeric_limits<F>::quiet_NaN();
+    vector_t   a({ 1., 2., 3., 4. });
+    vector_t   b({ 10., 20., 30., 40. });
+    vector_t   tmp(4, nan);
+    vector_t   other(4, nan);
+    row_t      buf{};
+    vector_t   v(8, F{ 1 });
+
+    buf.column(1) = eval_once(a + b, tmp) * F{ 2 };
+    v.strided(1, 4, 2) += eval_once(a * b, other);
+    for (std::size_t j = 0; j != 4; ++j)
+    {
+        EXPECT_EQ(tmp[j], a[j] + b[j]);
+        EXPECT_EQ((buf[j, 1]), F{ 2 } * (a[j] + b[j]));
+        EXPECT_EQ(v[2 * j], F{ 1 });
+        EXPECT_EQ(v[2 * j + 1], F{ 1 } + a[j] * b[j]);
+    }
+}
+
+TEST(BufferOperations, DynamicBuffer)
+{
+    using F        = double;
+    using buffer_t = data_types::lazily_evaluated_containers::dynamic_buffer<F>;
+    using shape_t  = buffer_t::shape_t;
+    using layout   = buffer_t::layout_policy_t;
+
+    // 4 particles of 3 components, room for 6 of 5 in rows padded to 8
+    buffer_t x(shape_t(4, 6, 3, 5, layout::layout_row_major, 8));
+    buffer_t y(4, 3, layout::layout_column_major);
+    EXPECT_EQ(x.size(), 12);
+    EXPECT_EQ(x.underlying_size_x(), 8);
+    for (std::size_t j = 0; j != 4; ++j)
+    {
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            x[j, i] = static_cast<F>(3 * j + i);
+        }
+    }
+    buffer_t z(4, 3);
+    z  = x * F{ 2 } + F{ 1 };
+    z -= x;
+    EXPECT_EQ((z[3, 2]), F{ 12 });
+    y = z;
+    EXPECT_EQ(y.layout_policy(), layout::layout_row_major);
+    EXPECT_EQ((y[3, 2]), F{ 12 });
+
+    const auto data = x.data();
+    x.resize(6, 5);
+    EXPECT_EQ(x.data(), data);
+    EXPECT_EQ((x[3, 2]), F{ 11 });
+    x.resize(8, 3);
+    EXPECT_EQ(x.capacity_y(), 8);
+    EXPECT_EQ((x[3, 2]), F{ 11 });
+    x.resize(4, 3);
+
+    // One step of the classic Runge-Kutta method on dx/dt = -x
+    using rk_t =
+        solvers::explicit_stepers::generic_runge_kutta<4, 4, F, buffer_t, buffer_t, F>;
+    rk_t stepper(
+        x,
+        solvers::explicit_stepers::butcher_tableau<F, 4>{
+            { 0.5, 0., 0.5, 0., 0., 1. },
+            { 1. / 6., 1. / 3., 1. / 3., 1. / 6. },
+            { 0.5, 0.5, 1. } }
+    );
+    const auto system = [](buffer_t const& s, buffer_t& dsdt, F) { dsdt = s * F{ -1 }; };
+    const auto h      = F{ 0.1 };
+    stepper.do_step(system, x, F{ 0 }, h);
+    const auto growth = 1 - h + h * h / 2 - h * h * h / 6 + h * h * h * h / 24;
+    for (std::size_t j = 0; j != 4; ++j)
+    {
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            EXPECT_NEAR((x[j, i]), F(3 * j + i) * growth, 1e-12);
+        }
+    }
+}
+
+TEST(BufferOperations, UniformMultibuffer)
+{
+    using F           = double;
+    using multibuffer = buffers::multibuffer::dynamic_uniform_multibuffer<F, 5>;
+    using vector      = data_types::lazily_evaluated_containers::
+        dynamic_array<F, buffers::multibuffer::slot_allocator<F>>;
+
+    // 100 doubles take 12.5 cache lines, the slots 13 so that each starts at a
+    // different offset within a page
+    multibuffer m(100);
+    EXPECT_EQ(m.slot_stride(), 104uz);
+    for (std::size_t k = 0; k != m.slot_count(); ++k)
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(m.buffer(k));
+        const auto offset  = address - reinterpret_cast<std::uintptr_t>(m.buffer(0));
+        EXPECT_EQ(address % 64, 0uz);
+        EXPECT_EQ(offset % 4096, k * 104 * sizeof(F));
+    }
+
+    // Copies of containers over a slot get storage of their own
+    vector a(100, m.slot(1));
+    vector b(a);
+    EXPECT_EQ(a.data(), m.buffer(1));
+    EXPECT_NE(b.data(), a.data());
+
+    // and copy assignments keep their own slot, or none, whatever the source
+    using small_vector = data_types::lazily_evaluated_containers::
+        small_dynamic_array<F, 4, buffers::multibuffer::slot_allocator<F>>;
+    std::ranges::fill(a, F{ 1 });
+    vector       c(10, m.slot(2));
+    vector       d;
+    small_vector e(2, m.slot(3));
+    small_vector f(100, m.slot(4));
+    c = a;
+    d = a;
+    e = f;
+    EXPECT_EQ(c.data(), m.buffer(2));
+    EXPECT_NE(d.data(), a.data());
+    EXPECT_FALSE(d.allocator().bound());
+    EXPECT_EQ(e.data(), m.buffer(3));
+    c[0] = F{ 2 };
+    d[0] = F{ 3 };
+    EXPECT_EQ(a[0], F{ 1 });
+    EXPECT_EQ(c[99], F{ 1 });
+
+    // Moves take the slot along, the source then regrows on the heap
+    small_vector g(std::move(f));
+    f.resize(50);
+    EXPECT_EQ(g.data(), m.buffer(4));
+    EXPECT_NE(f.data(), g.data());
+    EXPECT_FALSE(f.allocator().bound());
+    EXPECT_TRUE(m.slot(1) == m.slot(1));
+    EXPECT_FALSE(m.slot(1) == m.slot(2));
+
+    // Slots sized for what over-aligned containers allocate hold them
+    using aligned_vector = data_types::lazily_evaluated_containers::dynamic_array<
+        F,
+        buffers::multibuffer::slot_allocator<F>,
+        data_types::growth_policy::exact,
+        64>;
+    multibuffer    n(buffers::multibuffer::slot_size_for<vector, aligned_vector>(100));
+    aligned_vector p(100, n.slot(0));
+    EXPECT_EQ(p.data(), n.buffer(0));
+
+    // Steppers over slot allocated states keep their buffers in one multibuffer
+    using rk_t =
+        solvers::explicit_stepers::generic_runge_kutta<4, 4, F, vector, vector, F>;
+    static_assert(!std::is_copy_constructible_v<rk_t>);
+    rk_t stepper(
+        3,
+        solvers::explicit_stepers::butcher_tableau<F, 4>{
+            { 0.5, 0., 0.5, 0., 0., 1. },
+            { 1. / 6., 1. / 3., 1. / 3., 1. / 6. },
+            { 0.5, 0.5, 1. } }
+    );
+    vector     x(3, F{ 1 });
+    const auto system = [](vector const& s, vector& dsdt, F) { dsdt = s * F{ -1 }; };
+    const auto h      = F{ 0.1 };
+    stepper.do_step(system, x, F{ 0 }, h);
+    const auto growth = 1 - h + h * h / 2 - h * h * h / 6 + h * h * h * h / 24;
+    for (std::size_t i = 0; i != 3; ++i)
+    {
+        EXPECT_NEAR(x[i], growth, 1e-12);
+    }
+}
+
+#if __has_include(<mdspan>)
+TEST(BufferOperations, Mdspan)
+{
+    using F        = double;
+    using layout   = data_types::buffer_config::LayoutPolicy;
+    using stride   = data_types::buffer_config::layout_stride;
+    using padded_t = data_types::lazily_evaluated_containers::
+        static_buffer<F, 5, 3, layout::layout_column_major, stride{ 8 }>;
+    using block_t  = data_types::lazily_evaluated_containers::static_buffer<
+        F,
+        10,
+        3,
+        data_types::buffer_config::layout_blocked<4>,
+        stride{ 0 }>;
+    using dynamic_t =
+        data_types::lazily_evaluated_containers::dynamic_length_buffer<F, 3>;
+    namespace md = data_types::buffer_mdspan;
+
+    padded_t   a{};
+    block_t    b{};
+    dynamic_t  c(10, 12, data_types::buffer_config::layout_blocked<4>, stride{ 0 });
+    dynamic_t  d(5, 6, layout::layout_row_major, stride{ 4 });
+    const auto va = md::to_mdspan(a);
+    const auto vb = md::to_mdspan(b);
+    const auto vc = md::to_mdspan(c);
+    const auto vd = md::to_mdspan(std::as_const(d));
+    static_assert(std::is_const_v<decltype(vd)::element_type>);
+    EXPECT_EQ(va.stride(1), 8uz);
+    EXPECT_FALSE(va.is_exhaustive());
+    EXPECT_FALSE(vc.is_strided());
+    EXPECT_EQ(vc.mapping().required_span_size(), c.size());
+    EXPECT_EQ(vd.extent(0), 5uz);
+    for (std::size_t j = 0; j != 5; ++j)
+    {
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            EXPECT_EQ((&va[j, i]), (&a[j, i]));
+            EXPECT_EQ((&vb[2 * j, i]), (&b[2 * j, i]));
+            EXPECT_EQ((&vc[2 * j + 1, i]), (&c[2 * j + 1, i]));
+            EXPECT_EQ((&vd[j, i]), (&d[j, i]));
+        }
+    }
+
+    // Shapes of buffers::buffer_interface, over storage owned elsewhere
+    using shape_t = buffers::buffer_interface::dynamic_shape;
+    const shape_t shape(4, 6, 3, 5, shape_t::layout_policy_t::layout_column_major, 0);
+    std::array<F, 30> storage{};
+    const auto        ve = md::to_mdspan(shape, storage.data());
+    EXPECT_EQ((&ve[3, 2]), &storage[shape.flat_projection(3, 2)]);
+}
+#endif
+
+#if __has_include(<generator>)
+TEST(LazyIntegration, Trajectories)
+{
+    using F      = double;
+    using vector = data_types::lazily_evaluated_containers::dynamic_array<F>;
+    using rk_t =
+        solvers::explicit_stepers::generic_runge_kutta<4, 4, F, vector, vector, F>;
+    using rkf_t = solvers::explicit_stepers::
+        explicit_embedded_runge_kutta<6, 4, 5, 5, F, vector, vector, F>;
+    const auto system = [](vector const& s, vector& dsdt, F) { dsdt = s * F{ -1 }; };
+    const auto t0     = F{ 1 };
+
+    // Fixed steps: the initial condition first, then one point per step, each
+    // referring to the state advanced in place
+    rk_t stepper(
+        3,
+        solvers::explicit_stepers::butcher_tableau<F, 4>{
+            { 0.5, 0., 0.5, 0., 0., 1. },
+            { 1. / 6., 1. / 3., 1. / 3., 1. / 6. },
+            { 0.5, 0.5, 1. } }
+    );
+    vector     x(3, F{ 1 });
+    const auto h        = F{ 0.1 };
+    const auto growth   = 1 - h + h * h / 2 - h * h * h / 6 + h * h * h * h / 24;
+    auto       expected = F{ 1 };
+    auto       count    = 0uz;
+    for (auto [t, s] : solvers::integration::integrate_lazily(stepper, system, x, t0, h))
+    {
+        EXPECT_EQ(&s, &x);
+        EXPECT_NEAR(t, t0 + static_cast<F>(count) * h, 1e-12);
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            EXPECT_NEAR(s[i], expected, 1e-12);
+        }
+        if (++count == 10)
+        {
+            break;
+        }
+        expected *= growth;
+    }
+    EXPECT_EQ(count, 10uz);
+
+    // Adaptive steps: the initial condition first, then the accepted steps at
+    // increasing times, following exp(t0 - t)
+    rkf_t embedded(
+        3,
+        solvers::explicit_stepers::extended_butcher_tableau<F, 6>(
+            { 0.25,
+              3. / 32.,
+              9. / 32.,
+              1932. / 2197.,
+              -7200. / 2197.,
+              7296. / 2197.,
+              439. / 216.,
+              -8.,
+              3680. / 513.,
+              -845. / 4104.,
+              -8. / 27.,
+              2.,
+              -3544. / 2565.,
+              1859. / 4104.,
+              -11. / 40. },
+            { 16. / 135., 0., 6656. / 12825., 28561. / 56430., -9. / 50., 2. / 55. },
+            { 25. / 216., 0., 1408. / 2565., 2197. / 4104., -1. / 5., 0. },
+            { 0.25, 3. / 8., 12. / 13., 1., 0.5 }
+        )
+    );
+    vector y(3, F{ 1 });
+    auto   previous = t0;
+    count           = 0;
+    for (auto [t, s] : solvers::integration::integrate_lazily(embedded, system, y, t0))
+    {
+        EXPECT_EQ(&s, &y);
+        if (count == 0)
+        {
+            EXPECT_EQ(t, t0);
+        }
+        else
+        {
+            EXPECT_GT(t, previous);
+        }
+        for (std::size_t i = 0; i != 3; ++i)
+        {
+            EXPECT_NEAR(s[i], std::exp(t0 - t), 1e-4);
+        }
+        previous = t;
+        if (++count == 10)
+        {
+            break;
+        }
+    }
+    EXPECT_EQ(count, 10uz);
+}
+#endif